@@ -0,0 +1,262 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/arena_message.h"
+#include "bigtable/client/internal/cell_visitor_parser.h"
+#include "bigtable/client/internal/readrowsparser.h"
+#include "bigtable/client/internal/row_batch_parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * @file
+ *
+ * Measure the per-chunk cost of `bigtable::internal::ReadRowsParser`.
+ *
+ * This is a micro-benchmark, it does not contact any server.  It creates a
+ * `ReadRowsResponse` similar to the responses received by
+ * `scan_throughput_benchmark` (rows with a single column family and 10
+ * columns), and feeds it to the parser repeatedly using:
+ *
+ * - `HandleChunk(std::move(chunk))`: the chunk is moved out of the response
+ *   into the by-value parameter, and then the fields are swapped into the
+ *   parser.
+ * - `ConsumeChunk(chunk)`: the parser works directly on the chunk held by the
+ *   response.
+ * - `RowBatchParser`: the chunks are parsed into a columnar `RowBatch`,
+ *   without creating `Row` or `Cell` objects.
+ * - `CellVisitorParser`: the cells are reported to a `CellVisitor` that
+ *   counts them, nothing is stored.
+ *
+ * It also measures the client-side cost of a `ReadRow()` call: a response
+ * with a single row is deserialized into a new `ArenaMessage` (as each
+ * `RowReader` creates one) and parsed into a `Row`.
+ *
+ * Usage: readrowsparser_benchmark [iterations]
+ */
+
+namespace {
+using google::bigtable::v2::ReadRowsResponse;
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+
+constexpr int kRowsPerResponse = 100;
+constexpr int kColumnsPerRow = 10;
+constexpr std::size_t kValueSize = 100;
+
+/// Create a response with kRowsPerResponse rows, starting at @p row_offset.
+ReadRowsResponse MakeResponse(long row_offset) {
+  ReadRowsResponse response;
+  for (int r = 0; r != kRowsPerResponse; ++r) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "user%012ld", row_offset + r);
+    for (int c = 0; c != kColumnsPerRow; ++c) {
+      auto& chunk = *response.add_chunks();
+      if (c == 0) {
+        chunk.set_row_key(key);
+        chunk.mutable_family_name()->set_value("cf");
+      }
+      chunk.mutable_qualifier()->set_value("field" + std::to_string(c));
+      chunk.set_timestamp_micros(0);
+      chunk.set_value(std::string(kValueSize, 'x'));
+      chunk.set_commit_row(c == kColumnsPerRow - 1);
+    }
+  }
+  return response;
+}
+
+/// Run one variant of the benchmark, return the average time per chunk.
+template <typename Feed>
+double RunBenchmark(int iterations, Feed&& feed) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  bigtable::internal::ReadRowsParser parser;
+  long rows = 0;
+  nanoseconds elapsed(0);
+  for (int i = 0; i != iterations; ++i) {
+    // Creating the response is not part of the measurement.
+    auto response = MakeResponse(i * kRowsPerResponse);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : *response.mutable_chunks()) {
+      feed(parser, chunk);
+      if (parser.HasNext()) {
+        auto row = parser.Next();
+        rows += static_cast<long>(row.cells().size());
+      }
+    }
+    elapsed += duration_cast<nanoseconds>(std::chrono::steady_clock::now() -
+                                          start);
+  }
+  parser.HandleEndOfStream();
+  if (rows != static_cast<long>(iterations) * kRowsPerResponse *
+                  kColumnsPerRow) {
+    throw std::runtime_error("unexpected number of cells parsed");
+  }
+  return static_cast<double>(elapsed.count()) / rows;
+}
+
+/// Run the benchmark using a RowBatchParser, return the time per chunk.
+double RunRowBatchBenchmark(int iterations) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  bigtable::internal::RowBatchParser parser;
+  bigtable::RowBatch batch;
+  long cells = 0;
+  nanoseconds elapsed(0);
+  for (int i = 0; i != iterations; ++i) {
+    auto response = MakeResponse(i * kRowsPerResponse);
+    auto start = std::chrono::steady_clock::now();
+    batch.clear();
+    for (auto& chunk : *response.mutable_chunks()) {
+      parser.Consume(chunk, batch);
+    }
+    cells += static_cast<long>(batch.cell_count());
+    elapsed += duration_cast<nanoseconds>(std::chrono::steady_clock::now() -
+                                          start);
+  }
+  parser.HandleEndOfStream();
+  if (cells != static_cast<long>(iterations) * kRowsPerResponse *
+                   kColumnsPerRow) {
+    throw std::runtime_error("unexpected number of cells parsed");
+  }
+  return static_cast<double>(elapsed.count()) / cells;
+}
+
+/// A visitor that only counts the cells, as an aggregation would.
+class CountingVisitor : public bigtable::CellVisitor {
+ public:
+  void OnRowStart(std::string const&) override {}
+  void OnCell(std::string const&, std::string const&, std::int64_t,
+              std::string const& value,
+              std::vector<std::string> const&) override {
+    ++cells;
+    bytes += static_cast<long>(value.size());
+  }
+  void OnRowCommit() override {}
+  void OnRowReset() override {}
+
+  long cells = 0;
+  long bytes = 0;
+};
+
+/// Run the benchmark using a CellVisitorParser, return the time per chunk.
+double RunCellVisitorBenchmark(int iterations) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+
+  bigtable::internal::CellVisitorParser parser;
+  CountingVisitor visitor;
+  nanoseconds elapsed(0);
+  for (int i = 0; i != iterations; ++i) {
+    auto response = MakeResponse(i * kRowsPerResponse);
+    auto start = std::chrono::steady_clock::now();
+    for (auto& chunk : *response.mutable_chunks()) {
+      parser.Consume(chunk, visitor);
+    }
+    elapsed += duration_cast<nanoseconds>(std::chrono::steady_clock::now() -
+                                          start);
+  }
+  parser.HandleEndOfStream();
+  if (visitor.cells != static_cast<long>(iterations) * kRowsPerResponse *
+                           kColumnsPerRow) {
+    throw std::runtime_error("unexpected number of cells parsed");
+  }
+  return static_cast<double>(elapsed.count()) / visitor.cells;
+}
+
+/// The results of RunReadRowBenchmark().
+struct ReadRowResult {
+  double ns_per_row;
+  /// The memory held by the arena after receiving the response.
+  long arena_bytes;
+};
+
+/// Measure the cost of receiving a one row response.
+ReadRowResult RunReadRowBenchmark(int iterations) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  using ResponseHolder = bigtable::internal::ArenaMessage<ReadRowsResponse>;
+
+  // Use the first row of a regular response.
+  ReadRowsResponse response = MakeResponse(0);
+  response.mutable_chunks()->DeleteSubrange(
+      kColumnsPerRow, response.chunks_size() - kColumnsPerRow);
+  std::string const payload = response.SerializeAsString();
+
+  long cells = 0;
+  long arena_bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i != iterations; ++i) {
+    ResponseHolder holder;
+    holder->ParseFromString(payload);
+    arena_bytes = static_cast<long>(holder->GetArena()->SpaceAllocated());
+    bigtable::internal::ReadRowsParser parser;
+    for (auto& chunk : *holder->mutable_chunks()) {
+      parser.ConsumeChunk(chunk);
+      if (parser.HasNext()) {
+        cells += static_cast<long>(parser.Next().cells().size());
+      }
+    }
+    parser.HandleEndOfStream();
+  }
+  auto elapsed =
+      duration_cast<nanoseconds>(std::chrono::steady_clock::now() - start);
+  if (cells != static_cast<long>(iterations) * kColumnsPerRow) {
+    throw std::runtime_error("unexpected number of cells parsed");
+  }
+  return ReadRowResult{static_cast<double>(elapsed.count()) / iterations,
+                       arena_bytes};
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) try {
+  int iterations = 2000;
+  if (argc > 1) {
+    iterations = std::stoi(argv[1]);
+  }
+
+  auto handle = RunBenchmark(
+      iterations, [](bigtable::internal::ReadRowsParser& parser,
+                     ReadRowsResponse_CellChunk& chunk) {
+        parser.HandleChunk(std::move(chunk));
+      });
+  auto consume = RunBenchmark(
+      iterations, [](bigtable::internal::ReadRowsParser& parser,
+                     ReadRowsResponse_CellChunk& chunk) {
+        parser.ConsumeChunk(chunk);
+      });
+  auto batch = RunRowBatchBenchmark(iterations);
+  auto visit = RunCellVisitorBenchmark(iterations);
+  auto read_row = RunReadRowBenchmark(iterations * kRowsPerResponse);
+
+  std::cout << std::fixed << std::setprecision(1)
+            << "HandleChunk(std::move(chunk)): " << handle << " ns/chunk\n"
+            << "ConsumeChunk(chunk): " << consume << " ns/chunk\n"
+            << "RowBatchParser: " << batch << " ns/chunk\n"
+            << "CellVisitorParser: " << visit << " ns/chunk\n"
+            << "ReadRow (one row response): " << read_row.ns_per_row
+            << " ns/row, " << read_row.arena_bytes << " arena bytes\n"
+            << "Speedup: " << std::setprecision(2) << handle / consume
+            << " (ConsumeChunk), " << handle / batch << " (RowBatchParser), "
+            << handle / visit << " (CellVisitorParser)" << std::endl;
+  return 0;
+} catch (std::exception const& ex) {
+  std::cerr << "Standard exception raised: " << ex.what() << std::endl;
+  return 1;
+}
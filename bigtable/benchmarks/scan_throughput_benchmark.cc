@@ -48,6 +48,15 @@
  * The benchmark will report throughput in rows per second for each scans with
  * 100, 1,000 and 10,000 rows.
  *
+ * Finally, the benchmark measures how long it takes to cancel a scan:
+ *
+ * - Execute the following loop for S seconds:
+ *   - Start an unbounded scan from a random key.
+ *   - Read 100 rows from the scan.
+ *   - Call `RowReader::Cancel()` and measure how long it takes.
+ *
+ * The benchmark reports the latency of these `Cancel()` calls.
+ *
  * Using a command-line parameter the benchmark can be configured to create a
  * local gRPC server that implements the Cloud Bigtable APIs used by the
  * benchmark.  If this parameter is not used, the benchmark uses the default
@@ -67,6 +76,13 @@ BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
                              std::string const& table_id, long table_size,
                              long scan_size,
                              std::chrono::seconds test_duration);
+
+/// Measure the latency of cancelling a partially consumed scan.
+BenchmarkResult RunCancelBenchmark(
+    bigtable::benchmarks::Benchmark const& benchmark,
+    std::shared_ptr<bigtable::DataClient> data_client,
+    std::string const& table_id, long table_size, long rows_before_cancel,
+    std::chrono::seconds test_duration);
 }  // anonymous namespace
 
 int main(int argc, char* argv[]) try {
@@ -99,6 +115,23 @@ int main(int argc, char* argv[]) try {
     results_by_size[op_name] = std::move(combined);
   }
 
+  constexpr long kRowsBeforeCancel = 100;
+  std::cout << "# Running Cancel() benchmark " << std::flush;
+  auto cancel_start = std::chrono::steady_clock::now();
+  auto cancel_results =
+      RunCancelBenchmark(benchmark, data_client, setup.table_id(),
+                         setup.table_size(), kRowsBeforeCancel,
+                         setup.test_duration());
+  using std::chrono::duration_cast;
+  cancel_results.elapsed = duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - cancel_start);
+  std::cout << " DONE. Elapsed=" << FormatDuration(cancel_results.elapsed)
+            << ", Ops=" << cancel_results.operations.size() << std::endl;
+  auto cancel_op_name =
+      "Cancel(after " + std::to_string(kRowsBeforeCancel) + " rows)";
+  benchmark.PrintLatencyResult(std::cout, "scant", cancel_op_name,
+                               cancel_results);
+
   std::cout << bigtable::benchmarks::Benchmark::ResultsCsvHeader() << std::endl;
   benchmark.PrintResultCsv(std::cout, "scant", "BulkApply()", "Latency",
                            populate_results);
@@ -106,6 +139,8 @@ int main(int argc, char* argv[]) try {
     benchmark.PrintResultCsv(std::cout, "scant", kv.first, "IterationTime",
                              kv.second);
   }
+  benchmark.PrintResultCsv(std::cout, "scant", cancel_op_name, "Latency",
+                           cancel_results);
 
   benchmark.DeleteTable();
 
@@ -147,4 +182,36 @@ BenchmarkResult RunBenchmark(bigtable::benchmarks::Benchmark const& benchmark,
   return result;
 }
 
+BenchmarkResult RunCancelBenchmark(
+    bigtable::benchmarks::Benchmark const& benchmark,
+    std::shared_ptr<bigtable::DataClient> data_client,
+    std::string const& table_id, long table_size, long rows_before_cancel,
+    std::chrono::seconds test_duration) {
+  BenchmarkResult result = {};
+
+  bigtable::Table table(std::move(data_client), table_id);
+
+  auto generator = MakeDefaultPRNG();
+  std::uniform_int_distribution<long> prng(0, table_size - 1);
+
+  auto test_start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() < test_start + test_duration) {
+    // Do not limit the number of rows, the server keeps streaming data until
+    // the scan is cancelled.
+    auto reader = table.ReadRows(
+        bigtable::RowSet(
+            bigtable::RowRange::StartingAt(benchmark.MakeKey(prng(generator)))),
+        bigtable::Filter::ColumnRangeClosed(kColumnFamily, "field0", "field9"));
+    long count = 0;
+    for (auto it = reader.begin();
+         it != reader.end() and count != rows_before_cancel; ++it) {
+      ++count;
+    }
+    result.operations.push_back(
+        Benchmark::TimeOperation([&reader]() { reader.Cancel(); }));
+    result.row_count += count;
+  }
+  return result;
+}
+
 }  // anonymous namespace
@@ -17,10 +17,22 @@
 
 #include "bigtable/client/version.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class ReadRowsParser;
+
+/// The name returned by moved-from cells and rows, which do not own any names.
+inline std::string const& EmptyName() {
+  static std::string const empty;
+  return empty;
+}
+}  // namespace internal
+
 /**
  * The in-memory representation of a Bigtable cell.
  *
@@ -30,7 +42,11 @@ inline namespace BIGTABLE_CLIENT_NS {
  * storage is sparse, column families, columns, and timestamps might contain
  * zero cells.
  *
- * The Cell class owns all its data.
+ * The Cell class owns all its data.  The row key, family name, and column
+ * qualifier are immutable and shared: all the cells in a row returned by
+ * `Table::ReadRows()` refer to a single copy of the row key, and the family
+ * and column names are shared by all the cells that use them.  Only the value
+ * and labels are stored per cell.
  */
 class Cell {
  public:
@@ -38,6 +54,22 @@ class Cell {
   Cell(std::string row_key, std::string family_name,
        std::string column_qualifier, int64_t timestamp, std::string value,
        std::vector<std::string> labels)
+      : Cell(std::make_shared<Names const>(Names{std::move(row_key),
+                                                 std::move(family_name),
+                                                 std::move(column_qualifier)}),
+             timestamp, std::move(value), std::move(labels)) {}
+
+  /**
+   * Create a Cell sharing the row key, family, and column with other cells.
+   *
+   * Applications creating many cells for the same row, or with the same
+   * family and column, can use this constructor to keep a single copy of each
+   * name.
+   */
+  Cell(std::shared_ptr<std::string const> row_key,
+       std::shared_ptr<std::string const> family_name,
+       std::shared_ptr<std::string const> column_qualifier, int64_t timestamp,
+       std::string value, std::vector<std::string> labels)
       : row_key_(std::move(row_key)),
         family_name_(std::move(family_name)),
         column_qualifier_(std::move(column_qualifier)),
@@ -47,15 +79,21 @@ class Cell {
 
   /// Return the row key this cell belongs to. The returned value is not valid
   /// after this object is deleted.
-  std::string const& row_key() const { return row_key_; }
+  std::string const& row_key() const {
+    return row_key_ ? *row_key_ : internal::EmptyName();
+  }
 
   /// Return the family this cell belongs to. The returned value is not valid
   /// after this object is deleted.
-  std::string const& family_name() const { return family_name_; }
+  std::string const& family_name() const {
+    return family_name_ ? *family_name_ : internal::EmptyName();
+  }
 
   /// Return the column this cell belongs to. The returned value is not valid
   /// after this object is deleted.
-  std::string const& column_qualifier() const { return column_qualifier_; }
+  std::string const& column_qualifier() const {
+    return column_qualifier_ ? *column_qualifier_ : internal::EmptyName();
+  }
 
   /// Return the timestamp of this cell.
   int64_t timestamp() const { return timestamp_; }
@@ -68,9 +106,27 @@ class Cell {
   std::vector<std::string> const& labels() const { return labels_; }
 
  private:
-  std::string row_key_;
-  std::string family_name_;
-  std::string column_qualifier_;
+  friend class internal::ReadRowsParser;
+
+  /// The names of a cell created from strings, kept in a single allocation.
+  struct Names {
+    std::string row_key;
+    std::string family_name;
+    std::string column_qualifier;
+  };
+
+  Cell(std::shared_ptr<Names const> names, int64_t timestamp,
+       std::string value, std::vector<std::string> labels)
+      : row_key_(names, &names->row_key),
+        family_name_(names, &names->family_name),
+        column_qualifier_(names, &names->column_qualifier),
+        timestamp_(timestamp),
+        value_(std::move(value)),
+        labels_(std::move(labels)) {}
+
+  std::shared_ptr<std::string const> row_key_;
+  std::shared_ptr<std::string const> family_name_;
+  std::shared_ptr<std::string const> column_qualifier_;
   int64_t timestamp_;
   std::string value_;
   std::vector<std::string> labels_;
@@ -36,3 +36,38 @@ TEST(CellTest, Simple) {
   EXPECT_EQ(value, cell.value());
   EXPECT_EQ(0U, cell.labels().size());
 }
+
+/// @test Verify that cells created from shared names do not copy them.
+TEST(CellTest, SharedNames) {
+  auto row_key = std::make_shared<std::string const>("row");
+  auto family_name = std::make_shared<std::string const>("family");
+  auto column_qualifier = std::make_shared<std::string const>("column");
+
+  bigtable::Cell c0(row_key, family_name, column_qualifier, 42, "v0", {});
+  bigtable::Cell c1(row_key, family_name, column_qualifier, 43, "v1", {});
+  EXPECT_EQ(row_key.get(), &c0.row_key());
+  EXPECT_EQ(row_key.get(), &c1.row_key());
+  EXPECT_EQ(family_name.get(), &c1.family_name());
+  EXPECT_EQ(column_qualifier.get(), &c1.column_qualifier());
+  EXPECT_EQ("v0", c0.value());
+  EXPECT_EQ(43, c1.timestamp());
+}
+
+/// @test Verify that a moved-from Cell returns empty names.
+TEST(CellTest, MovedFrom) {
+  bigtable::Cell cell("row", "family", "column", 42, "value", {});
+  bigtable::Cell moved(std::move(cell));
+  EXPECT_EQ("row", moved.row_key());
+  EXPECT_EQ("family", moved.family_name());
+  EXPECT_EQ("column", moved.column_qualifier());
+  EXPECT_EQ("", cell.row_key());
+  EXPECT_EQ("", cell.family_name());
+  EXPECT_EQ("", cell.column_qualifier());
+
+  bigtable::Cell assigned("r", "f", "c", 43, "v", {});
+  assigned = std::move(moved);
+  EXPECT_EQ("row", assigned.row_key());
+  EXPECT_EQ("", moved.row_key());
+  EXPECT_EQ("", moved.family_name());
+  EXPECT_EQ("", moved.column_qualifier());
+}
@@ -0,0 +1,95 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_CELL_VISITOR_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_CELL_VISITOR_H_
+
+#include "bigtable/client/version.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Receive the contents of a scan without creating `Row` objects.
+ *
+ * Aggregations (counting rows, adding values, building filters) do not need
+ * to keep the rows returned by a scan.  `Table::ReadRows(RowSet, Filter,
+ * CellVisitor&)` calls the member functions of this class as the response
+ * data is parsed, the arguments refer to buffers owned by the library and
+ * are only valid during the call.
+ *
+ * The cells of a row are reported between `OnRowStart()` and
+ * `OnRowCommit()`.  If the service (or the library, when retrying a failed
+ * stream) discards a row in progress, `OnRowReset()` is called instead of
+ * `OnRowCommit()`, and the application should discard any data gathered
+ * since the last `OnRowStart()`.  The row may be reported again later.
+ *
+ * Large values are split by the service across several chunks, and by
+ * default the library assembles them in memory before calling `OnCell()`.
+ * Applications can override `OnLargeCellStart()` to receive these values in
+ * pieces instead, for example to write them to a file, without ever holding
+ * the full value in memory.
+ */
+class CellVisitor {
+ public:
+  virtual ~CellVisitor() = default;
+
+  /// A new row starts, its cells are reported next.
+  virtual void OnRowStart(std::string const& row_key) = 0;
+
+  /// A cell in the current row.
+  virtual void OnCell(std::string const& family_name,
+                      std::string const& column_qualifier,
+                      std::int64_t timestamp, std::string const& value,
+                      std::vector<std::string> const& labels) = 0;
+
+  /**
+   * A cell whose value is split across several chunks starts.
+   *
+   * Return true to receive the value in pieces: the library calls
+   * `OnCellValueChunk()` for each piece, and then `OnLargeCellEnd()`,
+   * instead of calling `OnCell()`.  Return false (the default) to receive
+   * the full value in `OnCell()`.  Values received in pieces do not count
+   * towards `RowReaderOptions::max_row_bytes()`.
+   *
+   * @param value_size the total size of the value.
+   */
+  virtual bool OnLargeCellStart(std::string const& family_name,
+                                std::string const& column_qualifier,
+                                std::int64_t timestamp, std::size_t value_size,
+                                std::vector<std::string> const& labels) {
+    return false;
+  }
+
+  /// The next piece of the value of a cell accepted by `OnLargeCellStart()`.
+  virtual void OnCellValueChunk(std::string const& data) {}
+
+  /// The value of the cell accepted by `OnLargeCellStart()` is complete.
+  virtual void OnLargeCellEnd() {}
+
+  /// All the cells of the current row have been reported.
+  virtual void OnRowCommit() = 0;
+
+  /// The cells reported since the last `OnRowStart()` must be discarded.
+  virtual void OnRowReset() = 0;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_CELL_VISITOR_H_
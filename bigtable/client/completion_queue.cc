@@ -0,0 +1,48 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/completion_queue.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+void CompletionQueue::Run() {
+  void* tag;
+  bool ok;
+  while (cq_.Next(&tag, &ok)) {
+    auto* op = static_cast<internal::AsyncOperation*>(tag);
+    if (op->Notify(*this, ok)) {
+      delete op;
+    }
+  }
+}
+
+void CompletionQueue::Shutdown() {
+  std::lock_guard<std::mutex> lk(mu_);
+  shutdown_ = true;
+  cq_.Shutdown();
+}
+
+bool CompletionQueue::StartUnlessShutdown(std::function<void()> const& start) {
+  // Hold the lock while starting the operation, otherwise a concurrent
+  // Shutdown() could complete before the operation is started.
+  std::lock_guard<std::mutex> lk(mu_);
+  if (shutdown_) {
+    return false;
+  }
+  start();
+  return true;
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,120 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_COMPLETION_QUEUE_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_COMPLETION_QUEUE_H_
+
+#include "bigtable/client/version.h"
+
+#include <grpc++/grpc++.h>
+#include <functional>
+#include <mutex>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+class CompletionQueue;
+
+namespace internal {
+/**
+ * The interface implemented by the asynchronous operations.
+ *
+ * Each asynchronous operation in the library is a small state machine, the
+ * address of the state machine is used as the tag for all the gRPC operations
+ * it starts. The state machines never have more than one pending gRPC
+ * operation, so `Notify()` is never called concurrently for the same object.
+ */
+class AsyncOperation {
+ public:
+  virtual ~AsyncOperation() = default;
+
+  /**
+   * Handle the completion of the pending gRPC operation.
+   *
+   * @param cq the completion queue running the operation.
+   * @param ok the result reported by `grpc::CompletionQueue::Next()`.
+   * @return true if the operation has completed, in which case the completion
+   *     queue deletes the object.
+   */
+  virtual bool Notify(CompletionQueue& cq, bool ok) = 0;
+};
+}  // namespace internal
+
+/**
+ * Run asynchronous operations on behalf of the Cloud Bigtable client.
+ *
+ * Applications create one (or a few) of these objects, and dedicate one or more
+ * threads to call `Run()`.  The asynchronous member functions in `Table` start
+ * their operations in the completion queue, and their callbacks are invoked by
+ * the threads running `Run()`.  This allows a small number of threads to drive
+ * many concurrent operations.
+ *
+ * @code
+ * bigtable::CompletionQueue cq;
+ * std::thread t([&cq]() { cq.Run(); });
+ * auto f = table.AsyncReadRows(cq, on_row, bigtable::RowSet(), 0, filter);
+ * // ... do something else ...
+ * grpc::Status status = f.get();
+ * cq.Shutdown();
+ * t.join();
+ * @endcode
+ *
+ * The destructor requires that `Shutdown()` was called and that all the
+ * threads running `Run()` have returned.
+ */
+class CompletionQueue {
+ public:
+  CompletionQueue() = default;
+
+  CompletionQueue(CompletionQueue const&) = delete;
+  CompletionQueue& operator=(CompletionQueue const&) = delete;
+
+  /**
+   * Run the event loop until the queue is shutdown and drained.
+   *
+   * Multiple threads may call this function concurrently.
+   */
+  void Run();
+
+  /**
+   * Terminate the event loop, pending operations still run to completion.
+   *
+   * Operations waiting to retry a request do not start a new request, they
+   * complete with `grpc::StatusCode::CANCELLED` when their backoff expires.
+   */
+  void Shutdown();
+
+  /**
+   * Call @p start unless `Shutdown()` was called.
+   *
+   * The timers set before `Shutdown()` still expire after it, but no new
+   * gRPC operations can be started in a queue that is shut down.  The
+   * asynchronous operations start their retries using this function.
+   *
+   * @return true if @p start was called.
+   */
+  bool StartUnlessShutdown(std::function<void()> const& start);
+
+  /// The underlying gRPC completion queue.
+  grpc::CompletionQueue& cq() { return cq_; }
+
+ private:
+  grpc::CompletionQueue cq_;
+  std::mutex mu_;
+  bool shutdown_ = false;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_COMPLETION_QUEUE_H_
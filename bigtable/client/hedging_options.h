@@ -0,0 +1,106 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_HEDGING_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_HEDGING_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <chrono>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for `Table::EnableHedging()`.
+ *
+ * A hedged read sends a second attempt, on a different connection, if the
+ * first attempt has not completed after a delay.  The first attempt to
+ * succeed is used, and the other one is cancelled.
+ *
+ * @code
+ * // Hedge the reads slower than the 95th percentile, but never more than
+ * // 2% of the reads.
+ * table.EnableHedging(bigtable::HedgingOptions()
+ *                         .set_delay_percentile(95)
+ *                         .set_budget(0.02));
+ * @endcode
+ */
+class HedgingOptions {
+ public:
+  HedgingOptions()
+      : delay_(std::chrono::milliseconds(10)),
+        delay_percentile_(0),
+        budget_(0.05) {}
+
+  /**
+   * Set how long to wait for the first attempt before sending the second.
+   *
+   * If `delay_percentile()` is set, this value is only used until enough
+   * latency samples have been collected.
+   */
+  HedgingOptions& set_delay(std::chrono::microseconds delay) {
+    delay_ = delay;
+    return *this;
+  }
+  /// Return the fixed delay before sending the second attempt.
+  std::chrono::microseconds delay() const { return delay_; }
+
+  /**
+   * Derive the delay from the latency of the recent reads.
+   *
+   * The second attempt is sent when the first one is slower than this
+   * percentile (e.g. 95 or 99) of the recent successful attempts.  Use 0 to
+   * always use the fixed `delay()`.
+   */
+  HedgingOptions& set_delay_percentile(double percentile) {
+    if (percentile < 0 or percentile >= 100) {
+      internal::RaiseRangeError(
+          "HedgingOptions::set_delay_percentile requires 0 <= p < 100");
+    }
+    delay_percentile_ = percentile;
+    return *this;
+  }
+  /// Return the latency percentile used as delay, 0 if disabled.
+  double delay_percentile() const { return delay_percentile_; }
+
+  /**
+   * Limit the number of second attempts to this fraction of the reads.
+   *
+   * The budget caps the additional load sent to the service, for example,
+   * when the service is slow for all the requests.  Short bursts above the
+   * budget are allowed.
+   */
+  HedgingOptions& set_budget(double fraction) {
+    if (fraction < 0 or fraction > 1) {
+      internal::RaiseRangeError(
+          "HedgingOptions::set_budget requires 0 <= fraction <= 1");
+    }
+    budget_ = fraction;
+    return *this;
+  }
+  /// Return the maximum fraction of hedged reads.
+  double budget() const { return budget_; }
+
+ private:
+  std::chrono::microseconds delay_;
+  double delay_percentile_;
+  double budget_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_HEDGING_OPTIONS_H_
@@ -0,0 +1,129 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ARENA_MESSAGE_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ARENA_MESSAGE_H_
+
+#include "bigtable/client/version.h"
+
+#include <google/protobuf/arena.h>
+#include <algorithm>
+#include <memory>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * A protobuf message allocated in a reusable arena.
+ *
+ * The streaming RPCs receive many responses of the same type, each one with
+ * many small sub-messages (e.g. the chunks in a `ReadRowsResponse`).  Parsing
+ * them into a heap-allocated message creates and destroys these sub-messages
+ * in every response.  This class allocates the message in an arena, and keeps
+ * the first block of the arena between responses, so in the common case
+ * receiving a response does not touch the global heap for the message
+ * structure.
+ *
+ * The block is not allocated up front: many readers (e.g. `ReadRow()`)
+ * receive a single small response.  The arena starts with small blocks, and
+ * `Reset()` replaces the kept block with one large enough for the previous
+ * message, up to `max_block_size`, whenever the message outgrew it.
+ *
+ * Note that the contents of string fields are still allocated with
+ * `std::allocator`, so they can be swapped out of the message (as the
+ * `ReadRowsParser` does) and survive `Reset()`.
+ *
+ * @tparam Message the protobuf message type.
+ */
+template <typename Message>
+class ArenaMessage {
+ public:
+  /// The default for the largest arena block kept between calls to `Reset()`.
+  static constexpr std::size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit ArenaMessage(std::size_t max_block_size = kDefaultBlockSize)
+      : max_block_size_(max_block_size),
+        block_size_(0),
+        arena_(new google::protobuf::Arena(InitialOptions())),
+        message_(NewMessage()) {}
+
+  ArenaMessage(ArenaMessage const&) = delete;
+  ArenaMessage& operator=(ArenaMessage const&) = delete;
+
+  Message& get() { return *message_; }
+  Message const& get() const { return *message_; }
+  Message* operator->() { return message_; }
+  Message const* operator->() const { return message_; }
+
+  /// Discard the message and create an empty one, reusing the arena memory.
+  void Reset() {
+    auto const allocated = static_cast<std::size_t>(arena_->SpaceAllocated());
+    if (allocated <= block_size_ or block_size_ >= max_block_size_) {
+      arena_->Reset();
+      message_ = NewMessage();
+      return;
+    }
+    // The last message did not fit in the block, grow it so the next ones
+    // (which are typically of similar size) do.
+    std::size_t size = block_size_ == 0 ? kMinBlockSize : block_size_;
+    while (size < allocated and size < max_block_size_) {
+      size *= 2;
+    }
+    block_size_ = std::min(size, max_block_size_);
+    arena_.reset();
+    block_.reset(new char[block_size_]);
+    arena_.reset(
+        new google::protobuf::Arena(MakeOptions(block_.get(), block_size_)));
+    message_ = NewMessage();
+  }
+
+ private:
+  /// The smallest block worth keeping between calls to `Reset()`.
+  static constexpr std::size_t kMinBlockSize = 1024;
+
+  static google::protobuf::ArenaOptions InitialOptions() {
+    google::protobuf::ArenaOptions options;
+    options.start_block_size = kMinBlockSize;
+    return options;
+  }
+
+  static google::protobuf::ArenaOptions MakeOptions(char* block,
+                                                    std::size_t size) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block;
+    options.initial_block_size = size;
+    return options;
+  }
+
+  Message* NewMessage() {
+    return google::protobuf::Arena::CreateMessage<Message>(arena_.get());
+  }
+
+  std::size_t max_block_size_;
+  std::size_t block_size_;
+  std::unique_ptr<char[]> block_;
+  std::unique_ptr<google::protobuf::Arena> arena_;
+  Message* message_;
+};
+
+template <typename Message>
+constexpr std::size_t ArenaMessage<Message>::kDefaultBlockSize;
+template <typename Message>
+constexpr std::size_t ArenaMessage<Message>::kMinBlockSize;
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ARENA_MESSAGE_H_
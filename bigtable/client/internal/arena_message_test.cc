@@ -0,0 +1,97 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/arena_message.h"
+
+#include <google/bigtable/v2/bigtable.pb.h>
+#include <gmock/gmock.h>
+
+using bigtable::internal::ArenaMessage;
+using google::bigtable::v2::ReadRowsResponse;
+
+/// @test Verify that ArenaMessage allocates the message in its arena.
+TEST(ArenaMessageTest, Simple) {
+  ArenaMessage<ReadRowsResponse> message;
+  EXPECT_EQ(0, message->chunks_size());
+  message->add_chunks()->set_row_key("r1");
+  EXPECT_EQ(1, message.get().chunks_size());
+  EXPECT_NE(nullptr, message->GetArena());
+}
+
+/// @test Verify that Reset() creates an empty message.
+TEST(ArenaMessageTest, Reset) {
+  ArenaMessage<ReadRowsResponse> message(1024);
+  for (int i = 0; i != 100; ++i) {
+    auto& chunk = *message->add_chunks();
+    chunk.set_row_key("r" + std::to_string(i));
+    chunk.mutable_family_name()->set_value("fam");
+  }
+  EXPECT_EQ(100, message->chunks_size());
+  message.Reset();
+  EXPECT_EQ(0, message->chunks_size());
+  message->add_chunks()->set_row_key("r1");
+  EXPECT_EQ("r1", message->chunks(0).row_key());
+}
+
+/// @test Verify that the arena does not allocate a large block up front.
+TEST(ArenaMessageTest, SmallInitialArena) {
+  ArenaMessage<ReadRowsResponse> message;
+  EXPECT_GT(ArenaMessage<ReadRowsResponse>::kDefaultBlockSize,
+            message->GetArena()->SpaceAllocated());
+}
+
+/// @test Verify that Reset() keeps a block large enough for the message.
+TEST(ArenaMessageTest, ResetGrowsBlock) {
+  ArenaMessage<ReadRowsResponse> message;
+  auto fill = [&message] {
+    for (int i = 0; i != 100; ++i) {
+      message->add_chunks()->set_row_key("r" + std::to_string(i));
+    }
+  };
+  fill();
+  auto const allocated = message->GetArena()->SpaceAllocated();
+  message.Reset();
+  auto const block = message->GetArena()->SpaceAllocated();
+  EXPECT_LE(allocated, block);
+  EXPECT_GE(ArenaMessage<ReadRowsResponse>::kDefaultBlockSize, block);
+  // The next message of the same size fits in the block.
+  fill();
+  EXPECT_EQ(block, message->GetArena()->SpaceAllocated());
+}
+
+/// @test Verify that Reset() does not keep more than the maximum block size.
+TEST(ArenaMessageTest, ResetRespectsMaxBlockSize) {
+  ArenaMessage<ReadRowsResponse> message(1024);
+  for (int j = 0; j != 2; ++j) {
+    for (int i = 0; i != 100; ++i) {
+      message->add_chunks()->set_row_key("r" + std::to_string(i));
+    }
+    EXPECT_LT(1024U, message->GetArena()->SpaceAllocated());
+    message.Reset();
+    EXPECT_GE(1024U, message->GetArena()->SpaceAllocated());
+  }
+}
+
+/// @test Verify that string fields can be swapped out and survive Reset().
+TEST(ArenaMessageTest, SwappedStringsSurviveReset) {
+  ArenaMessage<ReadRowsResponse> message;
+  std::string value(1024, 'a');
+  message->add_chunks()->mutable_value()->swap(value);
+  std::string taken;
+  message->mutable_chunks(0)->mutable_value()->swap(taken);
+  auto const* data = taken.data();
+  message.Reset();
+  EXPECT_EQ(std::string(1024, 'a'), taken);
+  EXPECT_EQ(data, taken.data());
+}
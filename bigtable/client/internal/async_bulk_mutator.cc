@@ -0,0 +1,130 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_bulk_mutator.h"
+#include "bigtable/client/internal/make_unique.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+AsyncBulkMutator::AsyncBulkMutator(
+    std::shared_ptr<DataClient> client, std::string const& table_name,
+    IdempotentMutationPolicy& idempotent_policy, BulkMutation&& mut,
+    std::unique_ptr<RPCRetryPolicy> retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> backoff_policy, FinishFunctor on_finish)
+    : client_(std::move(client)),
+      mutator_(table_name, idempotent_policy, std::move(mut)),
+      retry_policy_(std::move(retry_policy)),
+      backoff_policy_(std::move(backoff_policy)),
+      on_finish_(std::move(on_finish)),
+      state_(State::kStart) {}
+
+void AsyncBulkMutator::Start(CompletionQueue& cq) {
+  if (not mutator_.HasPendingMutations()) {
+    // Nothing to send, but the callback must run in the completion queue.
+    state_ = State::kNoMutations;
+    alarm_.Set(&cq.cq(), std::chrono::system_clock::now(), this);
+    return;
+  }
+  MakeRequest(cq);
+}
+
+bool AsyncBulkMutator::Notify(CompletionQueue& cq, bool ok) {
+  switch (state_) {
+    case State::kStart:
+      if (not ok) {
+        FinishStream();
+        return false;
+      }
+      ReadNext();
+      return false;
+    case State::kReading:
+      if (not ok) {
+        // The stream has no more data, fetch the status to find out why.
+        FinishStream();
+        return false;
+      }
+      mutator_.ProcessResponse(response_.get());
+      ReadNext();
+      return false;
+    case State::kFinishing:
+      return OnFinish(cq);
+    case State::kBackoff:
+      if (not ok or
+          not cq.StartUnlessShutdown([this, &cq] { MakeRequest(cq); })) {
+        return Cancel();
+      }
+      return false;
+    case State::kNoMutations:
+      return Complete();
+  }
+  return false;
+}
+
+void AsyncBulkMutator::MakeRequest(CompletionQueue& cq) {
+  // Release the previous stream before the context it refers to.
+  stream_.reset();
+  context_ = make_unique<grpc::ClientContext>();
+  retry_policy_->setup(*context_);
+  backoff_policy_->setup(*context_);
+
+  state_ = State::kStart;
+  stream_ = client_->Stub()->PrepareAsyncMutateRows(
+      context_.get(), mutator_.PrepareForRequest(), &cq.cq());
+  stream_->StartCall(this);
+}
+
+void AsyncBulkMutator::ReadNext() {
+  response_.Reset();
+  state_ = State::kReading;
+  stream_->Read(&response_.get(), this);
+}
+
+void AsyncBulkMutator::FinishStream() {
+  state_ = State::kFinishing;
+  stream_->Finish(&status_, this);
+}
+
+bool AsyncBulkMutator::OnFinish(CompletionQueue& cq) {
+  mutator_.FinishRequest();
+  // The rest of this function follows the same logic as Table::BulkApply().
+  if (not mutator_.HasPendingMutations()) {
+    return Complete();
+  }
+  if (not status_.ok() and not retry_policy_->on_failure(status_)) {
+    return Complete();
+  }
+
+  auto delay = backoff_policy_->on_completion(status_);
+  state_ = State::kBackoff;
+  alarm_.Set(&cq.cq(), std::chrono::system_clock::now() + delay, this);
+  return false;
+}
+
+bool AsyncBulkMutator::Complete() {
+  on_finish_(mutator_.ExtractFinalFailures());
+  return true;
+}
+
+bool AsyncBulkMutator::Cancel() {
+  google::rpc::Status status;
+  status.set_code(grpc::StatusCode::CANCELLED);
+  status.set_message("the completion queue was shutdown");
+  on_finish_(mutator_.ExtractFinalFailures(status));
+  return true;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,100 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_BULK_MUTATOR_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_BULK_MUTATOR_H_
+
+#include "bigtable/client/completion_queue.h"
+#include "bigtable/client/data_client.h"
+#include "bigtable/client/internal/arena_message.h"
+#include "bigtable/client/internal/bulk_mutator.h"
+#include "bigtable/client/rpc_backoff_policy.h"
+#include "bigtable/client/rpc_retry_policy.h"
+
+#include <grpc++/alarm.h>
+#include <functional>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Implement `Table::AsyncBulkApply()` as a state machine on a CompletionQueue.
+ *
+ * The bookkeeping for partial failures and retries is delegated to a
+ * `BulkMutator`, as in `Table::BulkApply()`.  This class only replaces the
+ * blocking calls: the streaming RPC, the reads, and the backoff between
+ * requests are asynchronous operations in the completion queue.
+ */
+class AsyncBulkMutator : public AsyncOperation {
+ public:
+  /// Receives the mutations that could not be applied.
+  using FinishFunctor = std::function<void(std::vector<FailedMutation>)>;
+
+  AsyncBulkMutator(std::shared_ptr<DataClient> client,
+                   std::string const& table_name,
+                   IdempotentMutationPolicy& idempotent_policy,
+                   BulkMutation&& mut,
+                   std::unique_ptr<RPCRetryPolicy> retry_policy,
+                   std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                   FinishFunctor on_finish);
+
+  /// Start the first request, the object is owned by @p cq after this call.
+  void Start(CompletionQueue& cq);
+
+  bool Notify(CompletionQueue& cq, bool ok) override;
+
+ private:
+  /// Send the MutateRows request, the completion is reported via Notify().
+  void MakeRequest(CompletionQueue& cq);
+
+  /// Request the next response from the stream.
+  void ReadNext();
+
+  /// Request the final status of the stream.
+  void FinishStream();
+
+  /// Handle the end of a stream, return true if the operation completed.
+  bool OnFinish(CompletionQueue& cq);
+
+  /// Report the final failures to the application.
+  bool Complete();
+
+  /// Report the final failures, the pending mutations fail with CANCELLED.
+  bool Cancel();
+
+  enum class State { kStart, kReading, kFinishing, kBackoff, kNoMutations };
+
+  std::shared_ptr<DataClient> client_;
+  BulkMutator mutator_;
+  std::unique_ptr<RPCRetryPolicy> retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  FinishFunctor on_finish_;
+
+  State state_;
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<google::bigtable::v2::MutateRowsResponse>>
+      stream_;
+  /// Reused (via its arena) for all the responses in this operation.
+  ArenaMessage<google::bigtable::v2::MutateRowsResponse> response_;
+  grpc::Status status_;
+  grpc::Alarm alarm_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_BULK_MUTATOR_H_
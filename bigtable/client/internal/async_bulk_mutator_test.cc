@@ -0,0 +1,228 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_bulk_mutator.h"
+#include "bigtable/client/table.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::Return;
+using testing::SaveArg;
+using testing::SetArgPointee;
+
+using google::bigtable::v2::MutateRowsRequest;
+using google::bigtable::v2::MutateRowsResponse;
+using bigtable::testing::MockAsyncMutateRowsStream;
+
+namespace {
+class AsyncBulkMutatorTest : public bigtable::testing::TableTestFixture {
+ protected:
+  ~AsyncBulkMutatorTest() override {
+    cq_.Shutdown();
+    void* tag;
+    bool ok;
+    while (cq_.cq().Next(&tag, &ok)) {
+    }
+  }
+
+  /// Deliver a completion to the operation, as `CompletionQueue::Run()` would.
+  void Notify(bool ok) {
+    ASSERT_NE(nullptr, tag_);
+    auto op = static_cast<bigtable::internal::AsyncOperation*>(tag_);
+    if (op->Notify(cq_, ok)) {
+      delete op;
+      tag_ = nullptr;
+    }
+  }
+
+  /// Wait for the next timer and deliver it to the operation.
+  void NotifyAlarm() {
+    void* tag;
+    bool ok;
+    ASSERT_TRUE(cq_.cq().Next(&tag, &ok));
+    if (tag_ == nullptr) {
+      tag_ = tag;
+    }
+    EXPECT_EQ(tag_, tag);
+    Notify(ok);
+  }
+
+  bigtable::CompletionQueue cq_;
+  void* tag_ = nullptr;
+};
+
+/// Create a response with the given status codes for each entry.
+MutateRowsResponse MakeResponse(std::vector<grpc::StatusCode> const& codes) {
+  MutateRowsResponse response;
+  int index = 0;
+  for (auto code : codes) {
+    auto& entry = *response.add_entries();
+    entry.set_index(index++);
+    entry.mutable_status()->set_code(code);
+  }
+  return response;
+}
+
+bigtable::BulkMutation MakeMutations() {
+  return bigtable::BulkMutation(
+      bigtable::SingleRowMutation("foo",
+                                  {bigtable::SetCell("fam", "col", 0, "v1")}),
+      bigtable::SingleRowMutation("bar",
+                                  {bigtable::SetCell("fam", "col", 0, "v2")}));
+}
+}  // anonymous namespace
+
+/// @test Verify that AsyncBulkApply() works in the easy case.
+TEST_F(AsyncBulkMutatorTest, Success) {
+  // must be a new pointer, it is wrapped in unique_ptr by the stub
+  auto stream = new MockAsyncMutateRowsStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, &cq_.cq()))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({grpc::OK, grpc::OK})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  auto result = table_.AsyncBulkApply(cq_, MakeMutations());
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> all OK
+  Notify(false);  // Read() -> end of stream
+  EXPECT_NE(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  ASSERT_EQ(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(result.get().empty());
+}
+
+/// @test Verify that only the mutations that failed are retried.
+TEST_F(AsyncBulkMutatorTest, RetryPartialFailure) {
+  auto stream = new MockAsyncMutateRowsStream;
+  auto stream_retry = new MockAsyncMutateRowsStream;
+  MutateRowsRequest retry_request;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, _))
+      .WillOnce(Return(stream))
+      .WillOnce(Invoke([stream_retry, &retry_request](
+                           grpc::ClientContext*, MutateRowsRequest const& r,
+                           grpc::CompletionQueue*) {
+        retry_request = r;
+        return stream_retry;
+      }));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({grpc::OK, grpc::UNAVAILABLE})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  EXPECT_CALL(*stream_retry, StartCall(_)).WillOnce(Return());
+  EXPECT_CALL(*stream_retry, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({grpc::OK})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream_retry, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  auto result = table_.AsyncBulkApply(cq_, MakeMutations());
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> one failure
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish()
+  NotifyAlarm();  // backoff expired, start the retry
+  ASSERT_EQ(1, retry_request.entries_size());
+  EXPECT_EQ("bar", retry_request.entries(0).row_key());
+
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> OK
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(result.get().empty());
+}
+
+/// @test Verify that a retry is not started after the queue is shutdown.
+TEST_F(AsyncBulkMutatorTest, ShutdownDuringBackoff) {
+  auto stream = new MockAsyncMutateRowsStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({grpc::OK, grpc::UNAVAILABLE})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  auto result = table_.AsyncBulkApply(cq_, MakeMutations());
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> one failure
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish(), start the backoff
+  cq_.Shutdown();
+  NotifyAlarm();  // backoff expired, the queue is shutdown
+  EXPECT_EQ(nullptr, tag_);
+  auto failures = result.get();
+  ASSERT_EQ(1U, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::CANCELLED, failures[0].status().error_code());
+}
+
+/// @test Verify that permanent failures are reported with their index.
+TEST_F(AsyncBulkMutatorTest, PermanentFailure) {
+  auto stream = new MockAsyncMutateRowsStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(
+          MakeResponse({grpc::OK, grpc::PERMISSION_DENIED})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  std::vector<bigtable::FailedMutation> failures;
+  bool called = false;
+  table_.AsyncBulkApply(cq_, MakeMutations(),
+                        [&](std::vector<bigtable::FailedMutation> f) {
+                          called = true;
+                          failures = std::move(f);
+                        });
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> one failure
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(called);
+  ASSERT_EQ(1U, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::PERMISSION_DENIED, failures[0].status().error_code());
+}
+
+/// @test Verify that an empty bulk mutation completes without any requests.
+TEST_F(AsyncBulkMutatorTest, EmptyMutation) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, _)).Times(0);
+
+  auto result = table_.AsyncBulkApply(cq_, bigtable::BulkMutation());
+  // The result is delivered by the completion queue, not the calling thread.
+  EXPECT_NE(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+  NotifyAlarm();
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(result.get().empty());
+}
@@ -0,0 +1,94 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_row_mutator.h"
+#include "bigtable/client/internal/make_unique.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+AsyncRowMutator::AsyncRowMutator(
+    std::shared_ptr<DataClient> client,
+    google::bigtable::v2::MutateRowRequest request, bool is_idempotent,
+    std::unique_ptr<RPCRetryPolicy> retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> backoff_policy, FinishFunctor on_finish)
+    : client_(std::move(client)),
+      request_(std::move(request)),
+      is_idempotent_(is_idempotent),
+      retry_policy_(std::move(retry_policy)),
+      backoff_policy_(std::move(backoff_policy)),
+      on_finish_(std::move(on_finish)),
+      state_(State::kCalling) {}
+
+void AsyncRowMutator::Start(CompletionQueue& cq) { MakeRequest(cq); }
+
+bool AsyncRowMutator::Notify(CompletionQueue& cq, bool ok) {
+  switch (state_) {
+    case State::kCalling:
+      // Finish() always succeeds for unary calls, the result is in status_.
+      return OnFinish(cq);
+    case State::kBackoff:
+      if (not ok or
+          not cq.StartUnlessShutdown([this, &cq] { MakeRequest(cq); })) {
+        return Fail(grpc::Status(grpc::StatusCode::CANCELLED,
+                                 "the completion queue was shutdown"));
+      }
+      return false;
+  }
+  return false;
+}
+
+void AsyncRowMutator::MakeRequest(CompletionQueue& cq) {
+  rpc_.reset();
+  context_ = make_unique<grpc::ClientContext>();
+  retry_policy_->setup(*context_);
+  backoff_policy_->setup(*context_);
+
+  state_ = State::kCalling;
+  rpc_ = client_->Stub()->PrepareAsyncMutateRow(context_.get(), request_,
+                                                &cq.cq());
+  rpc_->StartCall();
+  rpc_->Finish(&response_, &status_, this);
+}
+
+bool AsyncRowMutator::OnFinish(CompletionQueue& cq) {
+  if (status_.ok()) {
+    on_finish_({});
+    return true;
+  }
+  // The rest of this function follows the same logic as Table::Apply().
+  if (not retry_policy_->on_failure(status_) or not is_idempotent_) {
+    return Fail(status_);
+  }
+
+  auto delay = backoff_policy_->on_completion(status_);
+  state_ = State::kBackoff;
+  alarm_.Set(&cq.cq(), std::chrono::system_clock::now() + delay, this);
+  return false;
+}
+
+bool AsyncRowMutator::Fail(grpc::Status const& status) {
+  std::vector<FailedMutation> failures;
+  google::rpc::Status rpc_status;
+  rpc_status.set_code(status.error_code());
+  rpc_status.set_message(status.error_message());
+  failures.emplace_back(SingleRowMutation(std::move(request_)),
+                        std::move(rpc_status), 0);
+  on_finish_(std::move(failures));
+  return true;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
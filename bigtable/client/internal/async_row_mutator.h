@@ -0,0 +1,89 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_MUTATOR_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_MUTATOR_H_
+
+#include "bigtable/client/completion_queue.h"
+#include "bigtable/client/data_client.h"
+#include "bigtable/client/mutations.h"
+#include "bigtable/client/rpc_backoff_policy.h"
+#include "bigtable/client/rpc_retry_policy.h"
+
+#include <grpc++/alarm.h>
+#include <functional>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Implement `Table::AsyncApply()` as a state machine on a CompletionQueue.
+ *
+ * The state machine follows the same logic as `Table::Apply()`: the request
+ * is retried while the retry policy allows it, and only if the mutation is
+ * idempotent.  The backoff between retries is a timer in the completion
+ * queue, no thread is blocked while the operation is pending.
+ */
+class AsyncRowMutator : public AsyncOperation {
+ public:
+  /// Receives the failed mutation, if any, when the operation completes.
+  using FinishFunctor = std::function<void(std::vector<FailedMutation>)>;
+
+  AsyncRowMutator(std::shared_ptr<DataClient> client,
+                  google::bigtable::v2::MutateRowRequest request,
+                  bool is_idempotent,
+                  std::unique_ptr<RPCRetryPolicy> retry_policy,
+                  std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                  FinishFunctor on_finish);
+
+  /// Start the first request, the object is owned by @p cq after this call.
+  void Start(CompletionQueue& cq);
+
+  bool Notify(CompletionQueue& cq, bool ok) override;
+
+ private:
+  /// Send the MutateRow request, the completion is reported via Notify().
+  void MakeRequest(CompletionQueue& cq);
+
+  /// Handle the result of a request, return true if the operation completed.
+  bool OnFinish(CompletionQueue& cq);
+
+  /// Report the mutation as failed with @p status.
+  bool Fail(grpc::Status const& status);
+
+  enum class State { kCalling, kBackoff };
+
+  std::shared_ptr<DataClient> client_;
+  google::bigtable::v2::MutateRowRequest request_;
+  bool is_idempotent_;
+  std::unique_ptr<RPCRetryPolicy> retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  FinishFunctor on_finish_;
+
+  State state_;
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      google::bigtable::v2::MutateRowResponse>>
+      rpc_;
+  google::bigtable::v2::MutateRowResponse response_;
+  grpc::Status status_;
+  grpc::Alarm alarm_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_MUTATOR_H_
@@ -0,0 +1,173 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_row_mutator.h"
+#include "bigtable/client/table.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Return;
+using testing::SaveArg;
+using testing::SetArgPointee;
+
+using google::bigtable::v2::MutateRowRequest;
+using bigtable::testing::MockAsyncMutateRowReader;
+
+namespace {
+class AsyncRowMutatorTest : public bigtable::testing::TableTestFixture {
+ protected:
+  ~AsyncRowMutatorTest() override {
+    cq_.Shutdown();
+    void* tag;
+    bool ok;
+    while (cq_.cq().Next(&tag, &ok)) {
+    }
+  }
+
+  /// Deliver a completion to the operation, as `CompletionQueue::Run()` would.
+  void Notify(bool ok) {
+    ASSERT_NE(nullptr, tag_);
+    auto op = static_cast<bigtable::internal::AsyncOperation*>(tag_);
+    if (op->Notify(cq_, ok)) {
+      delete op;
+      tag_ = nullptr;
+    }
+  }
+
+  /// Wait for the backoff timer and deliver it to the operation.
+  void NotifyAlarm() {
+    void* tag;
+    bool ok;
+    ASSERT_TRUE(cq_.cq().Next(&tag, &ok));
+    EXPECT_EQ(tag_, tag);
+    Notify(ok);
+  }
+
+  /// Return a reader that completes the call with @p status.
+  MockAsyncMutateRowReader* MakeReader(grpc::Status status) {
+    // gRPC never deletes the unary readers (they live in the call arena), so
+    // the fixture owns them.
+    readers_.emplace_back(new MockAsyncMutateRowReader);
+    auto reader = readers_.back().get();
+    EXPECT_CALL(*reader, StartCall()).WillOnce(Return());
+    EXPECT_CALL(*reader, Finish(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(status), SaveArg<2>(&tag_)));
+    return reader;
+  }
+
+  bigtable::CompletionQueue cq_;
+  void* tag_ = nullptr;
+  std::vector<std::unique_ptr<MockAsyncMutateRowReader>> readers_;
+};
+}  // anonymous namespace
+
+/// @test Verify that AsyncApply() reports success with no failures.
+TEST_F(AsyncRowMutatorTest, Success) {
+  MutateRowRequest request;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowRaw(_, _, &cq_.cq()))
+      .WillOnce(DoAll(SaveArg<1>(&request),
+                      Return(MakeReader(grpc::Status::OK))));
+
+  auto result = table_.AsyncApply(
+      cq_, bigtable::SingleRowMutation(
+               "foo", {bigtable::SetCell("fam", "col", 0, "val")}));
+  EXPECT_EQ("foo", request.row_key());
+  EXPECT_EQ(kTableName, request.table_name());
+  EXPECT_EQ(1, request.mutations_size());
+  EXPECT_NE(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  ASSERT_EQ(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(result.get().empty());
+}
+
+/// @test Verify that AsyncApply() retries idempotent mutations using a timer.
+TEST_F(AsyncRowMutatorTest, RetryTransientFailure) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowRaw(_, _, _))
+      .WillOnce(Return(MakeReader(grpc::Status(grpc::UNAVAILABLE, "retry"))))
+      .WillOnce(Return(MakeReader(grpc::Status::OK)));
+
+  std::vector<bigtable::FailedMutation> failures;
+  bool called = false;
+  table_.AsyncApply(cq_,
+                    bigtable::SingleRowMutation(
+                        "foo", {bigtable::SetCell("fam", "col", 0, "val")}),
+                    [&](std::vector<bigtable::FailedMutation> f) {
+                      called = true;
+                      failures = std::move(f);
+                    });
+  Notify(true);   // Finish() -> UNAVAILABLE
+  NotifyAlarm();  // backoff expired, start the retry
+  EXPECT_FALSE(called);
+  Notify(true);  // Finish() -> OK
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(called);
+  EXPECT_TRUE(failures.empty());
+}
+
+/// @test Verify that permanent errors are reported without retrying.
+TEST_F(AsyncRowMutatorTest, PermanentFailure) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowRaw(_, _, _))
+      .WillOnce(
+          Return(MakeReader(grpc::Status(grpc::PERMISSION_DENIED, "uh-oh"))));
+
+  auto result = table_.AsyncApply(
+      cq_, bigtable::SingleRowMutation(
+               "foo", {bigtable::SetCell("fam", "col", 0, "val")}));
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  auto failures = result.get();
+  ASSERT_EQ(1U, failures.size());
+  EXPECT_EQ(grpc::PERMISSION_DENIED, failures[0].status().error_code());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ("foo", failures[0].mutation().row_key());
+}
+
+/// @test Verify that non-idempotent mutations are not retried.
+TEST_F(AsyncRowMutatorTest, NonIdempotentIsNotRetried) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowRaw(_, _, _))
+      .WillOnce(Return(MakeReader(grpc::Status(grpc::UNAVAILABLE, "retry"))));
+
+  // A SetCell() without a timestamp uses the server time.
+  auto result = table_.AsyncApply(
+      cq_, bigtable::SingleRowMutation(
+               "foo", {bigtable::SetCell("fam", "col", "val")}));
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  auto failures = result.get();
+  ASSERT_EQ(1U, failures.size());
+  EXPECT_EQ(grpc::UNAVAILABLE, failures[0].status().error_code());
+}
+
+/// @test Verify that a retry is not started after the queue is shutdown.
+TEST_F(AsyncRowMutatorTest, ShutdownDuringBackoff) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowRaw(_, _, _))
+      .WillOnce(Return(MakeReader(grpc::Status(grpc::UNAVAILABLE, "retry"))));
+
+  auto result = table_.AsyncApply(
+      cq_, bigtable::SingleRowMutation(
+               "foo", {bigtable::SetCell("fam", "col", 0, "val")}));
+  Notify(true);  // Finish() -> UNAVAILABLE, start the backoff
+  cq_.Shutdown();
+  NotifyAlarm();  // backoff expired, the queue is shutdown
+  EXPECT_EQ(nullptr, tag_);
+  auto failures = result.get();
+  ASSERT_EQ(1U, failures.size());
+  EXPECT_EQ(grpc::CANCELLED, failures[0].status().error_code());
+  EXPECT_EQ("foo", failures[0].mutation().row_key());
+}
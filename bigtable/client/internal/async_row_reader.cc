@@ -0,0 +1,190 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_row_reader.h"
+#include "bigtable/client/internal/make_unique.h"
+#include "bigtable/client/row_reader.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace {
+/**
+ * Run one of the parser member functions, converting exceptions to a status.
+ *
+ * The parser reports invalid data using exceptions, the synchronous RowReader
+ * converts them to a status in `RowReader::Advance()`, we do the same here
+ * because there is no application stack to propagate the exception to.
+ */
+template <typename Functor>
+grpc::Status CallParser(Functor&& f) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  try {
+    f();
+  } catch (std::exception const& ex) {
+    return grpc::Status(grpc::INTERNAL, ex.what());
+  }
+#else
+  f();
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  return grpc::Status::OK;
+}
+}  // anonymous namespace
+
+AsyncRowReader::AsyncRowReader(
+    std::shared_ptr<DataClient> client, std::string table_name, RowSet row_set,
+    std::int64_t rows_limit, Filter filter,
+    std::unique_ptr<RPCRetryPolicy> retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> backoff_policy, RowFunctor on_row,
+    FinishFunctor on_finish)
+    : client_(std::move(client)),
+      request_(table_name, std::move(row_set), rows_limit, filter),
+      retry_policy_(std::move(retry_policy)),
+      backoff_policy_(std::move(backoff_policy)),
+      on_row_(std::move(on_row)),
+      on_finish_(std::move(on_finish)),
+      state_(State::kStart),
+      cancelled_(false) {}
+
+bool AsyncRowReader::Start(CompletionQueue& cq) {
+  if (not cq.StartUnlessShutdown([this, &cq] { MakeRequest(cq); })) {
+    Complete(grpc::Status(grpc::StatusCode::CANCELLED,
+                          "the completion queue was shutdown"));
+    return false;
+  }
+  return true;
+}
+
+bool AsyncRowReader::Notify(CompletionQueue& cq, bool ok) {
+  switch (state_) {
+    case State::kStart:
+      if (not ok) {
+        FinishStream();
+        return false;
+      }
+      ReadNext();
+      return false;
+    case State::kReading:
+      if (not ok) {
+        // The stream has no more data, fetch the status to find out why.
+        FinishStream();
+        return false;
+      }
+      if (not ProcessResponse()) {
+        context_->TryCancel();
+        FinishStream();
+        return false;
+      }
+      ReadNext();
+      return false;
+    case State::kFinishing:
+      return OnFinish(cq);
+    case State::kBackoff:
+      if (not ok or
+          not cq.StartUnlessShutdown([this, &cq] { MakeRequest(cq); })) {
+        return Complete(grpc::Status(grpc::StatusCode::CANCELLED,
+                                     "the completion queue was shutdown"));
+      }
+      return false;
+  }
+  return false;
+}
+
+void AsyncRowReader::MakeRequest(CompletionQueue& cq) {
+  // Release the previous stream before the context it refers to.
+  stream_.reset();
+  context_ = make_unique<grpc::ClientContext>();
+  retry_policy_->setup(*context_);
+  backoff_policy_->setup(*context_);
+
+  parser_ = make_unique<ReadRowsParser>();
+  parser_status_ = grpc::Status::OK;
+  response_.Reset();
+
+  state_ = State::kStart;
+  stream_ =
+      client_->Stub()->PrepareAsyncReadRows(context_.get(), request_.request(),
+                                              &cq.cq());
+  stream_->StartCall(this);
+}
+
+void AsyncRowReader::ReadNext() {
+  response_.Reset();
+  state_ = State::kReading;
+  stream_->Read(&response_.get(), this);
+}
+
+void AsyncRowReader::FinishStream() {
+  state_ = State::kFinishing;
+  stream_->Finish(&status_, this);
+}
+
+bool AsyncRowReader::ProcessResponse() {
+  for (auto& chunk : *response_->mutable_chunks()) {
+    parser_status_ =
+        CallParser([this, &chunk] { parser_->ConsumeChunk(chunk); });
+    if (not parser_status_.ok()) {
+      return false;
+    }
+    if (not parser_->HasNext()) {
+      continue;
+    }
+    Row row = parser_->Next();
+    request_.OnRow(row);
+    if (not on_row_(std::move(row))) {
+      cancelled_ = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool AsyncRowReader::OnFinish(CompletionQueue& cq) {
+  if (cancelled_) {
+    // The application asked to stop, that is not an error.
+    return Complete(grpc::Status::OK);
+  }
+  grpc::Status status = parser_status_;
+  if (status.ok()) {
+    status = status_;
+  }
+  if (status.ok()) {
+    status = CallParser([this] { parser_->HandleEndOfStream(); });
+  }
+  if (status.ok()) {
+    return Complete(status);
+  }
+
+  // The rest of this function follows the same logic as RowReader::Advance().
+  if (not request_.PrepareRetry()) {
+    return Complete(grpc::Status::OK);
+  }
+  if (not retry_policy_->on_failure(status)) {
+    return Complete(status);
+  }
+
+  auto delay = backoff_policy_->on_completion(status);
+  state_ = State::kBackoff;
+  alarm_.Set(&cq.cq(), std::chrono::system_clock::now() + delay, this);
+  return false;
+}
+
+bool AsyncRowReader::Complete(grpc::Status const& status) {
+  on_finish_(status);
+  return true;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
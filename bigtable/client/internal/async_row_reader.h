@@ -0,0 +1,121 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_READER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_READER_H_
+
+#include "bigtable/client/completion_queue.h"
+#include "bigtable/client/data_client.h"
+#include "bigtable/client/filters.h"
+#include "bigtable/client/internal/arena_message.h"
+#include "bigtable/client/internal/readrowsparser.h"
+#include "bigtable/client/internal/resumable_request.h"
+#include "bigtable/client/row_set.h"
+#include "bigtable/client/rpc_backoff_policy.h"
+#include "bigtable/client/rpc_retry_policy.h"
+
+#include <grpc++/alarm.h>
+#include <functional>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Implement `Table::AsyncReadRows()` as a state machine on a CompletionQueue.
+ *
+ * The state machine mirrors the logic in `bigtable::RowReader`, but it never
+ * blocks the calling thread: the streaming RPC, the reads, and the backoff
+ * between retries are all asynchronous operations in the completion queue.
+ *
+ * The next `Read()` on the stream is only issued after all the rows in the
+ * previous response have been delivered to the application, that is, a slow
+ * consumer pushes back on the stream (and gRPC's flow control pushes back on
+ * the server).  The row callback returns `false` to stop the scan early.
+ */
+class AsyncRowReader : public AsyncOperation {
+ public:
+  using RowFunctor = std::function<bool(Row)>;
+  using FinishFunctor = std::function<void(grpc::Status const&)>;
+
+  AsyncRowReader(std::shared_ptr<DataClient> client, std::string table_name,
+                 RowSet row_set, std::int64_t rows_limit, Filter filter,
+                 std::unique_ptr<RPCRetryPolicy> retry_policy,
+                 std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                 RowFunctor on_row, FinishFunctor on_finish);
+
+  /**
+   * Start the first request, the object is owned by @p cq after this call.
+   *
+   * @return false if @p cq is shut down.  In that case the operation
+   *     completes with `grpc::StatusCode::CANCELLED`, and the caller still
+   *     owns the object.
+   */
+  bool Start(CompletionQueue& cq);
+
+  bool Notify(CompletionQueue& cq, bool ok) override;
+
+ private:
+  /// Send the ReadRows request, the completion is reported via Notify().
+  void MakeRequest(CompletionQueue& cq);
+
+  /// Request the next response from the stream.
+  void ReadNext();
+
+  /// Request the final status of the stream.
+  void FinishStream();
+
+  /**
+   * Parse a response and deliver the completed rows.
+   *
+   * @return false if the application (or a parsing error) stopped the stream.
+   */
+  bool ProcessResponse();
+
+  /// Handle the end of a stream, return true if the operation completed.
+  bool OnFinish(CompletionQueue& cq);
+
+  /// Report the final status to the application.
+  bool Complete(grpc::Status const& status);
+
+  enum class State { kStart, kReading, kFinishing, kBackoff };
+
+  std::shared_ptr<DataClient> client_;
+  ResumableRequest request_;
+  std::unique_ptr<RPCRetryPolicy> retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  RowFunctor on_row_;
+  FinishFunctor on_finish_;
+
+  State state_;
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<ReadRowsParser> parser_;
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<google::bigtable::v2::ReadRowsResponse>>
+      stream_;
+  /// Reused (via its arena) for all the responses in this operation.
+  ArenaMessage<google::bigtable::v2::ReadRowsResponse> response_;
+  grpc::Status status_;
+  grpc::Alarm alarm_;
+
+  /// Set when the application asked to stop the scan.
+  bool cancelled_;
+  /// Set when the parser failed, reported as `grpc::INTERNAL`.
+  grpc::Status parser_status_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ASYNC_ROW_READER_H_
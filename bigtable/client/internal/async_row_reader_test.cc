@@ -0,0 +1,273 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/async_row_reader.h"
+#include "bigtable/client/table.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+using testing::SaveArg;
+using testing::SetArgPointee;
+
+using google::bigtable::v2::ReadRowsRequest;
+using google::bigtable::v2::ReadRowsResponse;
+using bigtable::testing::MockAsyncResponseStream;
+
+namespace {
+class AsyncRowReaderTest : public bigtable::testing::TableTestFixture {
+ protected:
+  ~AsyncRowReaderTest() override {
+    cq_.Shutdown();
+    void* tag;
+    bool ok;
+    while (cq_.cq().Next(&tag, &ok)) {
+    }
+  }
+
+  /// Deliver a completion to the operation, as `CompletionQueue::Run()` would.
+  void Notify(bool ok) {
+    ASSERT_NE(nullptr, tag_);
+    auto op = static_cast<bigtable::internal::AsyncOperation*>(tag_);
+    if (op->Notify(cq_, ok)) {
+      delete op;
+      tag_ = nullptr;
+    }
+  }
+
+  /// Wait for the backoff timer and deliver it to the operation.
+  void NotifyAlarm() {
+    void* tag;
+    bool ok;
+    ASSERT_TRUE(cq_.cq().Next(&tag, &ok));
+    EXPECT_EQ(tag_, tag);
+    Notify(ok);
+  }
+
+  std::function<bool(bigtable::Row)> CaptureKeys() {
+    return [this](bigtable::Row row) {
+      keys_.push_back(row.row_key());
+      return true;
+    };
+  }
+
+  bigtable::CompletionQueue cq_;
+  void* tag_ = nullptr;
+  std::vector<std::string> keys_;
+};
+
+ReadRowsResponse MakeResponse(std::vector<std::string> const& keys) {
+  ReadRowsResponse response;
+  for (auto const& key : keys) {
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key(key);
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("qual");
+    chunk.set_timestamp_micros(42000);
+    chunk.set_value("value");
+    chunk.set_commit_row(true);
+  }
+  return response;
+}
+}  // anonymous namespace
+
+/// @test Verify that AsyncReadRows() delivers rows and the final status.
+TEST_F(AsyncRowReaderTest, ReadOneRow) {
+  // must be a new pointer, it is wrapped in unique_ptr by PrepareAsyncReadRows
+  auto stream = new MockAsyncResponseStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, &cq_.cq()))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({"r1"})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 0,
+                                     bigtable::Filter::PassAllFilter());
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> r1
+  Notify(false);  // Read() -> end of stream
+  EXPECT_EQ(std::vector<std::string>{"r1"}, keys_);
+  EXPECT_NE(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  ASSERT_EQ(std::future_status::ready,
+            result.wait_for(std::chrono::seconds(0)));
+  EXPECT_TRUE(result.get().ok());
+}
+
+/// @test Verify that returning false from the row callback stops the stream.
+TEST_F(AsyncRowReaderTest, StopFromCallback) {
+  auto stream = new MockAsyncResponseStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({"r1", "r2", "r3"})));
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status(grpc::CANCELLED, "cancelled")));
+
+  int count = 0;
+  grpc::Status status(grpc::UNKNOWN, "not called");
+  table_.AsyncReadRows(cq_,
+                       [&count](bigtable::Row) { return ++count < 2; },
+                       [&status](grpc::Status const& s) { status = s; },
+                       bigtable::RowSet(), 0,
+                       bigtable::Filter::PassAllFilter());
+  Notify(true);  // StartCall()
+  Notify(true);  // Read() -> r1, r2, stop
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_EQ(2, count);
+  EXPECT_TRUE(status.ok());
+}
+
+/// @test Verify that AsyncReadRows() resumes after the last row on failures.
+TEST_F(AsyncRowReaderTest, RetryResumesAfterLastRow) {
+  auto stream = new MockAsyncResponseStream;
+  auto stream_retry = new MockAsyncResponseStream;
+  ReadRowsRequest retry_request;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Return(stream))
+      .WillOnce(Invoke([stream_retry, &retry_request](
+                           grpc::ClientContext*, ReadRowsRequest const& r,
+                           grpc::CompletionQueue*) {
+        retry_request = r;
+        return stream_retry;
+      }));
+
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({"r1"})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status(grpc::UNAVAILABLE, "try-again")));
+
+  EXPECT_CALL(*stream_retry, StartCall(_)).WillOnce(Return());
+  EXPECT_CALL(*stream_retry, Read(_, _))
+      .WillOnce(SetArgPointee<0>(MakeResponse({"r2"})))
+      .WillOnce(Return());
+  EXPECT_CALL(*stream_retry, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status::OK));
+
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 5,
+                                     bigtable::Filter::PassAllFilter());
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> r1
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish() -> UNAVAILABLE
+  NotifyAlarm();  // backoff expired, start the retry
+  EXPECT_EQ(4, retry_request.rows_limit());
+  ASSERT_EQ(1, retry_request.rows().row_ranges_size());
+  EXPECT_EQ("r1", retry_request.rows().row_ranges(0).start_key_open());
+
+  Notify(true);   // StartCall()
+  Notify(true);   // Read() -> r2
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_EQ((std::vector<std::string>{"r1", "r2"}), keys_);
+  EXPECT_TRUE(result.get().ok());
+}
+
+/// @test Verify that permanent errors are reported without retrying.
+TEST_F(AsyncRowReaderTest, PermanentFailure) {
+  auto stream = new MockAsyncResponseStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _)).WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(
+          grpc::Status(grpc::PERMISSION_DENIED, "uh-oh")));
+
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 0,
+                                     bigtable::Filter::PassAllFilter());
+  Notify(true);   // StartCall()
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(keys_.empty());
+  EXPECT_EQ(grpc::PERMISSION_DENIED, result.get().error_code());
+}
+
+/// @test Verify that a retry is not started after the queue is shutdown.
+TEST_F(AsyncRowReaderTest, ShutdownDuringBackoff) {
+  auto stream = new MockAsyncResponseStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _)).WillOnce(Return());
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status(grpc::UNAVAILABLE, "try-again")));
+
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 0,
+                                     bigtable::Filter::PassAllFilter());
+  Notify(true);   // StartCall()
+  Notify(false);  // Read() -> end of stream
+  Notify(true);   // Finish() -> UNAVAILABLE, start the backoff
+  cq_.Shutdown();
+  NotifyAlarm();  // backoff expired, the queue is shutdown
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_EQ(grpc::CANCELLED, result.get().error_code());
+}
+
+/// @test Verify that no request is started in a queue that is shutdown.
+TEST_F(AsyncRowReaderTest, StartAfterShutdown) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _)).Times(0);
+
+  cq_.Shutdown();
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 0,
+                                     bigtable::Filter::PassAllFilter());
+  EXPECT_TRUE(keys_.empty());
+  EXPECT_EQ(grpc::CANCELLED, result.get().error_code());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that invalid chunks are reported, like in RowReader.
+TEST_F(AsyncRowReaderTest, ParserError) {
+  auto stream = new MockAsyncResponseStream;
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Return(stream));
+
+  // A chunk without a row key cannot start a row.
+  ReadRowsResponse bad;
+  bad.add_chunks()->set_commit_row(true);
+  EXPECT_CALL(*stream, StartCall(_)).WillOnce(SaveArg<0>(&tag_));
+  EXPECT_CALL(*stream, Read(_, _)).WillOnce(SetArgPointee<0>(bad));
+  EXPECT_CALL(*stream, Finish(_, _))
+      .WillOnce(SetArgPointee<0>(grpc::Status(grpc::CANCELLED, "cancelled")));
+
+  auto result = table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), 0,
+                                     bigtable::Filter::PassAllFilter());
+  Notify(true);  // StartCall()
+  Notify(true);  // Read() -> invalid chunk
+  Notify(true);  // Finish()
+  EXPECT_EQ(nullptr, tag_);
+  EXPECT_TRUE(keys_.empty());
+  EXPECT_EQ(grpc::INTERNAL, result.get().error_code());
+}
+
+TEST_F(AsyncRowReaderTest, FailsForIllegalRowLimit) {
+  EXPECT_THROW(
+      table_.AsyncReadRows(cq_, CaptureKeys(), bigtable::RowSet(), -1,
+                           bigtable::Filter::PassAllFilter()),
+      std::invalid_argument);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
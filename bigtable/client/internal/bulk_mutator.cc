@@ -27,7 +27,7 @@ namespace btproto = google::bigtable::v2;
 BulkMutator::BulkMutator(std::string const &table_name,
                          IdempotentMutationPolicy &idempotent_policy,
                          BulkMutation &&mut) {
-  // Every time the client library calls MakeOneRequest(), the data in the
+  // Every time the client library calls PrepareForRequest(), the data in the
   // "pending_*" variables initializes the next request.  So in the constructor
   // we start by putting the data on the "pending_*" variables.
   // Move the mutations to the "pending" request proto, this is a zero copy
@@ -51,20 +51,7 @@ BulkMutator::BulkMutator(std::string const &table_name,
   }
 }
 
-grpc::Status BulkMutator::MakeOneRequest(btproto::Bigtable::StubInterface &stub,
-                                         grpc::ClientContext &client_context) {
-  PrepareForRequest();
-  // Send the request to the server and read the resulting result stream.
-  auto stream = stub.MutateRows(&client_context, mutations_);
-  btproto::MutateRowsResponse response;
-  while (stream->Read(&response)) {
-    ProcessResponse(response);
-  }
-  FinishRequest();
-  return stream->Finish();
-}
-
-void BulkMutator::PrepareForRequest() {
+btproto::MutateRowsRequest const &BulkMutator::PrepareForRequest() {
   mutations_.Swap(&pending_mutations_);
   annotations_.swap(pending_annotations_);
   for (auto &a : annotations_) {
@@ -73,6 +60,7 @@ void BulkMutator::PrepareForRequest() {
   pending_mutations_ = {};
   pending_mutations_.set_table_name(mutations_.table_name());
   pending_annotations_ = {};
+  return mutations_;
 }
 
 void BulkMutator::ProcessResponse(
@@ -140,16 +128,47 @@ void BulkMutator::FinishRequest() {
 }
 
 std::vector<FailedMutation> BulkMutator::ExtractFinalFailures() {
-  std::vector<FailedMutation> result(std::move(failures_));
   google::rpc::Status ok_status;
   ok_status.set_code(grpc::StatusCode::OK);
+  return ExtractFinalFailures(ok_status);
+}
+
+std::vector<FailedMutation> BulkMutator::ExtractFinalFailures(
+    google::rpc::Status const& status) {
+  std::vector<FailedMutation> result(std::move(failures_));
+  int idx = 0;
   for (auto &mutation : *pending_mutations_.mutable_entries()) {
-    result.emplace_back(
-        FailedMutation(SingleRowMutation(std::move(mutation)), ok_status));
+    // The mutations in `pending_mutations_` have an unknown result, report
+    // them with their index in the original request.
+    int original_index = pending_annotations_[idx++].original_index;
+    result.emplace_back(FailedMutation(SingleRowMutation(std::move(mutation)),
+                                       status, original_index));
   }
   return result;
 }
 
+std::vector<BulkMutationShard> SplitBulkMutation(BulkMutation &&mut,
+                                                 std::size_t max_mutations,
+                                                 std::size_t max_bytes) {
+  btproto::MutateRowsRequest request;
+  mut.MoveTo(&request);
+  std::vector<BulkMutationShard> shards;
+  int index = 0;
+  for (auto &entry : *request.mutable_entries()) {
+    auto count = static_cast<std::size_t>(entry.mutations_size());
+    auto bytes = entry.ByteSizeLong();
+    if (shards.empty() or
+        (not shards.back().mutation.empty() and
+         (shards.back().mutation.mutation_count() + count > max_mutations or
+          shards.back().mutation.byte_size() + bytes > max_bytes))) {
+      shards.push_back(BulkMutationShard{index, BulkMutation()});
+    }
+    shards.back().mutation.emplace_back(SingleRowMutation(std::move(entry)));
+    ++index;
+  }
+  return shards;
+}
+
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
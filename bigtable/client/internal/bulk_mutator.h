@@ -22,7 +22,14 @@
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
-/// Keep the state in the Table::BulkApply() member function.
+/**
+ * Keep the state in the Table::AsyncBulkApply() member function.
+ *
+ * The mutations are sent in rounds, each round retries the mutations that
+ * failed in the previous one.  `AsyncBulkMutator` drives each request and
+ * calls `PrepareForRequest()`, `ProcessResponse()`, and `FinishRequest()` as
+ * the responses arrive.
+ */
 class BulkMutator {
  public:
   BulkMutator(std::string const& table_name,
@@ -33,17 +40,15 @@ class BulkMutator {
     return pending_mutations_.entries_size() != 0;
   }
 
-  /// Send one batch request to the given stub.
-  grpc::Status MakeOneRequest(
-      google::bigtable::v2::Bigtable::StubInterface& stub,
-      grpc::ClientContext& client_context);
-
   /// Give up on any pending mutations, move them to the failures array.
   std::vector<FailedMutation> ExtractFinalFailures();
 
- private:
-  /// Get ready for a new request.
-  void PrepareForRequest();
+  /// Give up on any pending mutations, reporting them with @p status.
+  std::vector<FailedMutation> ExtractFinalFailures(
+      google::rpc::Status const& status);
+
+  /// Get ready for a new request, return the request to send.
+  google::bigtable::v2::MutateRowsRequest const& PrepareForRequest();
 
   /// Process a single response.
   void ProcessResponse(google::bigtable::v2::MutateRowsResponse& response);
@@ -87,6 +92,34 @@ class BulkMutator {
   /// Accumulate annotations for the next request.
   std::vector<Annotations> pending_annotations_;
 };
+
+/// The service rejects `MutateRows` requests with more mutations than this.
+constexpr std::size_t kBulkApplyMaxMutations = 100000;
+
+/// `Table::BulkApply()` splits the mutations in requests of at most this size.
+constexpr std::size_t kBulkApplyMaxBytes = 32 * 1024 * 1024;
+
+/// The maximum number of concurrent requests in a single `BulkApply()`.
+constexpr std::size_t kBulkApplyMaxConcurrency = 8;
+
+/// A subset of the mutations in a `BulkMutation`.
+struct BulkMutationShard {
+  /// The index of the first mutation of the shard in the original set.
+  int first_index;
+  BulkMutation mutation;
+};
+
+/**
+ * Split @p mut into shards within the given limits.
+ *
+ * The mutations keep their original order, and each shard contains at most
+ * @p max_mutations mutations and @p max_bytes bytes.  A single row that
+ * exceeds the limits is placed in a shard by itself.
+ */
+std::vector<BulkMutationShard> SplitBulkMutation(BulkMutation&& mut,
+                                                 std::size_t max_mutations,
+                                                 std::size_t max_bytes);
+
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
 }  // namespace bigtable
@@ -28,6 +28,20 @@ class MockReader : public grpc::ClientReaderInterface<
   MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
   MOCK_METHOD1(Read, bool(::google::bigtable::v2::MutateRowsResponse*));
 };
+
+/// Run one request, as `AsyncBulkMutator` does, but blocking.
+grpc::Status MakeOneRequest(bigtable::internal::BulkMutator& mutator,
+                            google::bigtable::v2::Bigtable::StubInterface& stub,
+                            grpc::ClientContext& context) {
+  auto stream = stub.MutateRows(&context, mutator.PrepareForRequest());
+  google::bigtable::v2::MutateRowsResponse response;
+  while (stream->Read(&response)) {
+    mutator.ProcessResponse(response);
+    response.Clear();
+  }
+  mutator.FinishRequest();
+  return stream->Finish();
+}
 }  // anonymous namespace
 
 /// @test Verify that MultipleRowsMutator handles easy cases.
@@ -77,7 +91,7 @@ TEST(MultipleRowsMutatorTest, Simple) {
 
   EXPECT_TRUE(mutator.HasPendingMutations());
   grpc::ClientContext context;
-  auto status = mutator.MakeOneRequest(stub, context);
+  auto status = MakeOneRequest(mutator, stub, context);
   EXPECT_TRUE(status.ok());
   auto failures = mutator.ExtractFinalFailures();
   EXPECT_TRUE(failures.empty());
@@ -145,12 +159,13 @@ TEST(MultipleRowsMutatorTest, RetryPartialFailure) {
   bt::internal::BulkMutator mutator("foo/bar/baz/table", *policy,
                                     std::move(mut));
 
-  // This work will be in BulkApply(), but this is the test for BulkMutator in
-  // isolation, so call MakeOneRequest() twice, for the r1, and the r2 cases.
+  // This work will be in AsyncBulkApply(), but this is the test for
+  // BulkMutator in isolation, so call MakeOneRequest() twice, for the r1, and
+  // the r2 cases.
   for (int i = 0; i != 2; ++i) {
     EXPECT_TRUE(mutator.HasPendingMutations());
     grpc::ClientContext context;
-    auto status = mutator.MakeOneRequest(stub, context);
+    auto status = MakeOneRequest(mutator, stub, context);
     EXPECT_TRUE(status.ok());
   }
   auto failures = mutator.ExtractFinalFailures();
@@ -217,12 +232,13 @@ TEST(MultipleRowsMutatorTest, PermanentFailure) {
   bt::internal::BulkMutator mutator("foo/bar/baz/table", *policy,
                                     std::move(mut));
 
-  // This work will be in BulkApply(), but this is the test for BulkMutator in
-  // isolation, so call MakeOneRequest() twice, for the r1, and the r2 cases.
+  // This work will be in AsyncBulkApply(), but this is the test for
+  // BulkMutator in isolation, so call MakeOneRequest() twice, for the r1, and
+  // the r2 cases.
   for (int i = 0; i != 2; ++i) {
     EXPECT_TRUE(mutator.HasPendingMutations());
     grpc::ClientContext context;
-    auto status = mutator.MakeOneRequest(stub, context);
+    auto status = MakeOneRequest(mutator, stub, context);
     EXPECT_TRUE(status.ok());
   }
   auto failures = mutator.ExtractFinalFailures();
@@ -288,12 +304,13 @@ TEST(MultipleRowsMutatorTest, PartialStream) {
   bt::internal::BulkMutator mutator("foo/bar/baz/table", *policy,
                                     std::move(mut));
 
-  // This work will be in BulkApply(), but this is the test for BulkMutator in
-  // isolation, so call MakeOneRequest() twice: for the r1 and r2 cases.
+  // This work will be in AsyncBulkApply(), but this is the test for
+  // BulkMutator in isolation, so call MakeOneRequest() twice: for the r1 and
+  // r2 cases.
   for (int i = 0; i != 2; ++i) {
     EXPECT_TRUE(mutator.HasPendingMutations());
     grpc::ClientContext context;
-    auto status = mutator.MakeOneRequest(stub, context);
+    auto status = MakeOneRequest(mutator, stub, context);
     EXPECT_TRUE(status.ok());
   }
   auto failures = mutator.ExtractFinalFailures();
@@ -369,12 +386,13 @@ TEST(MultipleRowsMutatorTest, RetryOnlyIdempotent) {
   bt::internal::BulkMutator mutator("foo/bar/baz/table", *policy,
                                     std::move(mut));
 
-  // This work will be in BulkApply(), but this is the test for BulkMutator in
-  // isolation, so call MakeOneRequest() twice, for the r1, and the r2 cases.
+  // This work will be in AsyncBulkApply(), but this is the test for
+  // BulkMutator in isolation, so call MakeOneRequest() twice, for the r1, and
+  // the r2 cases.
   for (int i = 0; i != 2; ++i) {
     EXPECT_TRUE(mutator.HasPendingMutations());
     grpc::ClientContext context;
-    auto status = mutator.MakeOneRequest(stub, context);
+    auto status = MakeOneRequest(mutator, stub, context);
     EXPECT_TRUE(status.ok());
   }
   auto failures = mutator.ExtractFinalFailures();
@@ -387,3 +405,102 @@ TEST(MultipleRowsMutatorTest, RetryOnlyIdempotent) {
   EXPECT_EQ("baz", failures[1].mutation().row_key());
   EXPECT_EQ(grpc::StatusCode::OK, failures[1].status().error_code());
 }
+
+/// @test Verify that unknown results are reported with their original index.
+TEST(MultipleRowsMutatorTest, UnknownResultKeepsIndex) {
+  namespace btproto = ::google::bigtable::v2;
+  namespace bt = ::bigtable;
+  using namespace ::testing;
+
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("foo", {bt::SetCell("fam", "col", 0, "baz")}),
+      bt::SingleRowMutation("bar", {bt::SetCell("fam", "col", 0, "qux")}));
+
+  // The stream is missing the result for the second mutation.
+  auto r1 = bigtable::internal::make_unique<MockReader>();
+  EXPECT_CALL(*r1, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse* r) {
+        auto& e0 = *r->add_entries();
+        e0.set_index(0);
+        e0.mutable_status()->set_code(grpc::OK);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r1, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  btproto::MockBigtableStub stub;
+  EXPECT_CALL(stub, MutateRowsRaw(_, _))
+      .WillOnce(Invoke(
+          [&r1](grpc::ClientContext*, btproto::MutateRowsRequest const&) {
+            return r1.release();
+          }));
+
+  auto policy = bt::DefaultIdempotentMutationPolicy();
+  bt::internal::BulkMutator mutator("foo/bar/baz/table", *policy,
+                                    std::move(mut));
+
+  grpc::ClientContext context;
+  auto status = MakeOneRequest(mutator, stub, context);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(mutator.HasPendingMutations());
+
+  // Give up on the pending mutation, it should keep its original index.
+  auto failures = mutator.ExtractFinalFailures();
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::StatusCode::OK, failures[0].status().error_code());
+}
+
+/// @test Verify that SplitBulkMutation() respects the limits.
+TEST(SplitBulkMutationTest, Simple) {
+  namespace btproto = ::google::bigtable::v2;
+  namespace bt = ::bigtable;
+
+  bt::BulkMutation mut;
+  for (int i = 0; i != 7; ++i) {
+    mut.emplace_back(bt::SingleRowMutation(
+        "row" + std::to_string(i), {bt::SetCell("fam", "c0", 0, "v0"),
+                                    bt::SetCell("fam", "c1", 0, "v1")}));
+  }
+  ASSERT_EQ(14U, mut.mutation_count());
+
+  // At most 5 mutations per shard, so the rows (with 2 mutations each) are
+  // placed 2 per shard.
+  auto shards = bt::internal::SplitBulkMutation(std::move(mut), 5, 1000000);
+  EXPECT_TRUE(mut.empty());
+  ASSERT_EQ(4U, shards.size());
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i != shards.size(); ++i) {
+    EXPECT_EQ(static_cast<int>(2 * i), shards[i].first_index);
+    EXPECT_GE(5U, shards[i].mutation.mutation_count());
+    btproto::MutateRowsRequest request;
+    shards[i].mutation.MoveTo(&request);
+    for (auto const& e : request.entries()) {
+      keys.push_back(e.row_key());
+    }
+  }
+  EXPECT_EQ((std::vector<std::string>{"row0", "row1", "row2", "row3", "row4",
+                                      "row5", "row6"}),
+            keys);
+}
+
+/// @test Verify that SplitBulkMutation() splits by size.
+TEST(SplitBulkMutationTest, ByteLimit) {
+  namespace bt = ::bigtable;
+
+  bt::BulkMutation mut;
+  for (int i = 0; i != 3; ++i) {
+    mut.emplace_back(bt::SingleRowMutation(
+        "row" + std::to_string(i),
+        bt::SetCell("fam", "col", 0, std::string(100, 'x'))));
+  }
+
+  // Each row is larger than the limit, so each is in its own shard.
+  auto shards = bt::internal::SplitBulkMutation(std::move(mut), 1000, 100);
+  ASSERT_EQ(3U, shards.size());
+  for (std::size_t i = 0; i != shards.size(); ++i) {
+    EXPECT_EQ(static_cast<int>(i), shards[i].first_index);
+    EXPECT_EQ(1U, shards[i].mutation.size());
+  }
+}
@@ -0,0 +1,136 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CELL_VISITOR_PARSER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CELL_VISITOR_PARSER_H_
+
+#include "bigtable/client/cell_visitor.h"
+#include "bigtable/client/internal/chunk_parser.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Forwards the contents of the chunks to a `CellVisitor`.
+ *
+ * This is the `Handler` for `ChunkParser` used by `CellVisitorParser`.
+ */
+class CellVisitorAdapter {
+ public:
+  CellVisitorAdapter() : visitor_(nullptr), committed_rows_(0) {}
+
+  void set_visitor(CellVisitor& visitor) { visitor_ = &visitor; }
+
+  void OnFamily(std::string& family) { family_.swap(family); }
+  void OnQualifier(std::string& qualifier) { qualifier_.swap(qualifier); }
+  void OnRowStart(std::string const& row_key) {
+    visitor_->OnRowStart(row_key);
+  }
+  void OnCell(std::int64_t timestamp, std::string& value,
+              std::vector<std::string>& labels) {
+    visitor_->OnCell(family_, qualifier_, timestamp, value, labels);
+  }
+  bool OnValueStart(std::int64_t timestamp, std::size_t value_size,
+                    std::vector<std::string>& labels) {
+    return visitor_->OnLargeCellStart(family_, qualifier_, timestamp,
+                                      value_size, labels);
+  }
+  void OnValueChunk(std::string& data) { visitor_->OnCellValueChunk(data); }
+  void OnValueEnd() { visitor_->OnLargeCellEnd(); }
+  void OnRowCommit() {
+    ++committed_rows_;
+    visitor_->OnRowCommit();
+  }
+  void OnRowReset() { visitor_->OnRowReset(); }
+
+  /// Return the number of rows committed since the last call.
+  std::int64_t TakeCommittedRows() {
+    auto count = committed_rows_;
+    committed_rows_ = 0;
+    return count;
+  }
+
+ private:
+  CellVisitor* visitor_;
+  std::string family_;
+  std::string qualifier_;
+  std::int64_t committed_rows_;
+};
+
+/**
+ * Parse the chunks in a ReadRows stream and report them to a `CellVisitor`.
+ *
+ * Uses the same validation rules as `ReadRowsParser`, but no rows are
+ * created, the values are passed to the visitor directly from the chunks
+ * (or from a single buffer if the value is split across chunks).
+ *
+ * A single parser should be used for each stream of ReadRows responses.
+ */
+class CellVisitorParser {
+ public:
+  CellVisitorParser() = default;
+
+  /**
+   * Parse @p chunk, reporting any complete cells to @p visitor.
+   *
+   * @throws ParserError if validation failed.
+   */
+  void Consume(google::bigtable::v2::ReadRowsResponse_CellChunk& chunk,
+               CellVisitor& visitor) {
+    adapter_.set_visitor(visitor);
+    chunks_.Consume(chunk, adapter_);
+  }
+
+  /**
+   * Signal that the input stream reached the end.
+   *
+   * @throws ParserError if more data was expected to finish
+   * the current row.
+   */
+  void HandleEndOfStream() { chunks_.HandleEndOfStream(); }
+
+  /// Report the row in progress (if any) as reset to @p visitor.
+  void DiscardPartialRow(CellVisitor& visitor) {
+    if (chunks_.row_in_progress()) {
+      visitor.OnRowReset();
+    }
+  }
+
+  /// Return the number of rows committed since the last call.
+  std::int64_t TakeCommittedRows() { return adapter_.TakeCommittedRows(); }
+
+  /// The key of the last committed row, empty if none.
+  std::string const& last_seen_row_key() const {
+    return chunks_.last_seen_row_key();
+  }
+
+  /// Limit the size of a row, larger rows are rejected as invalid data.
+  void set_max_row_bytes(std::size_t n) { chunks_.set_max_row_bytes(n); }
+
+  /// The number of bytes received so far for the row in progress.
+  std::size_t partial_row_bytes() const { return chunks_.row_bytes(); }
+
+  /// Enable or disable the row key order checks, see `ChunkParser`.
+  void set_validate_row_keys(bool v) { chunks_.set_validate_row_keys(v); }
+
+ private:
+  ChunkParser<CellVisitorAdapter> chunks_;
+  CellVisitorAdapter adapter_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CELL_VISITOR_PARSER_H_
@@ -0,0 +1,362 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CHUNK_PARSER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CHUNK_PARSER_H_
+
+#include "bigtable/client/version.h"
+
+#include <google/bigtable/v2/bigtable.pb.h>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * The default for `ChunkParser::validate_row_keys()`.
+ *
+ * Builds for trusted deployments can define
+ * `BIGTABLE_CLIENT_SKIP_ROW_KEY_VALIDATION` (see the CMake option with the
+ * same name) to skip the row key comparisons by default.
+ */
+#ifdef BIGTABLE_CLIENT_SKIP_ROW_KEY_VALIDATION
+constexpr bool kDefaultValidateRowKeys = false;
+#else
+constexpr bool kDefaultValidateRowKeys = true;
+#endif  // BIGTABLE_CLIENT_SKIP_ROW_KEY_VALIDATION
+
+/**
+ * Validate the chunks in a ReadRows stream and report their contents.
+ *
+ * The chunks in a `ReadRowsResponse` use a compact encoding: the row key,
+ * family name and column qualifier are only sent when they change, cell
+ * values may be split across several chunks, and rows are explicitly
+ * committed or reset.  This class implements the validation rules for that
+ * encoding, and reports the contents to a `Handler` as a sequence of
+ * events.  The handler decides how to store the data (`Row` objects, a
+ * columnar `RowBatch`, etc.).  The handler functions are resolved at compile
+ * time, so they can be inlined in the parsing loop.
+ *
+ * The `Handler` type must provide the following member functions:
+ *
+ * - `void OnFamily(std::string& family)`: the following cells are in
+ *   @p family.  The handler can take the contents of the string.
+ * - `void OnQualifier(std::string& qualifier)`: same for the column qualifier.
+ * - `void OnRowStart(std::string const& row_key)`: a new row starts, this is
+ *   called when its first cell is complete, or when the first cell starts
+ *   with a value split across several chunks.
+ * - `void OnCell(std::int64_t timestamp, std::string& value,
+ *   std::vector<std::string>& labels)`: a cell is complete.  The handler can
+ *   take the contents of @p value and @p labels.
+ * - `bool OnValueStart(std::int64_t timestamp, std::size_t value_size,
+ *   std::vector<std::string>& labels)`: a cell starts, and its value is split
+ *   across several chunks, adding up to @p value_size bytes.  Return true to
+ *   receive the value in pieces, in which case the handler gets
+ *   `OnValueChunk()` calls and `OnValueEnd()` instead of `OnCell()`, and the
+ *   value does not count towards `max_row_bytes()`.  The handler can take
+ *   the contents of @p labels only if it returns true.
+ * - `void OnValueChunk(std::string& data)`: the next piece of the value.  The
+ *   handler can take the contents of @p data.
+ * - `void OnValueEnd()`: the value is complete.
+ * - `void OnRowCommit()`: the current row is complete.
+ * - `void OnRowReset()`: the cells reported since the last `OnRowStart()`
+ *   must be discarded.
+ *
+ * If the data is invalid, or a row is larger than `max_row_bytes()`, the
+ * functions raise an exception (or abort if exceptions are disabled), and the
+ * parser is left in an unspecified state.
+ */
+template <typename Handler>
+class ChunkParser {
+ public:
+  ChunkParser()
+      : cell_first_chunk_(true),
+        row_in_progress_(false),
+        timestamp_(0),
+        value_size_(0),
+        value_bytes_(0),
+        streaming_value_(false),
+        row_bytes_(0),
+        max_row_bytes_(std::numeric_limits<std::size_t>::max()),
+        validate_row_keys_(kDefaultValidateRowKeys),
+        end_of_stream_(false) {}
+
+  /**
+   * Enable or disable the row key checks.
+   *
+   * The parser verifies that the row keys are in increasing order, and that
+   * the chunks of a cell do not change the row key.  These checks compare
+   * the row keys, which is expensive for long keys, and they only detect
+   * bugs in the service.  Other validation rules are always enforced, they
+   * are needed to parse the chunks correctly.
+   */
+  void set_validate_row_keys(bool v) { validate_row_keys_ = v; }
+  bool validate_row_keys() const { return validate_row_keys_; }
+
+  /**
+   * Limit the size of a row.
+   *
+   * The size of a row is the size of its key, and the family names, column
+   * qualifiers, values and labels of its cells.  The parser raises an error
+   * as soon as the data received for a row exceeds @p n bytes (or a cell
+   * announces a larger value), before the handler receives the rest of the
+   * row.
+   */
+  void set_max_row_bytes(std::size_t n) { max_row_bytes_ = n; }
+  std::size_t max_row_bytes() const { return max_row_bytes_; }
+
+  /// The number of bytes received so far for the row in progress.
+  std::size_t row_bytes() const { return row_bytes_; }
+
+  /**
+   * Process a chunk, taking the data it needs from the chunk.
+   *
+   * The chunk is left in a valid but unspecified state.
+   */
+  void Consume(google::bigtable::v2::ReadRowsResponse_CellChunk& chunk,
+               Handler& handler) {
+    if (end_of_stream_) {
+      RaiseParserError("HandleChunk after end of stream");
+    }
+
+    if (not chunk.row_key().empty()) {
+      if (validate_row_keys_ and
+          last_seen_row_key_.compare(chunk.row_key()) >= 0) {
+        RaiseParserError("Row keys are expected in increasing order");
+      }
+      chunk.mutable_row_key()->swap(chunk_row_key_);
+      if (not row_in_progress_) {
+        AddRowBytes(chunk_row_key_.size());
+      }
+    }
+
+    if (chunk.has_family_name()) {
+      if (not chunk.has_qualifier()) {
+        RaiseParserError("New column family must specify qualifier");
+      }
+      AddRowBytes(chunk.family_name().value().size());
+      handler.OnFamily(*chunk.mutable_family_name()->mutable_value());
+    }
+
+    if (chunk.has_qualifier()) {
+      AddRowBytes(chunk.qualifier().value().size());
+      handler.OnQualifier(*chunk.mutable_qualifier()->mutable_value());
+    }
+
+    for (auto const& label : chunk.labels()) {
+      AddRowBytes(label.size());
+    }
+    std::move(chunk.mutable_labels()->begin(), chunk.mutable_labels()->end(),
+              std::back_inserter(labels_));
+
+    if (cell_first_chunk_) {
+      timestamp_ = chunk.timestamp_micros();
+      value_size_ = static_cast<std::size_t>(chunk.value_size());
+      value_bytes_ = 0;
+      if (value_size_ > 0) {
+        // The value is split across several chunks, and this chunk announces
+        // its total size.  Start the row now, so the handler can receive the
+        // value in pieces.
+        StartRow(handler);
+        streaming_value_ =
+            handler.OnValueStart(timestamp_, value_size_, labels_);
+        if (not streaming_value_) {
+          // Fail before buffering any part of a value that is too large, and
+          // allocate the buffer only once.
+          CheckRowBytes(value_size_);
+          value_.clear();
+          value_.reserve(value_size_);
+        }
+      }
+    }
+    if (value_size_ > 0) {
+      // The announced size also bounds the data buffered for the value.
+      value_bytes_ += chunk.value().size();
+      if (value_bytes_ > value_size_) {
+        RaiseParserError("Cell value exceeds its announced size (" +
+                         std::to_string(value_size_) + " bytes)");
+      }
+    }
+    if (not streaming_value_) {
+      AddRowBytes(chunk.value().size());
+    }
+
+    if (streaming_value_) {
+      handler.OnValueChunk(*chunk.mutable_value());
+    } else if (cell_first_chunk_ and chunk.value_size() == 0) {
+      // Most common case, move the value
+      chunk.mutable_value()->swap(value_);
+    } else {
+      value_.append(chunk.value());
+    }
+
+    cell_first_chunk_ = false;
+
+    // Last chunk in the cell has zero for value size
+    if (chunk.value_size() == 0) {
+      StartRow(handler);
+      if (streaming_value_) {
+        streaming_value_ = false;
+        handler.OnValueEnd();
+      } else {
+        handler.OnCell(timestamp_, value_, labels_);
+      }
+      value_.clear();
+      labels_.clear();
+      cell_first_chunk_ = true;
+    }
+
+    if (chunk.reset_row()) {
+      if (row_in_progress_) {
+        handler.OnRowReset();
+      }
+      row_in_progress_ = false;
+      row_bytes_ = 0;
+      row_key_.clear();
+      chunk_row_key_.clear();
+      value_.clear();
+      labels_.clear();
+      if (not cell_first_chunk_) {
+        RaiseParserError("Reset row with an unfinished cell");
+      }
+    } else if (chunk.commit_row()) {
+      if (not cell_first_chunk_) {
+        RaiseParserError("Commit row with an unfinished cell");
+      }
+      if (not row_in_progress_) {
+        RaiseParserError("Commit row missing the row key");
+      }
+      row_in_progress_ = false;
+      row_bytes_ = 0;
+      last_seen_row_key_.swap(row_key_);
+      row_key_.clear();
+      chunk_row_key_.clear();
+      handler.OnRowCommit();
+    }
+  }
+
+  /**
+   * Signal that the input stream reached the end.
+   *
+   * @throws ParserError if more data was expected to finish
+   * the current row.
+   */
+  void HandleEndOfStream() {
+    if (end_of_stream_) {
+      RaiseParserError("HandleEndOfStream called twice");
+    }
+    end_of_stream_ = true;
+
+    if (not cell_first_chunk_) {
+      RaiseParserError("end of stream with unfinished cell");
+    }
+
+    if (row_in_progress_) {
+      RaiseParserError("end of stream with unfinished row");
+    }
+  }
+
+  /// True if HandleEndOfStream() was called.
+  bool end_of_stream() const { return end_of_stream_; }
+
+  /// True if some cells have been reported for a row not yet committed.
+  bool row_in_progress() const { return row_in_progress_; }
+
+  /// The key of the last committed row, empty if none.
+  std::string const& last_seen_row_key() const { return last_seen_row_key_; }
+
+ private:
+  /**
+   * Start the row of the current cell, or verify that the cell belongs to
+   * the row in progress.
+   */
+  void StartRow(Handler& handler) {
+    if (not row_in_progress_) {
+      if (chunk_row_key_.empty()) {
+        RaiseParserError("Missing row key in cell chunk");
+      }
+      row_key_.swap(chunk_row_key_);
+      chunk_row_key_.clear();
+      row_in_progress_ = true;
+      handler.OnRowStart(row_key_);
+    } else if (validate_row_keys_ and not chunk_row_key_.empty() and
+               chunk_row_key_ != row_key_) {
+      RaiseParserError("Different row key in cell chunk");
+    }
+  }
+
+  /// Raise an error if @p n more bytes would exceed the row size limit.
+  void CheckRowBytes(std::size_t n) const {
+    if (n > max_row_bytes_ - row_bytes_) {
+      RaiseParserError("Row exceeds the maximum row size (" +
+                       std::to_string(max_row_bytes_) + " bytes)");
+    }
+  }
+
+  /// Account for @p n more bytes in the current row, enforcing the limit.
+  void AddRowBytes(std::size_t n) {
+    CheckRowBytes(n);
+    row_bytes_ += n;
+  }
+
+  /// Is the next incoming chunk the first in a cell?
+  bool cell_first_chunk_;
+
+  /// True if OnRowStart() was called, but not OnRowCommit() or OnRowReset().
+  bool row_in_progress_;
+
+  /// The key of the row in progress.
+  std::string row_key_;
+
+  /// The row key received in the chunks since the row started, if any.
+  std::string chunk_row_key_;
+
+  /// The partial value, labels and timestamp of the current cell.
+  std::int64_t timestamp_;
+  std::string value_;
+  std::vector<std::string> labels_;
+
+  /// The size announced for a value split across chunks, 0 otherwise.
+  std::size_t value_size_;
+  /// The bytes received so far for the split value.
+  std::size_t value_bytes_;
+
+  /// True if the handler receives the value of the current cell in pieces.
+  bool streaming_value_;
+
+  /// The size of the row in progress, and its limit.
+  std::size_t row_bytes_;
+  std::size_t max_row_bytes_;
+
+  /// If false, skip the row key comparisons.
+  bool validate_row_keys_;
+
+  /// The key of the last committed row, to validate the row key order.
+  std::string last_seen_row_key_;
+
+  /// Have we received the end of stream call?
+  bool end_of_stream_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_CHUNK_PARSER_H_
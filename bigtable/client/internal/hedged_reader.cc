@@ -0,0 +1,422 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/hedged_reader.h"
+#include <grpc++/alarm.h>
+#include <algorithm>
+#include "bigtable/client/internal/arena_message.h"
+#include "bigtable/client/internal/readrowsparser.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace btproto = ::google::bigtable::v2;
+
+namespace {
+/// The number of recent latencies used to compute the percentile.
+constexpr std::size_t kMaxLatencySamples = 1024;
+/// Use the fixed delay until this many latencies are recorded.
+constexpr std::size_t kMinLatencySamples = 100;
+/// Recompute the percentile after this many new latencies.
+constexpr std::size_t kLatencyUpdateInterval = 64;
+/// The maximum number of hedges in a burst.
+constexpr double kMaxHedgeTokens = 10.0;
+/// The number of stubs requested from the pool looking for a new connection.
+constexpr int kMaxHedgeStubLookups = 4;
+
+/// Run @p f, converting the parser exceptions to a status.
+template <typename Functor>
+grpc::Status CallParser(Functor&& f) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  try {
+    f();
+  } catch (std::exception const& ex) {
+    return grpc::Status(grpc::INTERNAL, ex.what());
+  }
+#else
+  f();
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  return grpc::Status::OK;
+}
+
+}  // anonymous namespace
+
+HedgingController::HedgingController(HedgingOptions options)
+    : options_(std::move(options)),
+      next_sample_(0),
+      samples_since_update_(0),
+      percentile_delay_(options_.delay()),
+      tokens_(0) {}
+
+std::chrono::microseconds HedgingController::Delay() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return percentile_delay_;
+}
+
+void HedgingController::RecordLatency(std::chrono::microseconds latency) {
+  if (options_.delay_percentile() == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  if (samples_.size() < kMaxLatencySamples) {
+    samples_.push_back(latency);
+  } else {
+    samples_[next_sample_] = latency;
+    next_sample_ = (next_sample_ + 1) % kMaxLatencySamples;
+  }
+  if (++samples_since_update_ < kLatencyUpdateInterval or
+      samples_.size() < kMinLatencySamples) {
+    return;
+  }
+  samples_since_update_ = 0;
+  auto sorted = samples_;
+  auto index = static_cast<std::size_t>(
+      static_cast<double>(sorted.size()) * options_.delay_percentile() / 100);
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  percentile_delay_ = sorted[index];
+}
+
+void HedgingController::OnRead() {
+  std::lock_guard<std::mutex> lk(mu_);
+  tokens_ = std::min(kMaxHedgeTokens, tokens_ + options_.budget());
+}
+
+bool HedgingController::TryStartHedge() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (tokens_ < 1.0) {
+    return false;
+  }
+  tokens_ -= 1.0;
+  return true;
+}
+
+struct HedgedReader::Call {
+  Call(btproto::ReadRowsRequest const& r,
+       std::function<void(grpc::ClientContext&)> const& s)
+      : request(r),
+        setup(s),
+        attempts{nullptr, nullptr},
+        timer(nullptr),
+        done(false),
+        failed(false) {}
+
+  // These are only used while `done` is false, when the caller is still
+  // waiting in `Read()`.
+  btproto::ReadRowsRequest const& request;
+  std::function<void(grpc::ClientContext&)> const& setup;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  StubPtr primary_stub;
+  /// The attempts in progress, each attempt is removed when it finishes.
+  Attempt* attempts[2];
+  /// The hedging timer, until it expires.
+  HedgeTimer* timer;
+  bool done;
+  /// Set when an attempt failed, `status` holds its error.
+  bool failed;
+  grpc::Status status;
+  std::vector<Row> rows;
+};
+
+/**
+ * Read all the rows of a call in a single stream.
+ *
+ * Like `AsyncRowReader`, but without retries.  Once the call is done, i.e.,
+ * the other attempt won, the stream is finished without reading any more
+ * data.
+ */
+class HedgedReader::Attempt : public AsyncOperation {
+ public:
+  Attempt(HedgedReader& reader, std::shared_ptr<Call> call, int index,
+          StubPtr stub)
+      : reader_(reader),
+        call_(std::move(call)),
+        index_(index),
+        stub_(std::move(stub)),
+        start_(std::chrono::steady_clock::now()),
+        state_(State::kStart) {}
+
+  /// Send the request, requires `call_->mu`.
+  void Start() {
+    call_->setup(context_);
+    stream_ = stub_->PrepareAsyncReadRows(&context_, call_->request,
+                                          &reader_.cq_.cq());
+    stream_->StartCall(this);
+  }
+
+  /// Cancel the request, the pending operation completes promptly.
+  void Cancel() { context_.TryCancel(); }
+
+  bool Notify(CompletionQueue&, bool ok) override {
+    switch (state_) {
+      case State::kStart:
+        if (not ok or CallDone()) {
+          FinishStream();
+          return false;
+        }
+        ReadNext();
+        return false;
+      case State::kReading:
+        if (not ok or CallDone()) {
+          FinishStream();
+          return false;
+        }
+        if (not ProcessResponse()) {
+          context_.TryCancel();
+          FinishStream();
+          return false;
+        }
+        ReadNext();
+        return false;
+      case State::kFinishing:
+        OnFinish();
+        return true;
+    }
+    return false;
+  }
+
+ private:
+  bool CallDone() {
+    std::lock_guard<std::mutex> lk(call_->mu);
+    return call_->done;
+  }
+
+  void ReadNext() {
+    response_.Reset();
+    state_ = State::kReading;
+    stream_->Read(&response_.get(), this);
+  }
+
+  void FinishStream() {
+    state_ = State::kFinishing;
+    stream_->Finish(&status_, this);
+  }
+
+  /// Parse a response, return false if the parser failed.
+  bool ProcessResponse() {
+    for (auto& chunk : *response_->mutable_chunks()) {
+      parser_status_ = CallParser([this, &chunk] {
+        parser_.ConsumeChunk(chunk);
+        if (parser_.HasNext()) {
+          rows_.emplace_back(parser_.Next());
+        }
+      });
+      if (not parser_status_.ok()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void OnFinish() {
+    auto status = parser_status_;
+    if (status.ok()) {
+      status = status_;
+    }
+    if (status.ok()) {
+      status = CallParser([this] { parser_.HandleEndOfStream(); });
+    }
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_);
+    {
+      std::lock_guard<std::mutex> lk(call_->mu);
+      reader_.OnAttemptDone(*call_, index_, std::move(status),
+                            std::move(rows_), latency);
+    }
+    reader_.RemovePending();
+  }
+
+  enum class State { kStart, kReading, kFinishing };
+
+  HedgedReader& reader_;
+  std::shared_ptr<Call> call_;
+  int index_;
+  StubPtr stub_;
+  std::chrono::steady_clock::time_point start_;
+  State state_;
+  grpc::ClientContext context_;
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>
+      stream_;
+  /// Reused (via its arena) for all the responses in this attempt.
+  ArenaMessage<btproto::ReadRowsResponse> response_;
+  ReadRowsParser parser_;
+  std::vector<Row> rows_;
+  grpc::Status status_;
+  /// Set when the parser failed, reported as `grpc::INTERNAL`.
+  grpc::Status parser_status_;
+};
+
+/// Start the second attempt of a call when its hedging delay expires.
+class HedgedReader::HedgeTimer : public AsyncOperation {
+ public:
+  HedgeTimer(HedgedReader& reader, std::shared_ptr<Call> call)
+      : reader_(reader), call_(std::move(call)) {}
+
+  void Set(std::chrono::system_clock::time_point deadline) {
+    alarm_.Set(&reader_.cq_.cq(), deadline, this);
+  }
+
+  /// Cancel the timer, requires `call_->mu`.
+  void Cancel() { alarm_.Cancel(); }
+
+  bool Notify(CompletionQueue&, bool ok) override {
+    {
+      std::lock_guard<std::mutex> lk(call_->mu);
+      call_->timer = nullptr;
+    }
+    // A cancelled timer means the call is done.
+    if (ok) {
+      reader_.MaybeHedge(call_);
+    }
+    reader_.RemovePending();
+    return true;
+  }
+
+ private:
+  HedgedReader& reader_;
+  std::shared_ptr<Call> call_;
+  grpc::Alarm alarm_;
+};
+
+HedgedReader::HedgedReader(std::shared_ptr<DataClient> client,
+                           HedgingOptions options)
+    : client_(std::move(client)),
+      controller_(std::move(options)),
+      hedge_count_(0),
+      pending_(0),
+      runner_([this] { cq_.Run(); }) {}
+
+HedgedReader::~HedgedReader() {
+  // The attempts that lost are cancelled, they finish promptly.  They must
+  // finish before the shutdown, they still start operations on the queue.
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    no_pending_.wait(lk, [this] { return pending_ == 0; });
+  }
+  cq_.Shutdown();
+  runner_.join();
+}
+
+grpc::Status HedgedReader::Read(
+    btproto::ReadRowsRequest const& request,
+    std::function<void(grpc::ClientContext&)> const& setup,
+    std::vector<Row>& rows) {
+  auto call = std::make_shared<Call>(request, setup);
+  controller_.OnRead();
+
+  std::unique_lock<std::mutex> lk(call->mu);
+  call->primary_stub = client_->Stub();
+  StartAttempt(call, 0, call->primary_stub);
+  // The completion queue owns the timer, and deletes it when it expires.
+  AddPending();
+  call->timer = new HedgeTimer(*this, call);
+  call->timer->Set(std::chrono::system_clock::now() + controller_.Delay());
+  call->cv.wait(lk, [&call] { return call->done; });
+  rows = std::move(call->rows);
+  return call->status;
+}
+
+std::int64_t HedgedReader::hedge_count() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return hedge_count_;
+}
+
+void HedgedReader::StartAttempt(std::shared_ptr<Call> const& call, int index,
+                                StubPtr stub) {
+  // The completion queue owns the attempt, and deletes it when it finishes.
+  AddPending();
+  auto attempt = new Attempt(*this, call, index, std::move(stub));
+  call->attempts[index] = attempt;
+  attempt->Start();
+}
+
+void HedgedReader::AddPending() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++pending_;
+}
+
+void HedgedReader::RemovePending() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (--pending_ == 0) {
+    no_pending_.notify_all();
+  }
+}
+
+void HedgedReader::MaybeHedge(std::shared_ptr<Call> const& call) {
+  std::lock_guard<std::mutex> lk(call->mu);
+  if (call->done) {
+    return;
+  }
+  auto stub = HedgeStub(call->primary_stub);
+  if (not stub or not controller_.TryStartHedge()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> counter_lock(mu_);
+    ++hedge_count_;
+  }
+  StartAttempt(call, 1, std::move(stub));
+}
+
+HedgedReader::StubPtr HedgedReader::HedgeStub(StubPtr const& primary) {
+  // Each call returns the next connection in the pool, skip the connection
+  // used by the first attempt, it may be the reason the read is slow.
+  for (int i = 0; i != kMaxHedgeStubLookups; ++i) {
+    auto stub = client_->Stub();
+    if (stub != primary) {
+      return stub;
+    }
+  }
+  return nullptr;
+}
+
+void HedgedReader::OnAttemptDone(Call& call, int index, grpc::Status status,
+                                 std::vector<Row> rows,
+                                 std::chrono::microseconds latency) {
+  call.attempts[index] = nullptr;
+  if (call.done) {
+    // The other attempt won, discard these results.
+    return;
+  }
+  Attempt* other = call.attempts[1 - index];
+  if (not status.ok()) {
+    if (not call.failed) {
+      call.failed = true;
+      call.status = std::move(status);
+    }
+    // The other attempt may still succeed, wait for it if it is running.
+    // Otherwise report the first error.
+    if (other != nullptr) {
+      return;
+    }
+  } else {
+    call.status = std::move(status);
+    call.rows = std::move(rows);
+    if (other != nullptr) {
+      other->Cancel();
+    }
+    controller_.RecordLatency(latency);
+  }
+  call.done = true;
+  if (call.timer != nullptr) {
+    call.timer->Cancel();
+  }
+  call.cv.notify_all();
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
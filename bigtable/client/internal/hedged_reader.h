@@ -0,0 +1,157 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_HEDGED_READER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_HEDGED_READER_H_
+
+#include "bigtable/client/completion_queue.h"
+#include "bigtable/client/data_client.h"
+#include "bigtable/client/hedging_options.h"
+#include "bigtable/client/row.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Decide when to hedge a read, and whether the budget allows it.
+ *
+ * The delay is either fixed, or a percentile of the latency of the recent
+ * successful attempts.  The budget is a token bucket: each read adds
+ * `options.budget()` tokens, each hedge consumes one.
+ *
+ * This class is thread-safe.
+ */
+class HedgingController {
+ public:
+  explicit HedgingController(HedgingOptions options);
+
+  /// Return how long to wait before hedging a new read.
+  std::chrono::microseconds Delay() const;
+
+  /// Record the latency of a successful attempt.
+  void RecordLatency(std::chrono::microseconds latency);
+
+  /// Add the budget for a new read.
+  void OnRead();
+
+  /// Consume the budget for a hedge, return false if not enough is left.
+  bool TryStartHedge();
+
+ private:
+  HedgingOptions options_;
+  mutable std::mutex mu_;
+  /// A ring buffer with the most recent latencies.
+  std::vector<std::chrono::microseconds> samples_;
+  std::size_t next_sample_;
+  std::size_t samples_since_update_;
+  std::chrono::microseconds percentile_delay_;
+  double tokens_;
+};
+
+/**
+ * Run small, idempotent reads with hedging.
+ *
+ * The attempts use the asynchronous gRPC API, a single background thread
+ * runs all of them, and the timers that decide when to hedge each read.  If
+ * a read has not completed in time a second attempt is started on a
+ * different connection from the `DataClient` pool.  The first attempt to
+ * succeed wins, the other is cancelled, and its stream is finished without
+ * reading any more data.  A read fails only if both attempts failed, or if
+ * the first attempt failed before the second one started.  If the client
+ * only returns one connection the reads are not hedged.
+ *
+ * Each attempt reads the full request, there is no resumption, so this is
+ * only suitable for reads with a small, bounded, result.
+ */
+class HedgedReader {
+ public:
+  HedgedReader(std::shared_ptr<DataClient> client, HedgingOptions options);
+  ~HedgedReader();
+
+  HedgedReader(HedgedReader const&) = delete;
+  HedgedReader& operator=(HedgedReader const&) = delete;
+
+  /**
+   * Read all the rows for @p request.
+   *
+   * @param setup configures the `grpc::ClientContext` for each attempt, e.g.
+   *     to set the deadline from the retry policy.
+   * @param rows receives the rows returned by the winning attempt.
+   * @return the status of the winning attempt, or the first error if no
+   *     attempt succeeded.  Parser errors are reported as `grpc::INTERNAL`.
+   */
+  grpc::Status Read(
+      google::bigtable::v2::ReadRowsRequest const& request,
+      std::function<void(grpc::ClientContext&)> const& setup,
+      std::vector<Row>& rows);
+
+  /// The number of second attempts started so far.
+  std::int64_t hedge_count() const;
+
+ private:
+  struct Call;
+  class Attempt;
+  class HedgeTimer;
+
+  using StubPtr =
+      std::shared_ptr<google::bigtable::v2::Bigtable::StubInterface>;
+
+  /// Start an attempt of @p call on @p stub, requires `call->mu`.
+  void StartAttempt(std::shared_ptr<Call> const& call, int index,
+                    StubPtr stub);
+
+  /// Start the second attempt, if still needed and allowed by the budget.
+  void MaybeHedge(std::shared_ptr<Call> const& call);
+
+  /// Return a stub different from @p primary, or nullptr if there is none.
+  StubPtr HedgeStub(StubPtr const& primary);
+
+  /// Record the result of an attempt, requires `call.mu`.
+  void OnAttemptDone(Call& call, int index, grpc::Status status,
+                     std::vector<Row> rows,
+                     std::chrono::microseconds latency);
+
+  std::shared_ptr<DataClient> client_;
+  HedgingController controller_;
+
+  /// Register an attempt or a timer that must finish before shutdown.
+  void AddPending();
+  /// An attempt or timer has finished, it no longer uses the queue.
+  void RemovePending();
+
+  mutable std::mutex mu_;
+  std::int64_t hedge_count_;
+  /// The attempts and timers in progress, including the cancelled ones.
+  int pending_;
+  std::condition_variable no_pending_;
+
+  /// Runs the attempts and the hedging timers for all the reads.
+  CompletionQueue cq_;
+  std::thread runner_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_HEDGED_READER_H_
@@ -0,0 +1,316 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/hedged_reader.h"
+#include "bigtable/client/testing/fake_async_read_rows_stream.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+namespace btproto = ::google::bigtable::v2;
+using bigtable::HedgingOptions;
+using bigtable::internal::HedgedReader;
+using bigtable::internal::HedgingController;
+using bigtable::testing::FakeAsyncReadRowsStream;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+using testing::Return;
+
+namespace {
+/// Use two connections, the hedge must use the one the first attempt did not.
+class HedgedReaderTest : public bigtable::testing::TableTestFixture {
+ protected:
+  HedgedReaderTest()
+      : hedge_stub_(std::make_shared<btproto::MockBigtableStub>()) {
+    // Some tests override this expectation, do not require any calls.
+    EXPECT_CALL(*client_, Stub())
+        .Times(AnyNumber())
+        .WillOnce(Return(bigtable_stub_))
+        .WillRepeatedly(Return(hedge_stub_));
+  }
+
+  std::shared_ptr<btproto::MockBigtableStub> hedge_stub_;
+};
+
+btproto::ReadRowsResponse MakeResponse(std::string const& row_key) {
+  return bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: ")" + row_key + R"("
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+}
+
+/// A stream returning a single row, after @p delay.
+FakeAsyncReadRowsStream* MakeStream(grpc::CompletionQueue* cq,
+                                    std::string const& row_key,
+                                    milliseconds delay) {
+  return new FakeAsyncReadRowsStream(cq, {MakeResponse(row_key)},
+                                     grpc::Status::OK, delay);
+}
+
+/// A stream failing with @p code, after @p delay.
+FakeAsyncReadRowsStream* MakeFailedStream(grpc::CompletionQueue* cq,
+                                          grpc::StatusCode code,
+                                          milliseconds delay) {
+  return new FakeAsyncReadRowsStream(cq, {btproto::ReadRowsResponse()},
+                                     grpc::Status(code, "attempt failed"),
+                                     delay);
+}
+
+void NoSetup(grpc::ClientContext&) {}
+}  // anonymous namespace
+
+TEST(HedgingControllerTest, FixedDelay) {
+  HedgingController controller(HedgingOptions().set_delay(milliseconds(7)));
+  for (int i = 0; i != 1000; ++i) {
+    controller.RecordLatency(milliseconds(100));
+  }
+  EXPECT_EQ(milliseconds(7), controller.Delay());
+}
+
+TEST(HedgingControllerTest, PercentileDelay) {
+  HedgingController controller(HedgingOptions()
+                                   .set_delay(milliseconds(7))
+                                   .set_delay_percentile(90));
+  for (int i = 1; i != 100; ++i) {
+    controller.RecordLatency(milliseconds(i));
+  }
+  // Not enough samples yet.
+  EXPECT_EQ(milliseconds(7), controller.Delay());
+  controller.RecordLatency(milliseconds(100));
+  EXPECT_EQ(milliseconds(91), controller.Delay());
+}
+
+TEST(HedgingControllerTest, Budget) {
+  HedgingController controller(HedgingOptions().set_budget(0.5));
+  controller.OnRead();
+  EXPECT_FALSE(controller.TryStartHedge());
+  controller.OnRead();
+  EXPECT_TRUE(controller.TryStartHedge());
+  EXPECT_FALSE(controller.TryStartHedge());
+}
+
+TEST_F(HedgedReaderTest, FastFirstAttempt) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "r1", milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(std::chrono::seconds(60))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("r1", rows[0].row_key());
+  EXPECT_EQ(0, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, HedgeWins) {
+  // The first attempt is slow, the second attempt answers immediately.
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "slow", milliseconds(200));
+      }));
+  EXPECT_CALL(*hedge_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "fast", milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("fast", rows[0].row_key());
+  EXPECT_EQ(1, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, HedgeUsesDifferentStub) {
+  // Each attempt must use its own connection, the mocks verify each stub is
+  // used exactly once.
+  EXPECT_CALL(*client_, Stub())
+      .WillOnce(Return(bigtable_stub_))
+      .WillOnce(Return(bigtable_stub_))
+      .WillOnce(Return(hedge_stub_));
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "slow", milliseconds(200));
+      }));
+  EXPECT_CALL(*hedge_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "fast", milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("fast", rows[0].row_key());
+  EXPECT_EQ(1, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, NoHedgeWithSingleStub) {
+  // The client has a single connection, hedging on it would not help.
+  EXPECT_CALL(*client_, Stub()).WillRepeatedly(Return(bigtable_stub_));
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "slow", milliseconds(20));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("slow", rows[0].row_key());
+  EXPECT_EQ(0, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, LoserIsNotDrained) {
+  // The slow attempt has more data, but once the hedge wins it is finished
+  // without reading any more responses.
+  std::atomic<int> slow_reads(0);
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([&slow_reads](grpc::ClientContext*,
+                                     btproto::ReadRowsRequest const&,
+                                     grpc::CompletionQueue* cq) {
+        return new FakeAsyncReadRowsStream(
+            cq, {MakeResponse("slow-1"), MakeResponse("slow-2")},
+            grpc::Status::OK, milliseconds(200), &slow_reads);
+      }));
+  EXPECT_CALL(*hedge_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "fast", milliseconds(0));
+      }));
+
+  {
+    HedgedReader reader(client_, HedgingOptions()
+                                     .set_delay(microseconds(1000))
+                                     .set_budget(1.0));
+    std::vector<bigtable::Row> rows;
+    auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+    EXPECT_TRUE(status.ok());
+    ASSERT_EQ(1U, rows.size());
+    EXPECT_EQ("fast", rows[0].row_key());
+  }
+  // The reader waits for the cancelled attempt before it is destroyed.
+  EXPECT_EQ(1, slow_reads.load());
+}
+
+TEST_F(HedgedReaderTest, NoHedgeWithoutBudget) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "slow", milliseconds(20));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("slow", rows[0].row_key());
+  EXPECT_EQ(0, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, FailedHedgeDoesNotWin) {
+  // The hedge fails immediately, the slower first attempt succeeds.
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeStream(cq, "slow", milliseconds(200));
+      }));
+  EXPECT_CALL(*hedge_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeFailedStream(cq, grpc::StatusCode::UNAVAILABLE,
+                                milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1U, rows.size());
+  EXPECT_EQ("slow", rows[0].row_key());
+  EXPECT_EQ(1, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, BothAttemptsFail) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeFailedStream(cq, grpc::StatusCode::UNAVAILABLE,
+                                milliseconds(200));
+      }));
+  EXPECT_CALL(*hedge_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeFailedStream(cq, grpc::StatusCode::ABORTED,
+                                milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(microseconds(1000))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  // The hedge failed first, its error is reported.
+  EXPECT_EQ(grpc::StatusCode::ABORTED, status.error_code());
+  EXPECT_TRUE(rows.empty());
+  EXPECT_EQ(1, reader.hedge_count());
+}
+
+TEST_F(HedgedReaderTest, FirstAttemptFailsBeforeHedge) {
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue* cq) {
+        return MakeFailedStream(cq, grpc::StatusCode::UNAVAILABLE,
+                                milliseconds(0));
+      }));
+
+  HedgedReader reader(client_, HedgingOptions()
+                                   .set_delay(std::chrono::seconds(60))
+                                   .set_budget(1.0));
+  std::vector<bigtable::Row> rows;
+  auto status = reader.Read(btproto::ReadRowsRequest(), NoSetup, rows);
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, status.error_code());
+  EXPECT_EQ(0, reader.hedge_count());
+}
@@ -0,0 +1,244 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/parallel_scan.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+std::vector<RowSet> SplitRowSet(RowSet const& row_set,
+                                std::vector<RowKeySample> const& samples,
+                                std::size_t shard_count) {
+  std::vector<RowSet> shards;
+  if (row_set.IsEmpty()) {
+    return shards;
+  }
+
+  // Pick the split points so each shard has about the same number of bytes.
+  std::vector<std::string> splits;
+  std::int64_t const total = samples.empty() ? 0 : samples.back().offset_bytes;
+  auto sample = samples.begin();
+  for (std::size_t i = 1; i < shard_count and sample != samples.end(); ++i) {
+    std::int64_t const target = static_cast<std::int64_t>(
+        static_cast<double>(total) * i / shard_count);
+    sample = std::find_if(
+        sample, samples.end(),
+        [target](RowKeySample const& s) { return s.offset_bytes >= target; });
+    if (sample == samples.end() or sample->row_key.empty()) {
+      break;
+    }
+    if (splits.empty() or splits.back() < sample->row_key) {
+      splits.push_back(sample->row_key);
+    }
+    ++sample;
+  }
+
+  std::string begin;
+  for (auto& split : splits) {
+    auto shard = row_set.Intersect(RowRange::RightOpen(begin, split));
+    if (not shard.IsEmpty()) {
+      shards.emplace_back(std::move(shard));
+    }
+    begin = std::move(split);
+  }
+  auto shard = row_set.Intersect(RowRange::RightOpen(std::move(begin), ""));
+  if (not shard.IsEmpty()) {
+    shards.emplace_back(std::move(shard));
+  }
+  return shards;
+}
+
+namespace {
+/**
+ * The state shared by the worker threads and the consumer in ParallelScan().
+ *
+ * In ordered mode each shard has its own queue, and the consumer drains them
+ * in order.  In unordered mode all the shards share a single queue.
+ */
+class ParallelScanner {
+ public:
+  ParallelScanner(std::vector<RowSet> shards,
+                  std::function<RowReader(RowSet)> const& make_reader,
+                  ParallelScanOptions const& options)
+      : shards_(std::move(shards)),
+        make_reader_(make_reader),
+        queue_size_(options.queue_size()),
+        ordered_(options.ordered()),
+        queues_(ordered_ ? shards_.size() : 1),
+        next_shard_(0),
+        stopped_(false) {
+    for (auto& q : queues_) {
+      q.pending = ordered_ ? 1 : shards_.size();
+    }
+    if (not ordered_) {
+      // All the workers share the queue, give each one the same space it would
+      // have in ordered mode.
+      queue_size_ *= std::min(options.max_streams(), shards_.size());
+    }
+    auto const count = std::min(options.max_streams(), shards_.size());
+    for (std::size_t i = 0; i != count; ++i) {
+      workers_.emplace_back([this] { Worker(); });
+    }
+  }
+
+  ~ParallelScanner() {
+    Stop();
+    for (auto& t : workers_) {
+      t.join();
+    }
+  }
+
+  void Run(std::function<bool(Row)> const& on_row) {
+    std::size_t current = 0;
+    std::unique_lock<std::mutex> lk(mu_);
+    while (current != queues_.size()) {
+      auto& q = queues_[current];
+      has_rows_.wait(lk, [this, &q] {
+        return stopped_ or not q.rows.empty() or q.pending == 0;
+      });
+      if (stopped_) {
+        break;
+      }
+      if (q.rows.empty()) {
+        ++current;
+        continue;
+      }
+      Row row = std::move(q.rows.front());
+      q.rows.pop_front();
+      lk.unlock();
+      has_space_.notify_all();
+      bool const keep_going = on_row(std::move(row));
+      lk.lock();
+      if (not keep_going) {
+        break;
+      }
+    }
+    lk.unlock();
+    Stop();
+    for (auto& t : workers_) {
+      t.join();
+    }
+    workers_.clear();
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  }
+
+ private:
+  struct Queue {
+    std::deque<Row> rows;
+    /// The number of shards that may still push rows into this queue.
+    std::size_t pending;
+  };
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      stopped_ = true;
+    }
+    has_space_.notify_all();
+    has_rows_.notify_all();
+  }
+
+  void Worker() {
+    while (true) {
+      std::size_t index;
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (stopped_ or next_shard_ == shards_.size()) {
+          return;
+        }
+        index = next_shard_++;
+      }
+      auto& q = queues_[ordered_ ? index : 0];
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      try {
+        ReadShard(index, q);
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lk(mu_);
+          if (not error_) {
+            error_ = std::current_exception();
+          }
+        }
+        Stop();
+      }
+#else
+      ReadShard(index, q);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        --q.pending;
+      }
+      has_rows_.notify_one();
+    }
+  }
+
+  void ReadShard(std::size_t index, Queue& q) {
+    // The RowReader destructor cancels the stream if we stop early.
+    RowReader reader = make_reader_(std::move(shards_[index]));
+    for (auto& row : reader) {
+      std::unique_lock<std::mutex> lk(mu_);
+      has_space_.wait(
+          lk, [this, &q] { return stopped_ or q.rows.size() < queue_size_; });
+      if (stopped_) {
+        return;
+      }
+      q.rows.emplace_back(std::move(row));
+      lk.unlock();
+      has_rows_.notify_one();
+    }
+  }
+
+  std::vector<RowSet> shards_;
+  std::function<RowReader(RowSet)> const& make_reader_;
+  std::size_t queue_size_;
+  bool const ordered_;
+
+  std::mutex mu_;
+  std::condition_variable has_rows_;
+  std::condition_variable has_space_;
+  std::vector<Queue> queues_;
+  std::size_t next_shard_;
+  bool stopped_;
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  std::exception_ptr error_;
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  std::vector<std::thread> workers_;
+};
+}  // anonymous namespace
+
+void ParallelScan(std::vector<RowSet> shards,
+                  std::function<RowReader(RowSet)> const& make_reader,
+                  ParallelScanOptions const& options,
+                  std::function<bool(Row)> const& on_row) {
+  if (shards.empty()) {
+    return;
+  }
+  ParallelScanner scanner(std::move(shards), make_reader, options);
+  scanner.Run(on_row);
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
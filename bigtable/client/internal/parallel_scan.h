@@ -0,0 +1,64 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PARALLEL_SCAN_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PARALLEL_SCAN_H_
+
+#include "bigtable/client/parallel_scan_options.h"
+#include "bigtable/client/row_key_sample.h"
+#include "bigtable/client/row_reader.h"
+#include "bigtable/client/row_set.h"
+
+#include <functional>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Split @p row_set into at most @p shard_count disjoint row sets.
+ *
+ * The split points are chosen among the keys in @p samples, trying to
+ * balance the number of bytes in each shard using `offset_bytes`.  The
+ * shards are returned in row key order, shards that do not intersect
+ * @p row_set are omitted.
+ */
+std::vector<RowSet> SplitRowSet(RowSet const& row_set,
+                                std::vector<RowKeySample> const& samples,
+                                std::size_t shard_count);
+
+/**
+ * Read all the shards using up to `options.max_streams()` concurrent streams.
+ *
+ * The shards are assigned to worker threads in order, each worker creates a
+ * `RowReader` using @p make_reader and pushes the rows into a bounded queue
+ * for the shard.  The calling thread drains the queues and invokes @p on_row,
+ * either in the order the rows arrive, or shard by shard if
+ * `options.ordered()` is set.
+ *
+ * @param on_row invoked for each row in the calling thread, return `false` to
+ *     stop the scan.
+ * @throws std::runtime_error (or any other exception raised by the readers)
+ *     if one of the shards fails, the remaining shards are cancelled.
+ */
+void ParallelScan(std::vector<RowSet> shards,
+                  std::function<RowReader(RowSet)> const& make_reader,
+                  ParallelScanOptions const& options,
+                  std::function<bool(Row)> const& on_row);
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PARALLEL_SCAN_H_
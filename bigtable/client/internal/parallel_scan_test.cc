@@ -0,0 +1,222 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/parallel_scan.h"
+#include "bigtable/client/table.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+#include <algorithm>
+#include <map>
+
+using testing::DoAll;
+using testing::Invoke;
+using testing::Return;
+using testing::SetArgPointee;
+using testing::_;
+
+using google::bigtable::v2::ReadRowsRequest;
+using google::bigtable::v2::ReadRowsResponse;
+using google::bigtable::v2::SampleRowKeysResponse;
+
+namespace {
+std::string RangeStart(bigtable::RowSet const& row_set) {
+  auto proto = row_set.as_proto();
+  if (proto.row_ranges_size() == 0) {
+    return "<none>";
+  }
+  return proto.row_ranges(0).start_key_closed();
+}
+
+std::string RangeEnd(bigtable::RowSet const& row_set) {
+  auto proto = row_set.as_proto();
+  if (proto.row_ranges_size() == 0) {
+    return "<none>";
+  }
+  return proto.row_ranges(0).end_key_open();
+}
+
+std::vector<bigtable::RowKeySample> Samples() {
+  return {{"b", 100}, {"d", 200}, {"f", 300}, {"", 400}};
+}
+}  // anonymous namespace
+
+/// @test Verify that SplitRowSet() chooses balanced split points.
+TEST(SplitRowSetTest, AllRows) {
+  auto shards =
+      bigtable::internal::SplitRowSet(bigtable::RowSet(), Samples(), 2);
+  ASSERT_EQ(2U, shards.size());
+  EXPECT_EQ("", RangeStart(shards[0]));
+  EXPECT_EQ("d", RangeEnd(shards[0]));
+  EXPECT_EQ("d", RangeStart(shards[1]));
+  EXPECT_EQ("", RangeEnd(shards[1]));
+}
+
+/// @test Verify that SplitRowSet() uses all the samples if needed.
+TEST(SplitRowSetTest, MoreShardsThanSamples) {
+  auto shards =
+      bigtable::internal::SplitRowSet(bigtable::RowSet(), Samples(), 10);
+  ASSERT_EQ(4U, shards.size());
+  EXPECT_EQ("", RangeStart(shards[0]));
+  EXPECT_EQ("b", RangeStart(shards[1]));
+  EXPECT_EQ("d", RangeStart(shards[2]));
+  EXPECT_EQ("f", RangeStart(shards[3]));
+  EXPECT_EQ("", RangeEnd(shards[3]));
+}
+
+/// @test Verify that SplitRowSet() omits shards outside the row set.
+TEST(SplitRowSetTest, OmitsEmptyShards) {
+  bigtable::RowSet row_set(bigtable::RowRange::Range("c", "e"), "a");
+  auto shards = bigtable::internal::SplitRowSet(row_set, Samples(), 4);
+  ASSERT_EQ(3U, shards.size());
+  auto proto = shards[0].as_proto();
+  ASSERT_EQ(1, proto.row_keys_size());
+  EXPECT_EQ("a", proto.row_keys(0));
+  EXPECT_EQ("c", RangeStart(shards[1]));
+  EXPECT_EQ("d", RangeEnd(shards[1]));
+  EXPECT_EQ("d", RangeStart(shards[2]));
+  EXPECT_EQ("e", RangeEnd(shards[2]));
+}
+
+/// @test Verify that SplitRowSet() handles degenerate inputs.
+TEST(SplitRowSetTest, Degenerate) {
+  EXPECT_EQ(1U,
+            bigtable::internal::SplitRowSet(bigtable::RowSet(), {}, 4).size());
+  EXPECT_EQ(
+      1U,
+      bigtable::internal::SplitRowSet(bigtable::RowSet(), Samples(), 1).size());
+  EXPECT_TRUE(bigtable::internal::SplitRowSet(
+                  bigtable::RowSet(bigtable::RowRange::Empty()), Samples(), 4)
+                  .empty());
+}
+
+namespace {
+class ParallelScanTest : public bigtable::testing::TableTestFixture {
+ protected:
+  ParallelScanTest() {
+    auto samples = Samples();
+    EXPECT_CALL(*bigtable_stub_, SampleRowKeysRaw(_, _))
+        .WillRepeatedly(testing::WithoutArgs(Invoke([samples] {
+          auto stream = new bigtable::testing::MockSampleRowKeysReader;
+          auto& read = EXPECT_CALL(*stream, Read(_));
+          for (auto const& s : samples) {
+            SampleRowKeysResponse r;
+            r.set_row_key(s.row_key);
+            r.set_offset_bytes(s.offset_bytes);
+            read.WillOnce(DoAll(SetArgPointee<0>(r), Return(true)));
+          }
+          read.WillOnce(Return(false));
+          EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+          return stream;
+        })));
+  }
+
+  /// Configure the stub to return the rows in each shard.
+  void SetShards(std::map<std::string, std::vector<std::string>> shards,
+                 grpc::Status status = grpc::Status::OK) {
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+        .WillRepeatedly(Invoke([shards, status](grpc::ClientContext*,
+                                                ReadRowsRequest const& r) {
+          std::string start;
+          if (r.rows().row_ranges_size() != 0) {
+            start = r.rows().row_ranges(0).start_key_closed();
+          }
+          auto stream = new bigtable::testing::MockResponseStream;
+          // Streams cancelled by an early stop are not drained.
+          auto& read =
+              EXPECT_CALL(*stream, Read(_)).Times(testing::AnyNumber());
+          auto f = shards.find(start);
+          if (f != shards.end()) {
+            for (auto const& key : f->second) {
+              read.WillOnce(DoAll(SetArgPointee<0>(MakeResponse(key)),
+                                  Return(true)));
+            }
+          }
+          read.WillRepeatedly(Return(false));
+          EXPECT_CALL(*stream, Finish()).WillOnce(Return(status));
+          return stream;
+        }));
+  }
+
+  static ReadRowsResponse MakeResponse(std::string const& key) {
+    ReadRowsResponse response;
+    auto& chunk = *response.add_chunks();
+    chunk.set_row_key(key);
+    chunk.mutable_family_name()->set_value("fam");
+    chunk.mutable_qualifier()->set_value("qual");
+    chunk.set_value("value");
+    chunk.set_commit_row(true);
+    return response;
+  }
+
+  std::vector<std::string> Scan(bigtable::ParallelScanOptions const& options) {
+    std::vector<std::string> keys;
+    table_.ParallelReadRows(bigtable::RowSet(),
+                            bigtable::Filter::PassAllFilter(),
+                            [&keys](bigtable::Row row) {
+                              keys.push_back(row.row_key());
+                              return true;
+                            },
+                            options);
+    return keys;
+  }
+
+  std::map<std::string, std::vector<std::string>> const kShards = {
+      {"", {"a0", "a1", "a2"}},
+      {"b", {"b0", "c1"}},
+      {"d", {"d0", "d1", "e2", "e3"}},
+      {"f", {"f0"}}};
+  std::vector<std::string> const kAllKeys = {"a0", "a1", "a2", "b0", "c1",
+                                             "d0", "d1", "e2", "e3", "f0"};
+};
+}  // anonymous namespace
+
+/// @test Verify that ParallelReadRows() returns the rows in order.
+TEST_F(ParallelScanTest, Ordered) {
+  SetShards(kShards);
+  auto keys = Scan(bigtable::ParallelScanOptions()
+                       .set_max_streams(3)
+                       .set_ordered(true)
+                       .set_queue_size(1));
+  EXPECT_EQ(kAllKeys, keys);
+}
+
+/// @test Verify that ParallelReadRows() returns all the rows.
+TEST_F(ParallelScanTest, Unordered) {
+  SetShards(kShards);
+  auto keys = Scan(
+      bigtable::ParallelScanOptions().set_max_streams(2).set_queue_size(1));
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ(kAllKeys, keys);
+}
+
+/// @test Verify that ParallelReadRows() stops when the callback says so.
+TEST_F(ParallelScanTest, StopEarly) {
+  SetShards(kShards);
+  int count = 0;
+  table_.ParallelReadRows(
+      bigtable::RowSet(), bigtable::Filter::PassAllFilter(),
+      [&count](bigtable::Row) { return ++count < 3; },
+      bigtable::ParallelScanOptions().set_max_streams(2).set_queue_size(1));
+  EXPECT_EQ(3, count);
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that ParallelReadRows() reports errors in the shards.
+TEST_F(ParallelScanTest, Failure) {
+  SetShards(kShards,
+            grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh"));
+  EXPECT_THROW(Scan(bigtable::ParallelScanOptions().set_max_streams(2)),
+               std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,297 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/pipelined_bulk_mutator.h"
+#include "bigtable/client/internal/arena_message.h"
+
+#include <algorithm>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+
+namespace btproto = google::bigtable::v2;
+
+namespace {
+/// Order the retry heap so the earliest deadline is at the front.
+template <typename RetryEntry>
+bool IsLater(RetryEntry const& lhs, RetryEntry const& rhs) {
+  if (lhs.deadline != rhs.deadline) {
+    return lhs.deadline > rhs.deadline;
+  }
+  return lhs.state.original_index > rhs.state.original_index;
+}
+}  // anonymous namespace
+
+PipelinedBulkMutator::PipelinedBulkMutator(
+    std::string const& table_name, IdempotentMutationPolicy& idempotent_policy,
+    BulkMutation&& mut, std::unique_ptr<RPCRetryPolicy> retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+    std::size_t max_concurrency, std::size_t max_mutations,
+    std::size_t max_bytes)
+    : table_name_(table_name),
+      max_concurrency_(max_concurrency),
+      max_mutations_(max_mutations),
+      max_bytes_(max_bytes),
+      retry_policy_(std::move(retry_policy)),
+      backoff_policy_(std::move(backoff_policy)),
+      stubs_(nullptr),
+      next_initial_(0),
+      give_up_(false),
+      workers_(0),
+      in_flight_(0) {
+  auto shards = SplitBulkMutation(std::move(mut), max_mutations, max_bytes);
+  initial_.reserve(shards.size());
+  for (auto& shard : shards) {
+    // Move the mutations to the request, this is a zero copy optimization.
+    initial_.emplace_back();
+    auto& request = initial_.back();
+    shard.mutation.MoveTo(&request.proto);
+    request.proto.set_table_name(table_name_);
+    request.states.reserve(request.proto.entries_size());
+    int index = shard.first_index;
+    for (auto const& e : request.proto.entries()) {
+      // This is a giant && across all the mutations for each row.
+      auto r = std::all_of(e.mutations().begin(), e.mutations().end(),
+                           [&idempotent_policy](btproto::Mutation const& m) {
+                             return idempotent_policy.is_idempotent(m);
+                           });
+      request.states.push_back(EntryState{index++, r, 0});
+    }
+    request.has_result.assign(request.states.size(), false);
+  }
+}
+
+grpc::Status PipelinedBulkMutator::Run(StubFactory const& stubs) {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    stubs_ = &stubs;
+    workers_ = 1;
+  }
+  Worker(false);
+  // No threads are added once the calling thread is done: either there is no
+  // work left, or the retry policy gave up.
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    threads.swap(threads_);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  return status_;
+}
+
+std::vector<FailedMutation> PipelinedBulkMutator::ExtractFinalFailures() {
+  std::lock_guard<std::mutex> lk(mu_);
+  std::vector<FailedMutation> result(std::move(failures_));
+  // Any mutations still queued have an unknown result, report them with an OK
+  // status, as `BulkMutator` does.
+  google::rpc::Status ok_status;
+  ok_status.set_code(grpc::StatusCode::OK);
+  for (auto& r : retries_) {
+    result.emplace_back(SingleRowMutation(std::move(r.entry)), ok_status,
+                        r.state.original_index);
+  }
+  retries_.clear();
+  for (; next_initial_ != initial_.size(); ++next_initial_) {
+    auto& request = initial_[next_initial_];
+    for (int i = 0; i != request.proto.entries_size(); ++i) {
+      result.emplace_back(
+          SingleRowMutation(std::move(*request.proto.mutable_entries(i))),
+          ok_status, request.states[i].original_index);
+    }
+  }
+  return result;
+}
+
+void PipelinedBulkMutator::Worker(bool is_helper) {
+  // Receive the responses, reused (via its arena) for all the requests sent by
+  // this thread.
+  ArenaMessage<btproto::MutateRowsResponse> response;
+  std::unique_lock<std::mutex> lk(mu_);
+  while (not give_up_) {
+    if (not HasQueuedMutations()) {
+      // Helper threads exit as soon as there is nothing to send, the calling
+      // thread waits for the requests in flight, they may queue retries.
+      if (is_helper or in_flight_ == 0) {
+        break;
+      }
+      cv_.wait(lk);
+      continue;
+    }
+    auto const now = Clock::now();
+    if (next_initial_ == initial_.size() and
+        now < retries_.front().deadline) {
+      cv_.wait_until(lk, retries_.front().deadline);
+      continue;
+    }
+    auto request = TakeRequest(now);
+    ++in_flight_;
+    MaybeAddWorker();
+    grpc::ClientContext client_context;
+    backoff_policy_->setup(client_context);
+    retry_policy_->setup(client_context);
+    lk.unlock();
+
+    // Each call to the factory returns the next connection in the pool, so
+    // concurrent requests, and the retries, use different connections.
+    auto stream = (*stubs_)()->MutateRows(&client_context, request.proto);
+    response.Reset();
+    while (stream->Read(&response.get())) {
+      lk.lock();
+      ProcessResponse(request, response.get());
+      lk.unlock();
+      response.Reset();
+    }
+    auto status = stream->Finish();
+
+    lk.lock();
+    --in_flight_;
+    FinishRequest(request, status);
+    cv_.notify_all();
+  }
+  --workers_;
+}
+
+PipelinedBulkMutator::Request PipelinedBulkMutator::TakeRequest(
+    Clock::time_point now) {
+  if (retries_.empty() or now < retries_.front().deadline) {
+    // The shards are already within the service limits.
+    return std::move(initial_[next_initial_++]);
+  }
+  // The retries go first, they have been waiting longer.
+  Request request;
+  request.proto.set_table_name(table_name_);
+  std::size_t count = 0;
+  std::size_t bytes = 0;
+  auto fits = [&](RetryEntry const& r) {
+    return request.states.empty() or
+           (count + r.entry.mutations_size() <= max_mutations_ and
+            bytes + r.bytes <= max_bytes_);
+  };
+  while (not retries_.empty() and retries_.front().deadline <= now and
+         fits(retries_.front())) {
+    std::pop_heap(retries_.begin(), retries_.end(), IsLater<RetryEntry>);
+    auto& r = retries_.back();
+    count += static_cast<std::size_t>(r.entry.mutations_size());
+    bytes += r.bytes;
+    request.proto.add_entries()->Swap(&r.entry);
+    request.states.push_back(r.state);
+    retries_.pop_back();
+  }
+  request.has_result.assign(request.states.size(), false);
+  return request;
+}
+
+void PipelinedBulkMutator::MaybeAddWorker() {
+  if (give_up_ or not HasQueuedMutations() or in_flight_ < workers_ or
+      workers_ >= max_concurrency_) {
+    return;
+  }
+  ++workers_;
+  threads_.emplace_back([this] { Worker(true); });
+}
+
+void PipelinedBulkMutator::ProcessResponse(
+    Request& request, btproto::MutateRowsResponse& response) {
+  bool retried = false;
+  for (auto& entry : *response.mutable_entries()) {
+    auto index = entry.index();
+    if (index < 0 or request.states.size() <= std::size_t(index) or
+        request.has_result[index]) {
+      // TODO(#72) - decide how this is logged.
+      continue;
+    }
+    request.has_result[index] = true;
+    auto const code = static_cast<grpc::StatusCode>(entry.status().code());
+    // Successful responses are not even recorded, this class only reports
+    // the failures.
+    if (grpc::OK == code) {
+      continue;
+    }
+    auto& original = *request.proto.mutable_entries(index);
+    auto const& state = request.states[index];
+    if (IsRetryableStatusCode(code) and state.is_idempotent) {
+      // Do not wait for the end of the stream, the mutation can be retried as
+      // soon as its backoff deadline expires.
+      Retry(original, state, grpc::Status(code, entry.status().message()));
+      retried = true;
+    } else {
+      failures_.emplace_back(SingleRowMutation(std::move(original)),
+                             std::move(*entry.mutable_status()),
+                             state.original_index);
+    }
+  }
+  if (retried) {
+    // Wake up any idle threads, or start a new one, to send the retries.
+    cv_.notify_all();
+    MaybeAddWorker();
+  }
+}
+
+void PipelinedBulkMutator::FinishRequest(Request& request,
+                                         grpc::Status const& status) {
+  // Once the policy gives up, the requests still in flight cannot change the
+  // result, even if they succeed.
+  if (not give_up_) {
+    status_ = status;
+    if (not status.ok() and not retry_policy_->on_failure(status)) {
+      give_up_ = true;
+    }
+  }
+  for (std::size_t index = 0; index != request.states.size(); ++index) {
+    if (request.has_result[index]) {
+      continue;
+    }
+    // If there are any mutations with unknown state, they need to be handled.
+    auto& original = *request.proto.mutable_entries(index);
+    auto const& state = request.states[index];
+    if (state.is_idempotent) {
+      // The mutation can be retried, if the policy gave up it is reported by
+      // ExtractFinalFailures().
+      Retry(original, state, status);
+    } else {
+      // These are weird failures.  We do not know their error code, and we
+      // cannot retry them.  Report them as OK in the failure list.
+      google::rpc::Status ok_status;
+      ok_status.set_code(grpc::StatusCode::OK);
+      failures_.emplace_back(SingleRowMutation(std::move(original)), ok_status,
+                             state.original_index);
+    }
+  }
+}
+
+void PipelinedBulkMutator::Retry(btproto::MutateRowsRequest::Entry& entry,
+                                 EntryState state, grpc::Status const& status) {
+  auto delay = BackoffDelay(state.retries, status);
+  ++state.retries;
+  retries_.emplace_back(
+      RetryEntry{{}, state, Clock::now() + delay, entry.ByteSizeLong()});
+  retries_.back().entry.Swap(&entry);
+  std::push_heap(retries_.begin(), retries_.end(), IsLater<RetryEntry>);
+}
+
+std::chrono::milliseconds PipelinedBulkMutator::BackoffDelay(
+    int retries, grpc::Status const& status) {
+  while (backoff_delays_.size() <= std::size_t(retries)) {
+    backoff_delays_.push_back(backoff_policy_->on_completion(status));
+  }
+  return backoff_delays_[retries];
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,172 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PIPELINED_BULK_MUTATOR_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PIPELINED_BULK_MUTATOR_H_
+
+#include "bigtable/client/idempotent_mutation_policy.h"
+#include "bigtable/client/internal/bulk_mutator.h"
+#include "bigtable/client/mutations.h"
+#include "bigtable/client/rpc_backoff_policy.h"
+#include "bigtable/client/rpc_retry_policy.h"
+
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Keep the state in the Table::BulkApply() member function.
+ *
+ * Unlike `BulkMutator`, this class does not run the request in rounds.  The
+ * mutations are split with `SplitBulkMutation()` in requests within the
+ * service limits, and up to `max_concurrency` requests run in parallel, each
+ * one on the next connection returned by the stub factory.  A mutation that
+ * fails with a transient error is queued again as soon as its response
+ * arrives, with its own backoff deadline, and is sent by any idle thread (or a
+ * new one) once the deadline expires, even if the original request is still
+ * streaming results.
+ *
+ * The delay for the n-th retry of a mutation is the n-th delay returned by
+ * the backoff policy, so each mutation follows the schedule configured by the
+ * application regardless of how many other mutations have failed.
+ */
+class PipelinedBulkMutator {
+ public:
+  /// Return the stub used for the next request.
+  using StubFactory = std::function<
+      std::shared_ptr<google::bigtable::v2::Bigtable::StubInterface>()>;
+
+  PipelinedBulkMutator(std::string const& table_name,
+                       IdempotentMutationPolicy& idempotent_policy,
+                       BulkMutation&& mut,
+                       std::unique_ptr<RPCRetryPolicy> retry_policy,
+                       std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                       std::size_t max_concurrency = kBulkApplyMaxConcurrency,
+                       std::size_t max_mutations = kBulkApplyMaxMutations,
+                       std::size_t max_bytes = kBulkApplyMaxBytes);
+
+  /**
+   * Send all the mutations, blocking until they complete.
+   *
+   * @return the status that made the retry policy stop the operation, or the
+   *     status of the last request if the policy did not stop it.
+   */
+  grpc::Status Run(StubFactory const& stubs);
+
+  /// Return the mutations that failed or whose result is unknown.
+  std::vector<FailedMutation> ExtractFinalFailures();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /// The bookkeeping for each mutation.
+  struct EntryState {
+    /// The index of the mutation in the original `BulkMutation`.
+    int original_index;
+    bool is_idempotent;
+    /// The number of times the mutation has been retried.
+    int retries;
+  };
+
+  /// A mutation waiting for its backoff deadline.
+  struct RetryEntry {
+    google::bigtable::v2::MutateRowsRequest::Entry entry;
+    EntryState state;
+    Clock::time_point deadline;
+    std::size_t bytes;
+  };
+
+  /// A request in flight.
+  struct Request {
+    google::bigtable::v2::MutateRowsRequest proto;
+    std::vector<EntryState> states;
+    std::vector<bool> has_result;
+  };
+
+  /// The loop run by each thread, @p is_helper is false for Run()'s caller.
+  void Worker(bool is_helper);
+
+  /// Return true if there is work that is not in flight, requires `mu_`.
+  bool HasQueuedMutations() const {
+    return next_initial_ != initial_.size() or not retries_.empty();
+  }
+
+  /**
+   * Return the next request to send, requires `mu_`.
+   *
+   * The due retries are grouped in a new request, otherwise this returns the
+   * next shard of the original mutations.
+   */
+  Request TakeRequest(Clock::time_point now);
+
+  /// Start a new thread if all the threads are busy, requires `mu_`.
+  void MaybeAddWorker();
+
+  /// Process a response from @p request, requires `mu_`.
+  void ProcessResponse(Request& request,
+                       google::bigtable::v2::MutateRowsResponse& response);
+
+  /// Handle the end of @p request, requires `mu_`.
+  void FinishRequest(Request& request, grpc::Status const& status);
+
+  /// Queue a mutation for a retry, requires `mu_`.
+  void Retry(google::bigtable::v2::MutateRowsRequest::Entry& entry,
+             EntryState state, grpc::Status const& status);
+
+  /// Return the delay before the n-th retry, requires `mu_`.
+  std::chrono::milliseconds BackoffDelay(int retries,
+                                         grpc::Status const& status);
+
+  std::string const table_name_;
+  std::size_t const max_concurrency_;
+  std::size_t const max_mutations_;
+  std::size_t const max_bytes_;
+
+  std::mutex mu_;
+  /// Signaled when mutations are queued or requests complete.
+  std::condition_variable cv_;
+  std::unique_ptr<RPCRetryPolicy> retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  /// The delays returned by `backoff_policy_`, indexed by retry count.
+  std::vector<std::chrono::milliseconds> backoff_delays_;
+  /// The stub factory passed to Run().
+  StubFactory const* stubs_;
+
+  /// The shards of the original mutations, only the requests starting at
+  /// `next_initial_` have not been sent yet.
+  std::vector<Request> initial_;
+  std::size_t next_initial_;
+  /// The mutations waiting to be retried, a heap ordered by deadline.
+  std::vector<RetryEntry> retries_;
+
+  std::vector<FailedMutation> failures_;
+  grpc::Status status_;
+  bool give_up_;
+  std::size_t workers_;
+  std::size_t in_flight_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_PIPELINED_BULK_MUTATOR_H_
@@ -0,0 +1,319 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/pipelined_bulk_mutator.h"
+
+#include <google/bigtable/v2/bigtable_mock.grpc.pb.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <future>
+
+#include "bigtable/client/internal/make_unique.h"
+#include "bigtable/client/testing/chrono_literals.h"
+
+namespace btproto = ::google::bigtable::v2;
+namespace bt = ::bigtable;
+using namespace ::testing;
+using namespace bigtable::chrono_literals;
+
+/// Define types and functions used in the tests.
+namespace {
+class MockReader : public grpc::ClientReaderInterface<
+                       ::google::bigtable::v2::MutateRowsResponse> {
+ public:
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t*));
+  MOCK_METHOD1(Read, bool(::google::bigtable::v2::MutateRowsResponse*));
+};
+
+/// Create a response with the given status codes for each entry.
+btproto::MutateRowsResponse MakeResponse(
+    std::vector<grpc::StatusCode> const& codes) {
+  btproto::MutateRowsResponse response;
+  int index = 0;
+  for (auto code : codes) {
+    auto& e = *response.add_entries();
+    e.set_index(index++);
+    e.mutable_status()->set_code(code);
+  }
+  return response;
+}
+
+/// Create a stream that returns @p response and then finishes successfully.
+MockReader* MakeReader(btproto::MutateRowsResponse const& response) {
+  auto reader = new MockReader;
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+  return reader;
+}
+
+class PipelinedBulkMutatorTest : public ::testing::Test {
+ protected:
+  /// Create a mutator with short backoff periods.
+  std::unique_ptr<bt::internal::PipelinedBulkMutator> MakeMutator(
+      bt::BulkMutation mut, std::size_t max_concurrency = 4,
+      std::size_t max_mutations = 1000,
+      bt::RPCRetryPolicy const& retry = bt::LimitedErrorCountRetryPolicy(3)) {
+    return bigtable::internal::make_unique<
+        bt::internal::PipelinedBulkMutator>(
+        "foo/bar/baz/table", *policy_, std::move(mut), retry.clone(),
+        bt::ExponentialBackoffPolicy(10_us, 40_us).clone(), max_concurrency,
+        max_mutations, bt::internal::kBulkApplyMaxBytes);
+  }
+
+  grpc::Status Run(bt::internal::PipelinedBulkMutator& mutator) {
+    return mutator.Run([this] { return stub_; });
+  }
+
+  std::unique_ptr<bt::IdempotentMutationPolicy> policy_ =
+      bt::DefaultIdempotentMutationPolicy();
+  std::shared_ptr<btproto::MockBigtableStub> stub_ =
+      std::make_shared<btproto::MockBigtableStub>();
+};
+
+/// A retry policy that gives up on the first failure, and signals it.
+class SignalingRetryPolicy : public bt::RPCRetryPolicy {
+ public:
+  explicit SignalingRetryPolicy(std::shared_ptr<std::promise<void>> gave_up)
+      : gave_up_(std::move(gave_up)) {}
+
+  std::unique_ptr<bt::RPCRetryPolicy> clone() const override {
+    return bigtable::internal::make_unique<SignalingRetryPolicy>(gave_up_);
+  }
+  void setup(grpc::ClientContext&) const override {}
+  bool on_failure(grpc::Status const&) override {
+    gave_up_->set_value();
+    return false;
+  }
+  bool can_retry(grpc::StatusCode) const override { return false; }
+
+ private:
+  std::shared_ptr<std::promise<void>> gave_up_;
+};
+
+bt::BulkMutation MakeMutations(int count) {
+  bt::BulkMutation mut;
+  for (int i = 0; i != count; ++i) {
+    mut.emplace_back(bt::SingleRowMutation(
+        "row-" + std::to_string(i), {bt::SetCell("fam", "col", 0, "v")}));
+  }
+  return mut;
+}
+}  // anonymous namespace
+
+/// @test Verify that PipelinedBulkMutator handles easy cases.
+TEST_F(PipelinedBulkMutatorTest, Simple) {
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .WillOnce(Invoke(
+          [](grpc::ClientContext*, btproto::MutateRowsRequest const& request) {
+            EXPECT_EQ("foo/bar/baz/table", request.table_name());
+            EXPECT_EQ(2, request.entries_size());
+            return MakeReader(MakeResponse({grpc::OK, grpc::OK}));
+          }));
+
+  auto mutator = MakeMutator(MakeMutations(2));
+  auto status = Run(*mutator);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(mutator->ExtractFinalFailures().empty());
+}
+
+/// @test Verify that large sets are split and sent in parallel.
+TEST_F(PipelinedBulkMutatorTest, SplitRequests) {
+  std::mutex mu;
+  std::vector<std::string> keys;
+  std::vector<int> sizes;
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .Times(3)
+      .WillRepeatedly(Invoke([&](grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& request) {
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          sizes.push_back(request.entries_size());
+          for (auto const& e : request.entries()) {
+            keys.push_back(e.row_key());
+          }
+        }
+        return MakeReader(MakeResponse(std::vector<grpc::StatusCode>(
+            request.entries_size(), grpc::OK)));
+      }));
+
+  auto mutator = MakeMutator(MakeMutations(5), 4, 2);
+  auto status = Run(*mutator);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(mutator->ExtractFinalFailures().empty());
+  std::sort(sizes.begin(), sizes.end());
+  EXPECT_EQ((std::vector<int>{1, 2, 2}), sizes);
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ((std::vector<std::string>{"row-0", "row-1", "row-2", "row-3",
+                                      "row-4"}),
+            keys);
+}
+
+/// @test Verify that retries do not wait for the original stream to finish.
+TEST_F(PipelinedBulkMutatorTest, RetryWhileStreaming) {
+  std::promise<void> retry_done;
+  auto retry_done_future = retry_done.get_future();
+
+  // The first stream reports a transient failure for the first mutation, and
+  // then blocks until the retry completes.
+  auto r1 = new MockReader;
+  EXPECT_CALL(*r1, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({grpc::UNAVAILABLE})),
+                      Return(true)))
+      .WillOnce(Invoke([&retry_done_future](btproto::MutateRowsResponse* r) {
+        EXPECT_EQ(std::future_status::ready,
+                  retry_done_future.wait_for(std::chrono::seconds(10)));
+        auto& e = *r->add_entries();
+        e.set_index(1);
+        e.mutable_status()->set_code(grpc::OK);
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r1, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto r2 = new MockReader;
+  EXPECT_CALL(*r2, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeResponse({grpc::OK})), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r2, Finish()).WillOnce(Invoke([&retry_done] {
+    retry_done.set_value();
+    return grpc::Status::OK;
+  }));
+
+  btproto::MutateRowsRequest retry_request;
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .WillOnce(Return(r1))
+      .WillOnce(Invoke([r2, &retry_request](
+                           grpc::ClientContext*,
+                           btproto::MutateRowsRequest const& request) {
+        retry_request = request;
+        return r2;
+      }));
+
+  auto mutator = MakeMutator(MakeMutations(2));
+  auto status = Run(*mutator);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(mutator->ExtractFinalFailures().empty());
+  ASSERT_EQ(1, retry_request.entries_size());
+  EXPECT_EQ("row-0", retry_request.entries(0).row_key());
+}
+
+/// @test Verify that permanent failures are reported with their index.
+TEST_F(PipelinedBulkMutatorTest, PermanentFailure) {
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .WillOnce(Invoke([](grpc::ClientContext*,
+                          btproto::MutateRowsRequest const&) {
+        return MakeReader(
+            MakeResponse({grpc::OK, grpc::OUT_OF_RANGE, grpc::OK}));
+      }));
+
+  auto mutator = MakeMutator(MakeMutations(3));
+  auto status = Run(*mutator);
+  EXPECT_TRUE(status.ok());
+  auto failures = mutator->ExtractFinalFailures();
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("row-1", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::StatusCode::OUT_OF_RANGE, failures[0].status().error_code());
+}
+
+/// @test Verify that the mutations are reported when the policy gives up.
+TEST_F(PipelinedBulkMutatorTest, TooManyFailures) {
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([](grpc::ClientContext*,
+                                btproto::MutateRowsRequest const&) {
+        auto reader = new MockReader;
+        EXPECT_CALL(*reader, Read(_)).WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish())
+            .WillOnce(Return(grpc::Status(grpc::StatusCode::ABORTED, "")));
+        return reader;
+      }));
+
+  // Mix idempotent and non-idempotent mutations, only the former are retried.
+  bt::BulkMutation mut(
+      bt::SingleRowMutation("is-idempotent",
+                            {bt::SetCell("fam", "col", 0, "qux")}),
+      bt::SingleRowMutation("not-idempotent",
+                            {bt::SetCell("fam", "col", "baz")}));
+  auto mutator = MakeMutator(std::move(mut), 4, 1000,
+                             bt::LimitedErrorCountRetryPolicy(1));
+  auto status = Run(*mutator);
+  EXPECT_EQ(grpc::StatusCode::ABORTED, status.error_code());
+  auto failures = mutator->ExtractFinalFailures();
+  ASSERT_EQ(2UL, failures.size());
+  std::sort(failures.begin(), failures.end(),
+            [](bt::FailedMutation const& a, bt::FailedMutation const& b) {
+              return a.original_index() < b.original_index();
+            });
+  EXPECT_EQ("is-idempotent", failures[0].mutation().row_key());
+  EXPECT_EQ("not-idempotent", failures[1].mutation().row_key());
+  for (auto const& f : failures) {
+    EXPECT_TRUE(f.status().ok());
+  }
+}
+
+/// @test Verify that a request finishing after the policy gives up does not
+/// hide the failure.
+TEST_F(PipelinedBulkMutatorTest, SuccessAfterGiveUp) {
+  auto gave_up = std::make_shared<std::promise<void>>();
+  auto gave_up_future = gave_up->get_future();
+  std::promise<void> started;
+  auto started_future = started.get_future();
+
+  EXPECT_CALL(*stub_, MutateRowsRaw(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&gave_up_future, &started, &started_future](
+                                 grpc::ClientContext*,
+                                 btproto::MutateRowsRequest const& request) {
+        auto reader = new MockReader;
+        if (request.entries(0).row_key() == "row-0") {
+          // The first request fails once the second request is in flight.
+          EXPECT_CALL(*reader, Read(_))
+              .WillOnce(Invoke([&started_future](btproto::MutateRowsResponse*) {
+                EXPECT_EQ(std::future_status::ready,
+                          started_future.wait_for(std::chrono::seconds(10)));
+                return false;
+              }));
+          EXPECT_CALL(*reader, Finish())
+              .WillOnce(Return(grpc::Status(grpc::StatusCode::ABORTED, "")));
+          return reader;
+        }
+        started.set_value();
+        // The second request succeeds, but only after the policy gave up.
+        EXPECT_CALL(*reader, Read(_))
+            .WillOnce(Invoke([&gave_up_future](
+                                 btproto::MutateRowsResponse* r) {
+              EXPECT_EQ(std::future_status::ready,
+                        gave_up_future.wait_for(std::chrono::seconds(10)));
+              *r = MakeResponse({grpc::OK});
+              return true;
+            }))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+        return reader;
+      }));
+
+  auto mutator =
+      MakeMutator(MakeMutations(2), 2, 1, SignalingRetryPolicy(gave_up));
+  auto status = Run(*mutator);
+  EXPECT_EQ(grpc::StatusCode::ABORTED, status.error_code());
+  auto failures = mutator->ExtractFinalFailures();
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ("row-0", failures[0].mutation().row_key());
+}
@@ -0,0 +1,119 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/read_ahead_reader.h"
+#include "bigtable/client/internal/make_unique.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+ReadAheadReader::ReadAheadReader(Stream& stream, std::size_t max_responses,
+                                 std::size_t max_bytes)
+    : stream_(stream),
+      max_responses_(max_responses == 0 ? 1 : max_responses),
+      max_bytes_(max_bytes),
+      buffered_bytes_(0),
+      consumer_bytes_(0),
+      done_(false),
+      shutdown_(false),
+      thread_(&ReadAheadReader::ReadLoop, this) {}
+
+ReadAheadReader::~ReadAheadReader() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+  }
+  has_space_.notify_all();
+  thread_.join();
+}
+
+bool ReadAheadReader::Read(std::unique_ptr<Response>& response) {
+  std::unique_lock<std::mutex> lk(mu_);
+  has_data_.wait(lk, [this] { return done_ or not queue_.empty(); });
+  if (queue_.empty()) {
+    return false;
+  }
+  if (response) {
+    free_list_.push_back(std::move(response));
+  }
+  response = std::move(queue_.front().first);
+  consumer_bytes_ = queue_.front().second;
+  buffered_bytes_ -= consumer_bytes_;
+  queue_.pop_front();
+  lk.unlock();
+  has_space_.notify_one();
+  return true;
+}
+
+std::size_t ReadAheadReader::buffered_bytes() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return buffered_bytes_;
+}
+
+std::size_t ReadAheadReader::consumer_bytes() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return consumer_bytes_;
+}
+
+void ReadAheadReader::ReadLoop() {
+  std::unique_ptr<Response> response;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      // Always allow one response in the queue, even if it is larger than
+      // the byte limit, otherwise we could never make progress.  The
+      // response held by the consumer counts towards the limit, it is only
+      // released in the next call to Read().
+      has_space_.wait(lk, [this] {
+        return shutdown_ or
+               (queue_.size() < max_responses_ and
+                (queue_.empty() or
+                 buffered_bytes_ + consumer_bytes_ < max_bytes_));
+      });
+      if (shutdown_) {
+        break;
+      }
+      if (not free_list_.empty()) {
+        response = std::move(free_list_.back());
+        free_list_.pop_back();
+      }
+    }
+    if (response) {
+      response->Reset();
+    } else {
+      response = make_unique<Response>();
+    }
+    // Block on the network without holding the lock, this is the work we
+    // want to overlap with the consumer.
+    if (not stream_.Read(&response->get())) {
+      break;
+    }
+    auto size = response->get().ByteSizeLong();
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      queue_.emplace_back(std::move(response), size);
+      buffered_bytes_ += size;
+    }
+    has_data_.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    done_ = true;
+  }
+  has_data_.notify_all();
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
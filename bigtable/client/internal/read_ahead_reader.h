@@ -0,0 +1,109 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_AHEAD_READER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_AHEAD_READER_H_
+
+#include "bigtable/client/version.h"
+
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <grpc++/grpc++.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bigtable/client/internal/arena_message.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Receive the responses of a `ReadRows` stream in a background thread.
+ *
+ * The thread keeps a bounded queue of responses ahead of the consumer, so
+ * receiving (and decoding) the next responses overlaps with parsing the
+ * current one and with the application work.  The queue is bounded both by
+ * number of responses and by their size in bytes.  The byte limit also
+ * counts the response held by the consumer, so a large response being
+ * parsed pauses the background thread until the consumer is done with it.
+ *
+ * The responses are exchanged with the consumer as `ArenaMessage` objects:
+ * the consumer returns the response it is done with, and the background
+ * thread reuses it (and its arena) for a future response.
+ *
+ * The stream must outlive this object.  The destructor stops reading and
+ * waits for the background thread, if the thread may be blocked in
+ * `Read()` the caller must cancel the call (`ClientContext::TryCancel()`)
+ * before destroying this object.
+ */
+class ReadAheadReader {
+ public:
+  using Response = ArenaMessage<google::bigtable::v2::ReadRowsResponse>;
+  using Stream =
+      grpc::ClientReaderInterface<google::bigtable::v2::ReadRowsResponse>;
+
+  ReadAheadReader(Stream& stream, std::size_t max_responses,
+                  std::size_t max_bytes);
+  ~ReadAheadReader();
+
+  ReadAheadReader(ReadAheadReader const&) = delete;
+  ReadAheadReader& operator=(ReadAheadReader const&) = delete;
+
+  /**
+   * Wait for the next response.
+   *
+   * @param response on input, a response the caller no longer needs, it is
+   *     recycled for future reads (it can be null).  On success, it is
+   *     replaced by the next response in the stream, otherwise it is not
+   *     modified.
+   * @return false if the stream has no more data, in which case the caller
+   *     can call `Finish()` on the stream.
+   */
+  bool Read(std::unique_ptr<Response>& response);
+
+  /// The number of bytes currently buffered ahead of the consumer.
+  std::size_t buffered_bytes() const;
+
+  /// The size of the response last returned by `Read()`.
+  std::size_t consumer_bytes() const;
+
+ private:
+  /// The body of the background thread.
+  void ReadLoop();
+
+  Stream& stream_;
+  std::size_t const max_responses_;
+  std::size_t const max_bytes_;
+
+  mutable std::mutex mu_;
+  std::condition_variable has_data_;
+  std::condition_variable has_space_;
+  std::deque<std::pair<std::unique_ptr<Response>, std::size_t>> queue_;
+  std::vector<std::unique_ptr<Response>> free_list_;
+  std::size_t buffered_bytes_;
+  std::size_t consumer_bytes_;
+  bool done_;
+  bool shutdown_;
+
+  std::thread thread_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_AHEAD_READER_H_
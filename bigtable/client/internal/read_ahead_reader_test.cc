@@ -0,0 +1,160 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/read_ahead_reader.h"
+#include "bigtable/client/testing/mock_response_stream.h"
+
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using google::bigtable::v2::ReadRowsResponse;
+using bigtable::internal::ReadAheadReader;
+using testing::_;
+using testing::Invoke;
+
+namespace {
+/// Return a response with a single chunk for @p row_key.
+ReadRowsResponse MakeResponse(std::string const& row_key) {
+  ReadRowsResponse response;
+  auto& chunk = *response.add_chunks();
+  chunk.set_row_key(row_key);
+  chunk.mutable_family_name()->set_value("fam");
+  chunk.mutable_qualifier()->set_value("qual");
+  chunk.set_value("value");
+  chunk.set_commit_row(true);
+  return response;
+}
+
+/// Wait until @p counter reaches @p expected, or a (generous) timeout.
+void WaitFor(std::atomic<int> const& counter, int expected) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (counter.load() < expected and
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+}  // anonymous namespace
+
+/// @test Verify that the responses are delivered in order.
+TEST(ReadAheadReaderTest, DeliversResponsesInOrder) {
+  bigtable::testing::MockResponseStream stream;
+  int count = 0;
+  EXPECT_CALL(stream, Read(_))
+      .WillRepeatedly(Invoke([&count](ReadRowsResponse* r) {
+        if (count == 3) {
+          return false;
+        }
+        *r = MakeResponse("r" + std::to_string(count++));
+        return true;
+      }));
+
+  ReadAheadReader reader(stream, 2, 1024 * 1024);
+  std::unique_ptr<ReadAheadReader::Response> response;
+  for (std::string key : {"r0", "r1", "r2"}) {
+    ASSERT_TRUE(reader.Read(response));
+    ASSERT_TRUE(response);
+    ASSERT_EQ(1, response->get().chunks_size());
+    EXPECT_EQ(key, response->get().chunks(0).row_key());
+  }
+  auto last = response.get();
+  EXPECT_FALSE(reader.Read(response));
+  // The last response is not modified at the end of the stream.
+  EXPECT_EQ(last, response.get());
+  EXPECT_EQ(0U, reader.buffered_bytes());
+}
+
+/// @test Verify that the reader does not get too far ahead of the consumer.
+TEST(ReadAheadReaderTest, BoundedByResponses) {
+  bigtable::testing::MockResponseStream stream;
+  std::atomic<int> count(0);
+  EXPECT_CALL(stream, Read(_))
+      .WillRepeatedly(Invoke([&count](ReadRowsResponse* r) {
+        *r = MakeResponse("r" + std::to_string(count++));
+        return true;
+      }));
+
+  ReadAheadReader reader(stream, 3, 1024 * 1024);
+  WaitFor(count, 3);
+  // Give the background thread a chance to (incorrectly) read more.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(3, count.load());
+  EXPECT_LT(0U, reader.buffered_bytes());
+
+  // Consuming one response makes room for exactly one more.
+  std::unique_ptr<ReadAheadReader::Response> response;
+  ASSERT_TRUE(reader.Read(response));
+  EXPECT_EQ("r0", response->get().chunks(0).row_key());
+  WaitFor(count, 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(4, count.load());
+}
+
+/// @test Verify that the byte limit is honored, but one response is queued.
+TEST(ReadAheadReaderTest, BoundedByBytes) {
+  bigtable::testing::MockResponseStream stream;
+  std::atomic<int> count(0);
+  EXPECT_CALL(stream, Read(_))
+      .WillRepeatedly(Invoke([&count](ReadRowsResponse* r) {
+        *r = MakeResponse("r" + std::to_string(count++));
+        return true;
+      }));
+
+  ReadAheadReader reader(stream, 100, 1);
+  WaitFor(count, 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, count.load());
+  EXPECT_EQ(MakeResponse("r0").ByteSizeLong(), reader.buffered_bytes());
+
+  std::unique_ptr<ReadAheadReader::Response> response;
+  ASSERT_TRUE(reader.Read(response));
+  EXPECT_EQ("r0", response->get().chunks(0).row_key());
+  ASSERT_TRUE(reader.Read(response));
+  EXPECT_EQ("r1", response->get().chunks(0).row_key());
+}
+
+/// @test Verify that the response held by the consumer counts for the limit.
+TEST(ReadAheadReaderTest, BoundedByBytesIncludingConsumer) {
+  bigtable::testing::MockResponseStream stream;
+  std::atomic<int> count(0);
+  EXPECT_CALL(stream, Read(_))
+      .WillRepeatedly(Invoke([&count](ReadRowsResponse* r) {
+        *r = MakeResponse("r" + std::to_string(count++));
+        return true;
+      }));
+
+  auto const size = MakeResponse("r0").ByteSizeLong();
+  ReadAheadReader reader(stream, 100, size * 5 / 2);
+  WaitFor(count, 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(3, count.load());
+
+  std::unique_ptr<ReadAheadReader::Response> response;
+  ASSERT_TRUE(reader.Read(response));
+  EXPECT_EQ("r0", response->get().chunks(0).row_key());
+  EXPECT_EQ(size, reader.consumer_bytes());
+  EXPECT_EQ(2 * size, reader.buffered_bytes());
+  // The queue has room for another response, but the consumer still holds
+  // "r0", so the reader must wait.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(3, count.load());
+
+  // Returning "r0" makes room for one more response.
+  ASSERT_TRUE(reader.Read(response));
+  EXPECT_EQ("r1", response->get().chunks(0).row_key());
+  WaitFor(count, 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(4, count.load());
+}
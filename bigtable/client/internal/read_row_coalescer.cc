@@ -0,0 +1,121 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/read_row_coalescer.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+std::pair<bool, Row> ReadRowCoalescer::ReadRow(std::string row_key,
+                                               Filter const& filter,
+                                               BatchReader const& reader,
+                                               grpc::Status& status) {
+  // Only calls with the same filter can share a request.
+  auto filter_key = filter.as_proto().SerializeAsString();
+
+  std::unique_lock<std::mutex> lk(mu_);
+  auto& slot = open_batches_[filter_key];
+  bool const is_leader = not slot;
+  if (is_leader) {
+    slot = std::make_shared<Batch>(filter);
+  }
+  std::shared_ptr<Batch> batch = slot;
+  batch->keys.push_back(row_key);
+  ++batch->requests[row_key];
+  if (batch->keys.size() >= options_.max_keys()) {
+    Close(filter_key, batch);
+  }
+
+  if (is_leader) {
+    auto const deadline = std::chrono::steady_clock::now() + options_.window();
+    batch->cv.wait_until(lk, deadline, [&batch] { return batch->closed; });
+    if (not batch->closed) {
+      Close(filter_key, batch);
+    }
+    Run(lk, *batch, reader);
+  } else {
+    batch->cv.wait(lk, [&batch] { return batch->done; });
+  }
+  // The batch is immutable once it is done, the callers can copy their
+  // results without blocking each other or the callers joining new batches.
+  lk.unlock();
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  if (batch->error) {
+    std::rethrow_exception(batch->error);
+  }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  status = batch->status;
+  auto it = batch->rows.find(row_key);
+  if (not status.ok() or it == batch->rows.end()) {
+    return std::make_pair(false, Row("", {}));
+  }
+  // Several callers may have requested the same key, each gets a copy.
+  // Otherwise this is the only caller using the row, and it can take it.
+  if (batch->requests.find(row_key)->second != 1) {
+    return std::make_pair(true, it->second);
+  }
+  return std::make_pair(true, std::move(it->second));
+}
+
+void ReadRowCoalescer::Close(std::string const& filter_key,
+                             std::shared_ptr<Batch> const& batch) {
+  batch->closed = true;
+  auto it = open_batches_.find(filter_key);
+  if (it != open_batches_.end() and it->second == batch) {
+    open_batches_.erase(it);
+  }
+  batch->cv.notify_all();
+}
+
+void ReadRowCoalescer::Run(std::unique_lock<std::mutex>& lk, Batch& batch,
+                           BatchReader const& reader) {
+  // The batch is closed, nobody else touches its keys, and the read does not
+  // need to block the other batches.
+  lk.unlock();
+  RowSet row_set;
+  for (auto& key : batch.keys) {
+    row_set.Append(std::move(key));
+  }
+  std::vector<Row> rows;
+  grpc::Status status;
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  std::exception_ptr error;
+  try {
+    status = reader(std::move(row_set), batch.filter, rows);
+  } catch (...) {
+    error = std::current_exception();
+  }
+#else
+  status = reader(std::move(row_set), batch.filter, rows);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  std::unordered_map<std::string, Row> results;
+  for (auto& row : rows) {
+    auto key = row.row_key();
+    results.emplace(std::move(key), std::move(row));
+  }
+
+  lk.lock();
+  batch.rows = std::move(results);
+  batch.status = std::move(status);
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  batch.error = std::move(error);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  batch.done = true;
+  batch.cv.notify_all();
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
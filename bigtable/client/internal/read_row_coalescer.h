@@ -0,0 +1,115 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_ROW_COALESCER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_ROW_COALESCER_H_
+
+#include "bigtable/client/filters.h"
+#include "bigtable/client/read_row_coalescing_options.h"
+#include "bigtable/client/row.h"
+#include "bigtable/client/row_set.h"
+#include <grpc++/grpc++.h>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Merge concurrent `Table::ReadRow()` calls into multi-key reads.
+ *
+ * The first call for a given filter opens a batch and becomes its leader.
+ * Calls with the same filter that arrive before the batch is closed add
+ * their keys to it and wait.  The leader closes the batch after
+ * `options.window()`, or as soon as it has `options.max_keys()` keys, reads
+ * all the keys with a single call to the `BatchReader`, and wakes up the
+ * other callers.  Each caller then looks up its own key in the results.
+ *
+ * There is no background thread: the leader's own thread does the read.
+ */
+class ReadRowCoalescer {
+ public:
+  /**
+   * Read all the rows in the row set, used by the leader of each batch.
+   *
+   * The rows are returned in the vector, and the function returns the status
+   * of the read.
+   */
+  using BatchReader = std::function<grpc::Status(
+      RowSet, Filter const& filter, std::vector<Row>& rows)>;
+
+  explicit ReadRowCoalescer(ReadRowCoalescingOptions options)
+      : options_(std::move(options)) {}
+
+  /**
+   * Read a single row, possibly in the same request as other calls.
+   *
+   * @return the same values as `Table::ReadRow()`.
+   * @param status receives the status returned by @p reader for the batch
+   *     containing @p row_key.  All the callers in the batch receive the
+   *     same status.
+   * @throws std::exception (or any exception raised by @p reader) if the
+   *     batch containing @p row_key failed with an exception.  All the
+   *     callers in the batch receive the same exception.
+   */
+  std::pair<bool, Row> ReadRow(std::string row_key, Filter const& filter,
+                               BatchReader const& reader, grpc::Status& status);
+
+ private:
+  struct Batch {
+    explicit Batch(Filter f)
+        : filter(std::move(f)), closed(false), done(false) {}
+
+    Filter filter;
+    std::vector<std::string> keys;
+    /// The number of callers waiting for each key.
+    std::unordered_map<std::string, int> requests;
+    /// Set when no more keys can be added.
+    bool closed;
+    /// Set when the results (or the error) are available, the batch is not
+    /// modified after this, other than moving out rows requested only once.
+    bool done;
+    std::unordered_map<std::string, Row> rows;
+    grpc::Status status;
+    std::exception_ptr error;
+    /// Signaled when the batch is closed, and when it is done.
+    std::condition_variable cv;
+  };
+
+  /// Stop adding keys to @p batch, must be called with `mu_` held.
+  void Close(std::string const& filter_key,
+             std::shared_ptr<Batch> const& batch);
+
+  /// Read the keys in a closed batch and publish the results.
+  void Run(std::unique_lock<std::mutex>& lk, Batch& batch,
+           BatchReader const& reader);
+
+  ReadRowCoalescingOptions options_;
+  std::mutex mu_;
+  /// The batches accepting new keys, indexed by the serialized filter.
+  std::unordered_map<std::string, std::shared_ptr<Batch>> open_batches_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READ_ROW_COALESCER_H_
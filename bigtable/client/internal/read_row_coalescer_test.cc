@@ -0,0 +1,207 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/read_row_coalescer.h"
+
+#include <gmock/gmock.h>
+#include <atomic>
+#include <thread>
+
+using bigtable::Filter;
+using bigtable::ReadRowCoalescingOptions;
+using bigtable::Row;
+using bigtable::RowSet;
+using bigtable::internal::ReadRowCoalescer;
+
+namespace {
+/// A BatchReader that returns the keys starting with "r", and counts calls.
+class FakeReader {
+ public:
+  FakeReader() : calls(0) {}
+
+  ReadRowCoalescer::BatchReader AsFunctor() {
+    return [this](RowSet row_set, Filter const&, std::vector<Row>& rows) {
+      ++calls;
+      auto proto = row_set.as_proto();
+      for (auto const& key : proto.row_keys()) {
+        if (key.substr(0, 1) == "r") {
+          rows.emplace_back(Row(key, {}));
+        }
+      }
+      return grpc::Status::OK;
+    };
+  }
+
+  std::atomic<int> calls;
+};
+}  // anonymous namespace
+
+TEST(ReadRowCoalescerTest, MergesConcurrentCalls) {
+  int const thread_count = 8;
+  // Use a long window, the batch is closed when it has all the keys.
+  ReadRowCoalescer coalescer(ReadRowCoalescingOptions()
+                                 .set_window(std::chrono::seconds(60))
+                                 .set_max_keys(thread_count));
+  FakeReader fake;
+  auto reader = fake.AsFunctor();
+
+  std::vector<std::pair<bool, Row>> results(thread_count,
+                                            std::make_pair(false, Row("", {})));
+  std::vector<std::thread> threads;
+  for (int i = 0; i != thread_count; ++i) {
+    threads.emplace_back([&, i] {
+      // The odd keys do not exist.
+      auto key = (i % 2 == 0 ? "r" : "missing") + std::to_string(i);
+      grpc::Status status;
+      results[i] = coalescer.ReadRow(std::move(key), Filter::PassAllFilter(),
+                                     reader, status);
+      EXPECT_TRUE(status.ok());
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(1, fake.calls.load());
+  for (int i = 0; i != thread_count; ++i) {
+    SCOPED_TRACE("i=" + std::to_string(i));
+    if (i % 2 == 0) {
+      EXPECT_TRUE(results[i].first);
+      EXPECT_EQ("r" + std::to_string(i), results[i].second.row_key());
+    } else {
+      EXPECT_FALSE(results[i].first);
+    }
+  }
+}
+
+TEST(ReadRowCoalescerTest, WindowClosesBatch) {
+  ReadRowCoalescer coalescer(ReadRowCoalescingOptions()
+                                 .set_window(std::chrono::microseconds(0))
+                                 .set_max_keys(100));
+  FakeReader fake;
+  auto reader = fake.AsFunctor();
+
+  grpc::Status status;
+  auto found =
+      coalescer.ReadRow("r1", Filter::PassAllFilter(), reader, status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(found.first);
+  EXPECT_EQ("r1", found.second.row_key());
+  auto missing =
+      coalescer.ReadRow("x1", Filter::PassAllFilter(), reader, status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_FALSE(missing.first);
+  EXPECT_EQ(2, fake.calls.load());
+}
+
+TEST(ReadRowCoalescerTest, SameKeyInBatch) {
+  ReadRowCoalescer coalescer(ReadRowCoalescingOptions()
+                                 .set_window(std::chrono::seconds(60))
+                                 .set_max_keys(2));
+  FakeReader fake;
+  auto reader = fake.AsFunctor();
+
+  std::pair<bool, Row> r0(false, Row("", {}));
+  std::pair<bool, Row> r1(false, Row("", {}));
+  grpc::Status s0;
+  grpc::Status s1;
+  std::thread t0([&] {
+    r0 = coalescer.ReadRow("r1", Filter::PassAllFilter(), reader, s0);
+  });
+  std::thread t1([&] {
+    r1 = coalescer.ReadRow("r1", Filter::PassAllFilter(), reader, s1);
+  });
+  t0.join();
+  t1.join();
+
+  EXPECT_EQ(1, fake.calls.load());
+  EXPECT_TRUE(s0.ok());
+  EXPECT_TRUE(s1.ok());
+  EXPECT_TRUE(r0.first);
+  EXPECT_TRUE(r1.first);
+  EXPECT_EQ("r1", r0.second.row_key());
+  EXPECT_EQ("r1", r1.second.row_key());
+}
+
+TEST(ReadRowCoalescerTest, StatusReachesAllCallers) {
+  ReadRowCoalescer coalescer(ReadRowCoalescingOptions()
+                                 .set_window(std::chrono::seconds(60))
+                                 .set_max_keys(2));
+  std::atomic<int> calls(0);
+  ReadRowCoalescer::BatchReader reader = [&calls](RowSet, Filter const&,
+                                                  std::vector<Row>&) {
+    ++calls;
+    return grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+  };
+
+  std::atomic<int> errors(0);
+  auto call = [&](std::string key) {
+    grpc::Status status;
+    auto result = coalescer.ReadRow(std::move(key), Filter::PassAllFilter(),
+                                    reader, status);
+    EXPECT_FALSE(result.first);
+    if (status.error_code() == grpc::StatusCode::UNAVAILABLE) {
+      ++errors;
+    }
+  };
+  std::thread t0(call, "r0");
+  std::thread t1(call, "r1");
+  t0.join();
+  t1.join();
+
+  EXPECT_EQ(1, calls.load());
+  EXPECT_EQ(2, errors.load());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(ReadRowCoalescerTest, ErrorsReachAllCallers) {
+  ReadRowCoalescer coalescer(ReadRowCoalescingOptions()
+                                 .set_window(std::chrono::seconds(60))
+                                 .set_max_keys(2));
+  std::atomic<int> calls(0);
+  ReadRowCoalescer::BatchReader reader = [&calls](RowSet, Filter const&,
+                                                  std::vector<Row>&) {
+    ++calls;
+    throw std::runtime_error("broken");
+    return grpc::Status::OK;
+  };
+
+  std::atomic<int> errors(0);
+  auto call = [&](std::string key) {
+    grpc::Status status;
+    try {
+      coalescer.ReadRow(std::move(key), Filter::PassAllFilter(), reader,
+                        status);
+    } catch (std::runtime_error const&) {
+      ++errors;
+    }
+  };
+  std::thread t0(call, "r0");
+  std::thread t1(call, "r1");
+  t0.join();
+  t1.join();
+
+  EXPECT_EQ(1, calls.load());
+  EXPECT_EQ(2, errors.load());
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+TEST(ReadRowCoalescingOptionsTest, Defaults) {
+  ReadRowCoalescingOptions options;
+  EXPECT_EQ(std::chrono::microseconds(1000), options.window());
+  EXPECT_EQ(100U, options.max_keys());
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(options.set_max_keys(0), std::range_error);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
@@ -14,131 +14,108 @@
 
 #include "bigtable/client/internal/readrowsparser.h"
 #include "bigtable/client/internal/throw_delegate.h"
+#include <atomic>
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
 using google::bigtable::v2::ReadRowsResponse_CellChunk;
 
+namespace {
+/**
+ * The maximum number of names interned by a parser.
+ *
+ * Scans over tables that use the column qualifiers as data (e.g. timestamps)
+ * would otherwise accumulate all the qualifiers in the table.
+ */
+constexpr std::size_t kMaxInternedNames = 1024;
+}  // anonymous namespace
+
 void ReadRowsParser::HandleChunk(ReadRowsResponse_CellChunk chunk) {
-  if (end_of_stream_) {
-    RaiseRuntimeError("HandleChunk after end of stream");
-  }
-  if (HasNext()) {
-    RaiseRuntimeError("HandleChunk called before taking the previous row");
-  }
+  ConsumeChunk(chunk);
+}
 
-  if (not chunk.row_key().empty()) {
-    if (last_seen_row_key_.compare(chunk.row_key()) >= 0) {
-      RaiseRuntimeError("Row keys are expected in increasing order");
-    }
-    chunk.mutable_row_key()->swap(cell_.row);
+void ReadRowsParser::ConsumeChunk(ReadRowsResponse_CellChunk& chunk) {
+  if (not chunks_.end_of_stream() and HasNext()) {
+    RaiseRuntimeError("HandleChunk called before taking the previous row");
   }
+  chunks_.Consume(chunk, builder_);
+}
 
-  if (chunk.has_family_name()) {
-    if (not chunk.has_qualifier()) {
-      RaiseRuntimeError("New column family must specify qualifier");
-    }
-    chunk.mutable_family_name()->mutable_value()->swap(cell_.family);
-  }
+void ReadRowsParser::HandleEndOfStream() { chunks_.HandleEndOfStream(); }
 
-  if (chunk.has_qualifier()) {
-    chunk.mutable_qualifier()->mutable_value()->swap(cell_.column);
+Row ReadRowsParser::Next() {
+  if (not builder_.row_ready()) {
+    RaiseRuntimeError("Next with row not ready");
   }
+  return builder_.TakeRow();
+}
 
-  if (cell_first_chunk_) {
-    cell_.timestamp = chunk.timestamp_micros();
+void ReadRowsParser::Next(Row& row) {
+  if (not builder_.row_ready()) {
+    RaiseRuntimeError("Next with row not ready");
   }
+  builder_.TakeRow(row);
+}
 
-  std::move(chunk.mutable_labels()->begin(), chunk.mutable_labels()->end(),
-            std::back_inserter(cell_.labels));
+Row ReadRowsParser::RowBuilder::TakeRow() {
+  row_ready_ = false;
 
-  if (cell_first_chunk_) {
-    // Most common case, move the value
-    chunk.mutable_value()->swap(cell_.value);
-  } else {
-    cell_.value.append(chunk.value());
-  }
+  // Discard any recycled cells not used by this row.
+  cells_.erase(cells_.begin() + cell_count_, cells_.end());
+  cell_count_ = 0;
+  Row row(std::move(row_key_), std::move(cells_));
+  row_key_.reset();
+  cells_.clear();
 
-  cell_first_chunk_ = false;
+  return row;
+}
 
-  // This is a hint we get about the total size
-  if (chunk.value_size() > 0) {
-    cell_.value.reserve(chunk.value_size());
-  }
+void ReadRowsParser::RowBuilder::TakeRow(Row& row) {
+  row_ready_ = false;
 
-  // Last chunk in the cell has zero for value size
-  if (chunk.value_size() == 0) {
-    if (cells_.empty()) {
-      if (cell_.row.empty()) {
-        RaiseRuntimeError("Missing row key at last chunk in cell");
-      }
-      row_key_ = cell_.row;
-    } else {
-      if (row_key_ != cell_.row) {
-        RaiseRuntimeError("Different row key in cell chunk");
-      }
-    }
-    cells_.emplace_back(MovePartialToCell());
-    cell_first_chunk_ = true;
+  cells_.erase(cells_.begin() + cell_count_, cells_.end());
+  cell_count_ = 0;
+  // Keep the cells of the previous row, they hold the next rows.
+  cells_.swap(row.cells_);
+  // Release the previous row key now, so MakeRowKey() can reuse it.
+  for (auto& cell : cells_) {
+    cell.row_key_.reset();
   }
+  row.row_key_ = std::move(row_key_);
+  row_key_.reset();
+  row.index_.reset();
+}
 
-  if (chunk.reset_row()) {
-    cells_.clear();
-    cell_ = {};
-    if (not cell_first_chunk_) {
-      RaiseRuntimeError("Reset row with an unfinished cell");
+std::shared_ptr<std::string const> ReadRowsParser::RowBuilder::MakeRowKey(
+    std::string const& row_key) {
+  for (auto& key : keys_) {
+    if (key and key.use_count() == 1) {
+      // use_count() is a relaxed load, synchronize with the thread that
+      // released the last reference before writing to the key.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      key->assign(row_key);
+      return key;
     }
-  } else if (chunk.commit_row()) {
-    if (not cell_first_chunk_) {
-      RaiseRuntimeError("Commit row with an unfinished cell");
-    }
-    if (cells_.empty()) {
-      RaiseRuntimeError("Commit row missing the row key");
-    }
-    row_ready_ = true;
-    last_seen_row_key_ = row_key_;
-    cell_.row.clear();
   }
+  auto& key = keys_[next_key_];
+  next_key_ = (next_key_ + 1) % 2;
+  key = std::make_shared<std::string>(row_key);
+  return key;
 }
 
-void ReadRowsParser::HandleEndOfStream() {
-  if (end_of_stream_) {
-    RaiseRuntimeError("HandleEndOfStream called twice");
+std::shared_ptr<std::string const> ReadRowsParser::RowBuilder::Intern(
+    std::string* name) {
+  auto it = names_.find(*name);
+  if (it != names_.end()) {
+    return it->second;
   }
-  end_of_stream_ = true;
-
-  if (not cell_first_chunk_) {
-    RaiseRuntimeError("end of stream with unfinished cell");
+  if (names_.size() >= kMaxInternedNames) {
+    names_.clear();
   }
-
-  if (cells_.begin() != cells_.end() and not row_ready_) {
-    RaiseRuntimeError("end of stream with unfinished row");
-  }
-}
-
-bool ReadRowsParser::HasNext() const { return row_ready_; }
-
-Row ReadRowsParser::Next() {
-  if (not row_ready_) {
-    RaiseRuntimeError("Next with row not ready");
-  }
-  row_ready_ = false;
-
-  Row row(std::move(row_key_), std::move(cells_));
-  row_key_.clear();
-
-  return row;
-}
-
-Cell ReadRowsParser::MovePartialToCell() {
-  // The row, family, and column are explicitly copied because the
-  // ReadRows v2 may reuse them in future chunks. See the CellChunk
-  // message comments in bigtable.proto.
-  Cell cell(cell_.row, cell_.family, cell_.column, cell_.timestamp,
-            std::move(cell_.value), std::move(cell_.labels));
-  cell_.value.clear();
-  return cell;
+  auto interned = std::make_shared<std::string const>(std::move(*name));
+  names_.emplace(*interned, interned);
+  return interned;
 }
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
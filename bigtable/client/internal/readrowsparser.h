@@ -16,9 +16,11 @@
 #define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_READROWSPARSER_H_
 
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 #include "bigtable/client/cell.h"
-#include "bigtable/client/internal/make_unique.h"
+#include "bigtable/client/internal/chunk_parser.h"
 #include "bigtable/client/row.h"
 
 namespace bigtable {
@@ -45,19 +47,14 @@ namespace internal {
  * single and unique parser should be used for each stream of ReadRows
  * responses. If errors occur, an exception is thrown as documented by
  * each method and the parser object is left in an undefined state.
+ *
+ * The member functions are not virtual, they are called for every chunk and
+ * row in the scan loops.  Tests replace the parser with a
+ * `ReadRowsParserInterface` instead.
  */
-class ReadRowsParser {
+class ReadRowsParser final {
  public:
-  ReadRowsParser()
-      : row_key_(""),
-        cells_(),
-        cell_first_chunk_(true),
-        cell_(),
-        last_seen_row_key_(""),
-        row_ready_(false),
-        end_of_stream_(false) {}
-
-  virtual ~ReadRowsParser() = default;
+  ReadRowsParser() = default;
 
   /**
    * Pass an input chunk proto to the parser.
@@ -67,8 +64,19 @@ class ReadRowsParser {
    *
    * @throws std::runtime_error if validation failed.
    */
-  virtual void HandleChunk(
-      google::bigtable::v2::ReadRowsResponse_CellChunk chunk);
+  void HandleChunk(google::bigtable::v2::ReadRowsResponse_CellChunk chunk);
+
+  /**
+   * Pass an input chunk proto to the parser, consuming it in place.
+   *
+   * This is the preferred entry point when the caller owns the response, e.g.
+   * `RowReader`.  The parser validates the chunk through references into the
+   * chunk strings, and only takes ownership (by swapping) of the data it
+   * keeps.  The chunk is left in a valid but unspecified state.
+   *
+   * @throws std::runtime_error under the same conditions as HandleChunk().
+   */
+  void ConsumeChunk(google::bigtable::v2::ReadRowsResponse_CellChunk& chunk);
 
   /**
    * Signal that the input stream reached the end.
@@ -76,14 +84,14 @@ class ReadRowsParser {
    * @throws std::runtime_error if more data was expected to finish
    * the current row.
    */
-  virtual void HandleEndOfStream();
+  void HandleEndOfStream();
 
   /**
    * True if the data parsed so far yielded a Row.
    *
    * Call Next() to take the row.
    */
-  virtual bool HasNext() const;
+  bool HasNext() const { return builder_.row_ready(); }
 
   /**
    * Extract and take ownership of the data in a row.
@@ -92,59 +100,155 @@ class ReadRowsParser {
    *
    * @throws std::runtime_error if HasNext() is false.
    */
-  virtual Row Next();
+  Row Next();
 
- private:
-  /// Holds partially formed data until a full Row is ready.
-  struct ParseCell {
-    std::string row;
-    std::string family;
-    std::string column;
-    int64_t timestamp;
-    std::string value;
-    std::vector<std::string> labels;
-  };
+  /**
+   * Extract the data in a row into @p row, reusing its memory.
+   *
+   * The cells of the previous contents of @p row are kept by the parser, and
+   * overwritten in place by the following rows.  Scans over rows of similar
+   * shape do not allocate any memory per row with this function.
+   *
+   * @throws std::runtime_error if HasNext() is false, @p row is not modified
+   * in this case.
+   */
+  void Next(Row& row);
+
+  /// Limit the size of a row, larger rows are rejected as invalid data.
+  void set_max_row_bytes(std::size_t n) { chunks_.set_max_row_bytes(n); }
 
+  /// The number of bytes received so far for the row in progress.
+  std::size_t partial_row_bytes() const { return chunks_.row_bytes(); }
+
+  /// Enable or disable the row key order checks, see `ChunkParser`.
+  void set_validate_row_keys(bool v) { chunks_.set_validate_row_keys(v); }
+
+ private:
   /**
-   * Moves partial results into a Cell class.
+   * Receives the contents of the chunks and assembles them into rows.
    *
-   * Also helps handle string ownership correctly. The value is moved
-   * when converting to a result cell, but the key, family and column
-   * are copied, because they are possibly reused by following cells.
+   * The row key, family and column are shared by the cells, because the
+   * ReadRows v2 protocol reuses them in following chunks. See the CellChunk
+   * message comments in bigtable.proto.
    */
-  Cell MovePartialToCell();
+  class RowBuilder {
+   public:
+    RowBuilder() : next_key_(0), cell_count_(0), row_ready_(false) {}
+
+    void OnFamily(std::string& family) { family_ = Intern(&family); }
+    void OnQualifier(std::string& qualifier) { column_ = Intern(&qualifier); }
+    void OnRowStart(std::string const& row_key) {
+      row_key_ = MakeRowKey(row_key);
+    }
+    void OnCell(std::int64_t timestamp, std::string& value,
+                std::vector<std::string>& labels) {
+      if (cell_count_ < cells_.size()) {
+        // Overwrite a cell recycled from a previous row, the buffers of its
+        // value and labels go back to the caller, who reuses them.
+        Cell& cell = cells_[cell_count_];
+        cell.row_key_ = row_key_;
+        cell.family_name_ = family_;
+        cell.column_qualifier_ = column_;
+        cell.timestamp_ = timestamp;
+        cell.value_.swap(value);
+        cell.labels_.swap(labels);
+      } else {
+        cells_.emplace_back(Cell(row_key_, family_, column_, timestamp,
+                                 std::move(value), std::move(labels)));
+      }
+      ++cell_count_;
+    }
+    // Values are always assembled in memory, the size of split values is
+    // known in advance, so the buffer is allocated only once.
+    bool OnValueStart(std::int64_t, std::size_t, std::vector<std::string>&) {
+      return false;
+    }
+    void OnValueChunk(std::string&) {}
+    void OnValueEnd() {}
+    void OnRowCommit() { row_ready_ = true; }
+    void OnRowReset() {
+      cell_count_ = 0;
+      row_key_.reset();
+    }
+
+    bool row_ready() const { return row_ready_; }
+    Row TakeRow();
+    void TakeRow(Row& row);
+
+   private:
+    /**
+     * Return a copy of @p row_key to share with the cells of a row.
+     *
+     * The storage of the keys is reused once the rows (and cells) that
+     * referred to it are gone.  Two keys are kept, because the previous row
+     * is usually still alive when the next one starts.
+     */
+    std::shared_ptr<std::string const> MakeRowKey(std::string const& row_key);
+
+    /**
+     * Return a shared copy of a family name or column qualifier.
+     *
+     * Most scans return the same few families and columns in every row, so
+     * interning them avoids allocating the names for each cell.
+     */
+    std::shared_ptr<std::string const> Intern(std::string* name);
 
-  /// Row key for the current row.
-  std::string row_key_;
+    /// The family names and column qualifiers seen in this stream.
+    std::unordered_map<std::string, std::shared_ptr<std::string const>>
+        names_;
 
-  /// Parsed cells of a yet unfinished row.
-  std::vector<Cell> cells_;
+    /// Row key for the current row, shared by all its cells.
+    std::shared_ptr<std::string const> row_key_;
+    std::shared_ptr<std::string const> family_;
+    std::shared_ptr<std::string const> column_;
 
-  /// Is the next incoming chunk the first in a cell?
-  bool cell_first_chunk_;
+    /// The row keys created by MakeRowKey(), kept for reuse.
+    std::shared_ptr<std::string> keys_[2];
+    std::size_t next_key_;
 
-  /// Stores partial fields.
-  ParseCell cell_;
+    /**
+     * Parsed cells of a yet unfinished row.
+     *
+     * Only the first `cell_count_` elements belong to the row, the rest are
+     * recycled cells waiting to be overwritten.
+     */
+    std::vector<Cell> cells_;
+    std::size_t cell_count_;
 
-  /// Set when a row is ready.
-  std::string last_seen_row_key_;
+    /// True iff cells_ make up a complete row.
+    bool row_ready_;
+  };
+
+  ChunkParser<RowBuilder> chunks_;
+  RowBuilder builder_;
+};
 
-  /// True iff cells_ make up a complete row.
-  bool row_ready_;
+/**
+ * The operations of `ReadRowsParser` used by `RowReader`, as virtual functions.
+ *
+ * `RowReader` uses a `ReadRowsParser` directly, this interface is only used to
+ * inject test doubles through a `ReadRowsParserFactory`.
+ */
+class ReadRowsParserInterface {
+ public:
+  virtual ~ReadRowsParserInterface() = default;
 
-  /// Have we received the end of stream call?
-  bool end_of_stream_;
+  virtual void ConsumeChunk(
+      google::bigtable::v2::ReadRowsResponse_CellChunk& chunk) = 0;
+  virtual void HandleEndOfStream() = 0;
+  virtual bool HasNext() const = 0;
+  virtual Row Next() = 0;
+  /// Like `ReadRowsParser::Next(Row&)`, the default does not reuse memory.
+  virtual void Next(Row& row) { row = Next(); }
 };
 
-/// Factory for creating parser instances, defined for testability.
+/// Factory for creating test doubles of the parser, see `RowReader`.
 class ReadRowsParserFactory {
  public:
   virtual ~ReadRowsParserFactory() = default;
 
   /// Returns a newly created parser instance.
-  virtual std::unique_ptr<ReadRowsParser> Create() {
-    return bigtable::internal::make_unique<ReadRowsParser>();
-  }
+  virtual std::unique_ptr<ReadRowsParserInterface> Create() = 0;
 };
 }  // namespace internal
 }  // namespace BIGTABLE_CLIENT_NS
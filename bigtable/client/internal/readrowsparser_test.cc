@@ -161,6 +161,319 @@ TEST(ReadRowsParserTest, SingleChunkValueIsMoved) {
   EXPECT_EQ(data_ptr, r.cells().begin()->value().data());
 }
 
+TEST(ReadRowsParserTest, ConsumeChunkTakesValueInPlace) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  ReadRowsResponse_CellChunk chunk;
+  std::string chunk1 = R"(
+    row_key: "RK"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    commit_row: true
+    )";
+  ASSERT_TRUE(TextFormat::ParseFromString(chunk1, &chunk));
+
+  std::string value(1024, 'a');  // avoid any small value optimizations
+  auto* data_ptr = value.data();
+  chunk.mutable_value()->swap(value);
+
+  ASSERT_FALSE(parser.HasNext());
+  parser.ConsumeChunk(chunk);
+  ASSERT_TRUE(parser.HasNext());
+  bigtable::Row r = parser.Next();
+  ASSERT_EQ(1U, r.cells().size());
+
+  EXPECT_EQ("RK", r.row_key());
+  EXPECT_EQ(data_ptr, r.cells().begin()->value().data());
+}
+
+TEST(ReadRowsParserTest, RowKeyAndNamesAreShared) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  std::vector<ReadRowsResponse_CellChunk> chunks(3);
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK1"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "V1"
+    )", &chunks[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    timestamp_micros: 41
+    value: "V2"
+    commit_row: true
+    )", &chunks[1]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK2"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "V3"
+    commit_row: true
+    )", &chunks[2]));
+
+  parser.HandleChunk(chunks[0]);
+  parser.HandleChunk(chunks[1]);
+  ASSERT_TRUE(parser.HasNext());
+  bigtable::Row r1 = parser.Next();
+  parser.HandleChunk(chunks[2]);
+  ASSERT_TRUE(parser.HasNext());
+  bigtable::Row r2 = parser.Next();
+
+  ASSERT_EQ(2U, r1.cells().size());
+  ASSERT_EQ(1U, r2.cells().size());
+  auto const& c1 = r1.cells()[0];
+  auto const& c2 = r1.cells()[1];
+  auto const& c3 = r2.cells()[0];
+  // All the cells in a row share the row key.
+  EXPECT_EQ(r1.row_key().data(), c1.row_key().data());
+  EXPECT_EQ(c1.row_key().data(), c2.row_key().data());
+  EXPECT_EQ("RK2", c3.row_key());
+  // The family and column names are interned across rows.
+  EXPECT_EQ(c1.family_name().data(), c3.family_name().data());
+  EXPECT_EQ(c1.column_qualifier().data(), c2.column_qualifier().data());
+  EXPECT_EQ(c1.column_qualifier().data(), c3.column_qualifier().data());
+  EXPECT_EQ("V2", c2.value());
+}
+
+TEST(ReadRowsParserTest, NextReusesRowMemory) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  // Use keys longer than any small string optimization.
+  auto make_row = [](std::string const& key, std::string const& column) {
+    std::vector<ReadRowsResponse_CellChunk> chunks(2);
+    EXPECT_TRUE(TextFormat::ParseFromString(R"(
+      family_name: < value: "F">
+      timestamp_micros: 42
+      value: "V1"
+      )", &chunks[0]));
+    chunks[0].mutable_row_key()->assign(key);
+    chunks[0].mutable_qualifier()->set_value(column);
+    EXPECT_TRUE(TextFormat::ParseFromString(R"(
+      timestamp_micros: 41
+      value: "V2"
+      commit_row: true
+      )", &chunks[1]));
+    return chunks;
+  };
+
+  bigtable::Row row("", {});
+  std::vector<std::string const*> keys;
+  std::vector<bigtable::Cell const*> cells;
+  for (int i = 0; i != 4; ++i) {
+    std::string key = "a-long-row-key-" + std::to_string(i);
+    std::string column = "C" + std::to_string(i);
+    for (auto& chunk : make_row(key, column)) {
+      EXPECT_FALSE(parser.HasNext());
+      parser.ConsumeChunk(chunk);
+    }
+    ASSERT_TRUE(parser.HasNext());
+    parser.Next(row);
+    EXPECT_FALSE(parser.HasNext());
+
+    EXPECT_EQ(key, row.row_key());
+    ASSERT_EQ(2U, row.cells().size());
+    EXPECT_EQ(key, row.cells()[1].row_key());
+    EXPECT_EQ(column, row.cells()[1].column_qualifier());
+    EXPECT_EQ("V2", row.cells()[1].value());
+    // The lookup index is rebuilt for each row.
+    auto const* cell = row.find("F", column);
+    ASSERT_NE(nullptr, cell);
+    EXPECT_EQ("V1", cell->value());
+
+    keys.push_back(&row.row_key());
+    cells.push_back(row.cells().data());
+  }
+  parser.HandleEndOfStream();
+
+  // The parser keeps the cells returned by the previous call, and the storage
+  // for two row keys.
+  EXPECT_EQ(cells[1], cells[3]);
+  EXPECT_EQ(keys[0], keys[2]);
+  EXPECT_EQ(keys[1], keys[3]);
+}
+
+TEST(ReadRowsParserTest, RowKeyIsNotReusedWhileShared) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  std::vector<ReadRowsResponse_CellChunk> chunks(3);
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_TRUE(TextFormat::ParseFromString(R"(
+      family_name: < value: "F">
+      qualifier: < value: "C">
+      timestamp_micros: 42
+      value: "V"
+      commit_row: true
+      )", &chunks[i]));
+    chunks[i].set_row_key("a-long-row-key-" + std::to_string(i));
+  }
+
+  bigtable::Row row("", {});
+  parser.ConsumeChunk(chunks[0]);
+  parser.Next(row);
+  // A copy of the cell keeps the row key alive.
+  bigtable::Cell saved = row.cells()[0];
+  parser.ConsumeChunk(chunks[1]);
+  parser.Next(row);
+  parser.ConsumeChunk(chunks[2]);
+  parser.Next(row);
+
+  EXPECT_EQ("a-long-row-key-0", saved.row_key());
+  EXPECT_EQ("a-long-row-key-2", row.row_key());
+  EXPECT_EQ("a-long-row-key-2", row.cells()[0].row_key());
+}
+
+TEST(ReadRowsParserTest, MaxRowBytesAppliesToEachRow) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  // "RK1" + "F" + "C" + "V1" + "V2" is the largest row.
+  parser.set_max_row_bytes(9);
+  std::vector<ReadRowsResponse_CellChunk> chunks(3);
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK1"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "V1"
+    )", &chunks[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    timestamp_micros: 41
+    value: "V2"
+    commit_row: true
+    )", &chunks[1]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK2"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "V3"
+    commit_row: true
+    )", &chunks[2]));
+
+  EXPECT_EQ(0U, parser.partial_row_bytes());
+  parser.HandleChunk(chunks[0]);
+  EXPECT_EQ(7U, parser.partial_row_bytes());
+  parser.HandleChunk(chunks[1]);
+  EXPECT_EQ(0U, parser.partial_row_bytes());
+  ASSERT_TRUE(parser.HasNext());
+  EXPECT_EQ("RK1", parser.Next().row_key());
+  parser.HandleChunk(chunks[2]);
+  ASSERT_TRUE(parser.HasNext());
+  EXPECT_EQ("RK2", parser.Next().row_key());
+  parser.HandleEndOfStream();
+}
+
+TEST(ReadRowsParserTest, RowKeyValidationCanBeDisabled) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  parser.set_validate_row_keys(false);
+  std::vector<ReadRowsResponse_CellChunk> chunks(2);
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK2"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    value: "V1"
+    commit_row: true
+    )", &chunks[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK1"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    value: "V2"
+    commit_row: true
+    )", &chunks[1]));
+
+  // The keys are out of order, but the parser does not check them.
+  parser.ConsumeChunk(chunks[0]);
+  ASSERT_TRUE(parser.HasNext());
+  EXPECT_EQ("RK2", parser.Next().row_key());
+  parser.ConsumeChunk(chunks[1]);
+  ASSERT_TRUE(parser.HasNext());
+  EXPECT_EQ("RK1", parser.Next().row_key());
+  parser.HandleEndOfStream();
+}
+
+TEST(ReadRowsParserTest, SplitValueIsAssembled) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  std::vector<ReadRowsResponse_CellChunk> chunks(3);
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "0123456789"
+    value_size: 25
+    )", &chunks[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    value: "abcdefghij"
+    value_size: 25
+    )", &chunks[1]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    value: "ABCDE"
+    commit_row: true
+    )", &chunks[2]));
+
+  // The row size counts the data received, not the announced size.
+  std::vector<std::size_t> expected_row_bytes{14, 24, 0};
+  for (std::size_t i = 0; i != chunks.size(); ++i) {
+    EXPECT_FALSE(parser.HasNext());
+    parser.ConsumeChunk(chunks[i]);
+    EXPECT_EQ(expected_row_bytes[i], parser.partial_row_bytes());
+  }
+  ASSERT_TRUE(parser.HasNext());
+  auto row = parser.Next();
+  ASSERT_EQ(1U, row.cells().size());
+  EXPECT_EQ("0123456789abcdefghijABCDE", row.cells()[0].value());
+  parser.HandleEndOfStream();
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(ReadRowsParserTest, MaxRowBytesRejectsLargeSplitValue) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  parser.set_max_row_bytes(1024);
+  ReadRowsResponse_CellChunk chunk;
+  // The first chunk of the value announces its total size, the parser
+  // rejects the row before buffering any of it.
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "V"
+    value_size: 1048576
+    )", &chunk));
+
+  EXPECT_THROW(parser.HandleChunk(chunk), std::runtime_error);
+}
+
+TEST(ReadRowsParserTest, SplitValueLargerThanAnnouncedSize) {
+  using google::protobuf::TextFormat;
+  ReadRowsParser parser;
+  parser.set_max_row_bytes(1024);
+  std::vector<ReadRowsResponse_CellChunk> chunks(2);
+  // The value fits in the row size limit, but the continuation chunks send
+  // more data than announced.
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    row_key: "RK"
+    family_name: < value: "F">
+    qualifier: < value: "C">
+    timestamp_micros: 42
+    value: "0123456789"
+    value_size: 15
+    )", &chunks[0]));
+  ASSERT_TRUE(TextFormat::ParseFromString(R"(
+    value: "abcdefghij"
+    value_size: 15
+    )", &chunks[1]));
+
+  parser.ConsumeChunk(chunks[0]);
+  EXPECT_THROW(parser.ConsumeChunk(chunks[1]), bigtable::internal::ParserError);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
 // **** Acceptance tests helpers ****
 
 namespace bigtable {
@@ -218,8 +531,13 @@ class AcceptanceTest : public ::testing::Test {
   }
 
   void FeedChunks(std::vector<ReadRowsResponse_CellChunk> chunks) {
-    for (auto const& chunk : chunks) {
-      parser_.HandleChunk(chunk);
+    // The acceptance tests include invalid row key sequences, enable the
+    // checks even if the build disables them by default.
+    parser_.set_validate_row_keys(true);
+    // Use the in-place entry point, as RowReader does. HandleChunk() is a
+    // thin wrapper around it.
+    for (auto& chunk : chunks) {
+      parser_.ConsumeChunk(chunk);
       if (parser_.HasNext()) {
         rows_.emplace_back(parser_.Next());
       }
@@ -0,0 +1,158 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/resumable_request.h"
+#include <algorithm>
+#include "bigtable/client/row_reader.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+namespace btproto = ::google::bigtable::v2;
+
+namespace {
+/// Return true if all the rows in @p range are <= @p key.
+bool RangeEndsAtOrBefore(btproto::RowRange const& range,
+                         std::string const& key) {
+  switch (range.end_key_case()) {
+    case btproto::RowRange::kEndKeyClosed:
+      return range.end_key_closed() <= key;
+    case btproto::RowRange::kEndKeyOpen:
+      // The empty string means "infinite" for the end of a range.
+      return not range.end_key_open().empty() and
+             range.end_key_open() <= key;
+    case btproto::RowRange::END_KEY_NOT_SET:
+      break;
+  }
+  return false;
+}
+
+/// Return true if some of the rows in @p range are <= @p key.
+bool RangeStartsAtOrBefore(btproto::RowRange const& range,
+                           std::string const& key) {
+  switch (range.start_key_case()) {
+    case btproto::RowRange::kStartKeyClosed:
+      return range.start_key_closed() <= key;
+    case btproto::RowRange::kStartKeyOpen:
+      return range.start_key_open() < key;
+    case btproto::RowRange::START_KEY_NOT_SET:
+      break;
+  }
+  return true;
+}
+}  // anonymous namespace
+
+ResumableRequest::ResumableRequest(std::string const& table_name,
+                                   RowSet row_set, std::int64_t rows_limit,
+                                   Filter const& filter)
+    : rows_limit_(rows_limit), rows_count_(0) {
+  request_.set_table_name(table_name);
+
+  auto row_set_proto = row_set.as_proto_move();
+  request_.mutable_rows()->Swap(&row_set_proto);
+  // Keep the keys sorted so they can be trimmed with a binary search, the
+  // service returns the rows in key order anyway.
+  auto& keys = *request_.mutable_rows()->mutable_row_keys();
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  auto filter_proto = filter.as_proto();
+  request_.mutable_filter()->Swap(&filter_proto);
+
+  if (rows_limit_ != RowReader::NO_ROWS_LIMIT) {
+    request_.set_rows_limit(rows_limit_);
+  }
+}
+
+void ResumableRequest::OnRows(std::int64_t count,
+                              std::string const& last_key) {
+  if (count == 0) {
+    return;
+  }
+  rows_count_ += count;
+  if (not last_row_key_ or *last_row_key_ != last_key) {
+    last_row_key_ = std::make_shared<std::string const>(last_key);
+  }
+}
+
+bool ResumableRequest::PrepareRetry() {
+  // In the unlikely case when we have already reached the requested
+  // number of rows and still receive an error (the parser can throw
+  // an error at end of stream for example), there is no need to
+  // retry and we have no good value for rows_limit anyway.
+  if (rows_limit_ != RowReader::NO_ROWS_LIMIT and rows_limit_ <= rows_count_) {
+    return false;
+  }
+
+  // We've returned some rows and need to make sure we don't request them
+  // again.  If nothing is left to read, stop.
+  if (last_row_key_ and not Trim(*last_row_key_)) {
+    return false;
+  }
+  // Only empty ranges may be left, note that a request with no keys and no
+  // ranges reads all the rows.
+  auto const& rows = request_.rows();
+  if (rows.row_keys_size() == 0 and rows.row_ranges_size() != 0) {
+    bool all_empty = true;
+    for (auto const& r : rows.row_ranges()) {
+      if (not RowRange(r).IsEmpty()) {
+        all_empty = false;
+        break;
+      }
+    }
+    if (all_empty) {
+      return false;
+    }
+  }
+
+  if (rows_limit_ != RowReader::NO_ROWS_LIMIT) {
+    request_.set_rows_limit(rows_limit_ - rows_count_);
+  }
+  return true;
+}
+
+bool ResumableRequest::Trim(std::string const& key) {
+  auto& rows = *request_.mutable_rows();
+  if (rows.row_keys_size() == 0 and rows.row_ranges_size() == 0) {
+    // Special case: "all rows", continue after the last key.
+    rows.add_row_ranges()->set_start_key_open(key);
+    return true;
+  }
+
+  auto& keys = *rows.mutable_row_keys();
+  auto first = std::upper_bound(keys.begin(), keys.end(), key);
+  keys.DeleteSubrange(0, static_cast<int>(first - keys.begin()));
+
+  auto& ranges = *rows.mutable_row_ranges();
+  int output = 0;
+  for (int i = 0; i != ranges.size(); ++i) {
+    auto& range = *ranges.Mutable(i);
+    if (RangeEndsAtOrBefore(range, key)) {
+      continue;
+    }
+    if (RangeStartsAtOrBefore(range, key)) {
+      range.set_start_key_open(key);
+    }
+    if (output != i) {
+      ranges.SwapElements(output, i);
+    }
+    ++output;
+  }
+  ranges.DeleteSubrange(output, ranges.size() - output);
+  return rows.row_keys_size() != 0 or rows.row_ranges_size() != 0;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,92 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_RESUMABLE_REQUEST_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_RESUMABLE_REQUEST_H_
+
+#include "bigtable/client/version.h"
+
+#include <google/bigtable/v2/bigtable.pb.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "bigtable/client/filters.h"
+#include "bigtable/client/row.h"
+#include "bigtable/client/row_set.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Keep the `ReadRowsRequest` for a read, and update it to resume after
+ * failures.
+ *
+ * The request is built once, with the row keys sorted, and on each retry it
+ * is trimmed in place to skip the rows already received: the row keys are
+ * trimmed with a binary search, and the ranges are modified in place.  The
+ * filter and the remaining keys are not copied again.  The last row received
+ * is tracked by sharing its row key, so there is no per-row allocation.
+ *
+ * This class is used by both `RowReader` and `AsyncRowReader`.
+ */
+class ResumableRequest {
+ public:
+  ResumableRequest(std::string const& table_name, RowSet row_set,
+                   std::int64_t rows_limit, Filter const& filter);
+
+  /// The request to send in the next stream.
+  google::bigtable::v2::ReadRowsRequest const& request() const {
+    return request_;
+  }
+
+  /// Record that @p row was received, sharing (not copying) its key.
+  void OnRow(Row const& row) {
+    ++rows_count_;
+    last_row_key_ = row.row_key_;
+  }
+
+  /// Record that @p count rows were received, the last one was @p last_key.
+  void OnRows(std::int64_t count, std::string const& last_key);
+
+  /**
+   * Update the request to skip the rows already received.
+   *
+   * @return false if there are no more rows to read, i.e., the rows limit
+   *     was reached or all the rows in the row set were received.
+   */
+  bool PrepareRetry();
+
+  /// The number of rows received so far.
+  std::int64_t rows_count() const { return rows_count_; }
+
+ private:
+  /**
+   * Remove the keys and (parts of) ranges that are <= @p key.
+   *
+   * @return false if nothing is left in the row set.
+   */
+  bool Trim(std::string const& key);
+
+  google::bigtable::v2::ReadRowsRequest request_;
+  std::int64_t rows_limit_;
+  std::int64_t rows_count_;
+  std::shared_ptr<std::string const> last_row_key_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_RESUMABLE_REQUEST_H_
@@ -0,0 +1,122 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/resumable_request.h"
+#include "bigtable/client/row_reader.h"
+
+#include <gmock/gmock.h>
+
+using bigtable::Filter;
+using bigtable::Row;
+using bigtable::RowRange;
+using bigtable::RowReader;
+using bigtable::RowSet;
+using bigtable::internal::ResumableRequest;
+
+namespace {
+Row MakeRow(std::string row_key) { return Row(std::move(row_key), {}); }
+
+std::vector<std::string> Keys(ResumableRequest const& request) {
+  auto const& keys = request.request().rows().row_keys();
+  return std::vector<std::string>(keys.begin(), keys.end());
+}
+}  // anonymous namespace
+
+TEST(ResumableRequestTest, BuildsRequest) {
+  ResumableRequest request("table", RowSet("r3", "r1", "r2", "r1"), 10,
+                           Filter::PassAllFilter());
+
+  EXPECT_EQ("table", request.request().table_name());
+  EXPECT_EQ(10, request.request().rows_limit());
+  EXPECT_TRUE(request.request().has_filter());
+  // The keys are sorted and duplicates removed.
+  EXPECT_EQ(std::vector<std::string>({"r1", "r2", "r3"}), Keys(request));
+}
+
+TEST(ResumableRequestTest, RetryWithoutRows) {
+  ResumableRequest request("table", RowSet(), RowReader::NO_ROWS_LIMIT,
+                           Filter::PassAllFilter());
+
+  // Nothing was received, the same "all rows" request is sent again.
+  EXPECT_TRUE(request.PrepareRetry());
+  EXPECT_EQ(0, request.request().rows().row_keys_size());
+  EXPECT_EQ(0, request.request().rows().row_ranges_size());
+  EXPECT_EQ(0, request.request().rows_limit());
+}
+
+TEST(ResumableRequestTest, RetryAllRows) {
+  ResumableRequest request("table", RowSet(), RowReader::NO_ROWS_LIMIT,
+                           Filter::PassAllFilter());
+  request.OnRow(MakeRow("r1"));
+
+  EXPECT_TRUE(request.PrepareRetry());
+  auto const& rows = request.request().rows();
+  ASSERT_EQ(1, rows.row_ranges_size());
+  EXPECT_EQ("r1", rows.row_ranges(0).start_key_open());
+  EXPECT_EQ(1, request.rows_count());
+}
+
+TEST(ResumableRequestTest, RetryTrimsKeys) {
+  ResumableRequest request("table", RowSet("r1", "r2", "r3", "r4"), 10,
+                           Filter::PassAllFilter());
+  request.OnRow(MakeRow("r1"));
+  request.OnRows(1, "r2");
+
+  EXPECT_TRUE(request.PrepareRetry());
+  EXPECT_EQ(std::vector<std::string>({"r3", "r4"}), Keys(request));
+  EXPECT_EQ(8, request.request().rows_limit());
+
+  // The service may skip keys that have no data.
+  request.OnRows(1, "r4");
+  EXPECT_FALSE(request.PrepareRetry());
+}
+
+TEST(ResumableRequestTest, RetryTrimsRanges) {
+  RowSet row_set(RowRange::Range("a", "c"), RowRange::Closed("d", "f"),
+                 RowRange::StartingAt("x"));
+  ResumableRequest request("table", std::move(row_set),
+                           RowReader::NO_ROWS_LIMIT, Filter::PassAllFilter());
+  request.OnRows(3, "e");
+
+  EXPECT_TRUE(request.PrepareRetry());
+  auto const& rows = request.request().rows();
+  ASSERT_EQ(2, rows.row_ranges_size());
+  EXPECT_EQ("e", rows.row_ranges(0).start_key_open());
+  EXPECT_EQ("f", rows.row_ranges(0).end_key_closed());
+  EXPECT_EQ("x", rows.row_ranges(1).start_key_closed());
+
+  request.OnRows(1, "f");
+  EXPECT_TRUE(request.PrepareRetry());
+  ASSERT_EQ(1, rows.row_ranges_size());
+  EXPECT_EQ("x", rows.row_ranges(0).start_key_closed());
+}
+
+TEST(ResumableRequestTest, RetryStopsWhenRangesAreDone) {
+  ResumableRequest request("table", RowSet(RowRange::Closed("a", "c")),
+                           RowReader::NO_ROWS_LIMIT, Filter::PassAllFilter());
+  request.OnRows(2, "c");
+
+  EXPECT_FALSE(request.PrepareRetry());
+}
+
+TEST(ResumableRequestTest, RetryStopsAtRowsLimit) {
+  ResumableRequest request("table", RowSet(), 2, Filter::PassAllFilter());
+  request.OnRow(MakeRow("r1"));
+  EXPECT_TRUE(request.PrepareRetry());
+  EXPECT_EQ(1, request.request().rows_limit());
+
+  request.OnRow(MakeRow("r2"));
+  EXPECT_FALSE(request.PrepareRetry());
+  EXPECT_EQ(2, request.rows_count());
+}
@@ -0,0 +1,101 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/row_batch_parser.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+void RowBatchBuilder::set_batch(RowBatch& batch) {
+  if (batch_ == &batch) {
+    return;
+  }
+  batch_ = &batch;
+  // The ids refer to the dictionaries in the previous batch.
+  family_id_valid_ = false;
+  qualifier_id_valid_ = false;
+}
+
+void RowBatchBuilder::OnFamily(std::string& family) {
+  family_.swap(family);
+  family_id_valid_ = false;
+}
+
+void RowBatchBuilder::OnQualifier(std::string& qualifier) {
+  qualifier_.swap(qualifier);
+  qualifier_id_valid_ = false;
+}
+
+void RowBatchBuilder::OnRowStart(std::string const& row_key) {
+  row_first_cell_ = batch_->cell_count();
+  row_data_start_ = batch_->data_.size();
+  row_key_size_ = row_key.size();
+  batch_->data_.append(row_key);
+}
+
+void RowBatchBuilder::OnCell(std::int64_t timestamp, std::string& value,
+                             std::vector<std::string>& labels) {
+  // Only lookup the ids when the names change, most cells reuse them.
+  if (not family_id_valid_) {
+    family_id_ = RowBatch::FindOrAdd(batch_->family_index_,
+                                     batch_->family_names_, family_);
+    family_id_valid_ = true;
+  }
+  // RowBatch::clear() may discard the qualifiers, and then the id is invalid
+  // too.  Only this builder adds to the dictionary, so it must be empty.
+  if (not qualifier_id_valid_ or
+      qualifier_id_ >= batch_->qualifiers_.size()) {
+    qualifier_id_ = RowBatch::FindOrAdd(batch_->qualifier_index_,
+                                        batch_->qualifiers_, qualifier_);
+    qualifier_id_valid_ = true;
+  }
+  auto const cell = batch_->cell_count();
+  batch_->family_ids_.push_back(family_id_);
+  batch_->qualifier_ids_.push_back(qualifier_id_);
+  batch_->timestamps_.push_back(timestamp);
+  batch_->value_offsets_.push_back(batch_->data_.size());
+  batch_->value_sizes_.push_back(value.size());
+  batch_->data_.append(value);
+  for (auto& label : labels) {
+    batch_->labels_.emplace_back(cell, std::move(label));
+  }
+}
+
+void RowBatchBuilder::OnRowCommit() {
+  batch_->row_key_offsets_.push_back(row_data_start_);
+  batch_->row_key_sizes_.push_back(row_key_size_);
+  batch_->row_cell_offsets_.push_back(batch_->cell_count());
+}
+
+void RowBatchBuilder::OnRowReset() {
+  batch_->Truncate(row_first_cell_, row_data_start_);
+}
+
+void RowBatchParser::Consume(
+    google::bigtable::v2::ReadRowsResponse_CellChunk& chunk,
+    RowBatch& batch) {
+  builder_.set_batch(batch);
+  chunks_.Consume(chunk, builder_);
+}
+
+void RowBatchParser::DiscardPartialRow(RowBatch& batch) {
+  if (chunks_.row_in_progress()) {
+    builder_.set_batch(batch);
+    builder_.OnRowReset();
+  }
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
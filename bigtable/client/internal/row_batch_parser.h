@@ -0,0 +1,130 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_BATCH_PARSER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_BATCH_PARSER_H_
+
+#include "bigtable/client/internal/chunk_parser.h"
+#include "bigtable/client/row_batch.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * Appends the contents of the chunks to a `RowBatch`.
+ *
+ * This is the `Handler` for `ChunkParser` used by `RowBatchParser`.
+ */
+class RowBatchBuilder {
+ public:
+  RowBatchBuilder()
+      : batch_(nullptr),
+        family_id_(0),
+        qualifier_id_(0),
+        family_id_valid_(false),
+        qualifier_id_valid_(false),
+        row_first_cell_(0),
+        row_data_start_(0),
+        row_key_size_(0) {}
+
+  /// Set the batch receiving the data.
+  void set_batch(RowBatch& batch);
+
+  void OnFamily(std::string& family);
+  void OnQualifier(std::string& qualifier);
+  void OnRowStart(std::string const& row_key);
+  void OnCell(std::int64_t timestamp, std::string& value,
+              std::vector<std::string>& labels);
+  // Values are always copied into the batch data.
+  bool OnValueStart(std::int64_t, std::size_t, std::vector<std::string>&) {
+    return false;
+  }
+  void OnValueChunk(std::string&) {}
+  void OnValueEnd() {}
+  void OnRowCommit();
+  void OnRowReset();
+
+ private:
+  RowBatch* batch_;
+  /// The current family and qualifier, needed if the batch changes.
+  std::string family_;
+  std::string qualifier_;
+  std::uint32_t family_id_;
+  std::uint32_t qualifier_id_;
+  bool family_id_valid_;
+  bool qualifier_id_valid_;
+  /// Where the current row starts in the batch, to commit or reset it.
+  std::size_t row_first_cell_;
+  std::size_t row_data_start_;
+  std::size_t row_key_size_;
+};
+
+/**
+ * Parse the chunks in a ReadRows stream into `RowBatch` objects.
+ *
+ * Uses the same validation rules as `ReadRowsParser`, but the data is
+ * appended directly to a `RowBatch`, without creating `Row` or `Cell`
+ * objects.  Only committed rows are visible in the batch, the cells of the
+ * row in progress are stored after them.
+ *
+ * A single parser should be used for each stream of ReadRows responses.
+ */
+class RowBatchParser {
+ public:
+  RowBatchParser() = default;
+
+  /**
+   * Parse @p chunk, appending any data to @p batch.
+   *
+   * The caller must use the same batch until the row in progress (if any)
+   * is committed.
+   *
+   * @throws ParserError if validation failed.
+   */
+  void Consume(google::bigtable::v2::ReadRowsResponse_CellChunk& chunk,
+               RowBatch& batch);
+
+  /**
+   * Signal that the input stream reached the end.
+   *
+   * @throws ParserError if more data was expected to finish
+   * the current row.
+   */
+  void HandleEndOfStream() { chunks_.HandleEndOfStream(); }
+
+  /// True if there is data for an uncommitted row in the batch.
+  bool row_in_progress() const { return chunks_.row_in_progress(); }
+
+  /// Remove the data for the uncommitted row (if any) from @p batch.
+  void DiscardPartialRow(RowBatch& batch);
+
+  /// Limit the size of a row, larger rows are rejected as invalid data.
+  void set_max_row_bytes(std::size_t n) { chunks_.set_max_row_bytes(n); }
+
+  /// The number of bytes received so far for the row in progress.
+  std::size_t partial_row_bytes() const { return chunks_.row_bytes(); }
+
+  /// Enable or disable the row key order checks, see `ChunkParser`.
+  void set_validate_row_keys(bool v) { chunks_.set_validate_row_keys(v); }
+
+ private:
+  ChunkParser<RowBatchBuilder> chunks_;
+  RowBatchBuilder builder_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_BATCH_PARSER_H_
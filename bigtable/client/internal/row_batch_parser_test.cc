@@ -0,0 +1,271 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/row_batch_parser.h"
+
+#include <google/protobuf/text_format.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+
+using bigtable::RowBatch;
+using bigtable::internal::RowBatchParser;
+using google::bigtable::v2::ReadRowsResponse_CellChunk;
+
+namespace {
+std::vector<ReadRowsResponse_CellChunk> ConvertChunks(
+    std::vector<std::string> const& chunk_strings) {
+  std::vector<ReadRowsResponse_CellChunk> chunks;
+  for (auto const& chunk_string : chunk_strings) {
+    ReadRowsResponse_CellChunk chunk;
+    EXPECT_TRUE(
+        google::protobuf::TextFormat::ParseFromString(chunk_string, &chunk));
+    chunks.emplace_back(std::move(chunk));
+  }
+  return chunks;
+}
+}  // anonymous namespace
+
+/// @test Verify that rows and cells are stored in columnar format.
+TEST(RowBatchParserTest, ColumnarLayout) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK1"
+         family_name: < value: "F1">
+         qualifier: < value: "C1">
+         timestamp_micros: 10
+         value: "V1")",
+      R"(qualifier: < value: "C2">
+         timestamp_micros: 20
+         value: "V2"
+         commit_row: true)",
+      R"(row_key: "RK2"
+         family_name: < value: "F2">
+         qualifier: < value: "C1">
+         timestamp_micros: 30
+         value: "V3"
+         labels: "L"
+         commit_row: true)",
+  });
+
+  RowBatchParser parser;
+  RowBatch batch;
+  for (auto& chunk : chunks) {
+    parser.Consume(chunk, batch);
+  }
+  parser.HandleEndOfStream();
+
+  ASSERT_EQ(2U, batch.row_count());
+  ASSERT_EQ(3U, batch.cell_count());
+  EXPECT_EQ("RK1", batch.row_key(0));
+  EXPECT_EQ("RK2", batch.row_key(1));
+  EXPECT_EQ((std::vector<std::size_t>{0, 2, 3}), batch.row_cell_offsets());
+  EXPECT_EQ((std::vector<std::string>{"F1", "F2"}), batch.family_names());
+  EXPECT_EQ((std::vector<std::string>{"C1", "C2"}), batch.qualifiers());
+  EXPECT_EQ((std::vector<std::uint32_t>{0, 0, 1}), batch.family_ids());
+  EXPECT_EQ((std::vector<std::uint32_t>{0, 1, 0}), batch.qualifier_ids());
+  EXPECT_EQ((std::vector<std::int64_t>{10, 20, 30}), batch.timestamps());
+  EXPECT_EQ("V1", batch.value(0));
+  EXPECT_EQ("V2", batch.value(1));
+  EXPECT_EQ("V3", batch.value(2));
+  // All the data is in a single buffer.
+  EXPECT_EQ("RK1V1V2RK2V3", batch.data());
+  ASSERT_EQ(1U, batch.labels().size());
+  EXPECT_EQ(2U, batch.labels()[0].first);
+  EXPECT_EQ("L", batch.labels()[0].second);
+}
+
+/// @test Verify that values split across chunks are concatenated.
+TEST(RowBatchParserTest, SplitValue) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "abc"
+         value_size: 6)",
+      R"(value: "def"
+         commit_row: true)",
+  });
+
+  RowBatchParser parser;
+  RowBatch batch;
+  for (auto& chunk : chunks) {
+    parser.Consume(chunk, batch);
+  }
+  ASSERT_EQ(1U, batch.cell_count());
+  EXPECT_EQ("abcdef", batch.value(0));
+}
+
+/// @test Verify that reset rows are removed from the batch.
+TEST(RowBatchParserTest, ResetRow) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK1"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V1"
+         commit_row: true)",
+      R"(row_key: "RK2"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V2"
+         labels: "L")",
+      R"(reset_row: true)",
+      R"(row_key: "RK2"
+         family_name: < value: "F">
+         qualifier: < value: "D">
+         value: "V3"
+         commit_row: true)",
+  });
+
+  RowBatchParser parser;
+  RowBatch batch;
+  for (auto& chunk : chunks) {
+    parser.Consume(chunk, batch);
+  }
+  parser.HandleEndOfStream();
+  ASSERT_EQ(2U, batch.row_count());
+  ASSERT_EQ(2U, batch.cell_count());
+  EXPECT_EQ("RK1V1RK2V3", batch.data());
+  EXPECT_EQ("D", batch.qualifiers()[batch.qualifier_ids()[1]]);
+  EXPECT_TRUE(batch.labels().empty());
+}
+
+/// @test Verify that partial rows can be discarded, e.g. before a retry.
+TEST(RowBatchParserTest, DiscardPartialRow) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK1"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V1"
+         commit_row: true)",
+      R"(row_key: "RK2"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V2")",
+  });
+
+  RowBatchParser parser;
+  RowBatch batch;
+  for (auto& chunk : chunks) {
+    parser.Consume(chunk, batch);
+  }
+  EXPECT_TRUE(parser.row_in_progress());
+  ASSERT_EQ(1U, batch.row_count());
+  EXPECT_EQ(2U, batch.cell_count());
+
+  parser.DiscardPartialRow(batch);
+  EXPECT_EQ(1U, batch.row_count());
+  EXPECT_EQ(1U, batch.cell_count());
+  EXPECT_EQ("RK1V1", batch.data());
+}
+
+/// @test Verify that clear() keeps the ids, and new batches get valid ids.
+TEST(RowBatchParserTest, IdsAreStable) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK1"
+         family_name: < value: "F1">
+         qualifier: < value: "C1">
+         value: "V1"
+         commit_row: true)",
+      R"(row_key: "RK2"
+         value: "V2"
+         commit_row: true)",
+      R"(row_key: "RK3"
+         family_name: < value: "F2">
+         qualifier: < value: "C2">
+         value: "V3"
+         commit_row: true)",
+  });
+
+  RowBatchParser parser;
+  RowBatch batch;
+  parser.Consume(chunks[0], batch);
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(0U, batch.cell_count());
+  EXPECT_EQ(std::vector<std::size_t>{0}, batch.row_cell_offsets());
+
+  // A new batch gets its own dictionary, even when the names in the stream
+  // do not change.
+  RowBatch other;
+  parser.Consume(chunks[1], other);
+  ASSERT_EQ(1U, other.cell_count());
+  EXPECT_EQ("F1", other.family_names()[other.family_ids()[0]]);
+  EXPECT_EQ("C1", other.qualifiers()[other.qualifier_ids()[0]]);
+
+  parser.Consume(chunks[2], batch);
+  ASSERT_EQ(1U, batch.cell_count());
+  EXPECT_EQ(1U, batch.family_ids()[0]);
+  EXPECT_EQ((std::vector<std::string>{"F1", "F2"}), batch.family_names());
+}
+
+/// @test Verify that clear() discards the qualifiers when there are too many.
+TEST(RowBatchParserTest, QualifierDictionaryIsBounded) {
+  RowBatchParser parser;
+  RowBatch batch;
+  int const qualifier_count = 2000;
+  for (int i = 0; i != qualifier_count; ++i) {
+    char row_key[16];
+    std::snprintf(row_key, sizeof(row_key), "RK%06d", i);
+    ReadRowsResponse_CellChunk chunk;
+    chunk.set_row_key(row_key);
+    chunk.mutable_family_name()->set_value("F");
+    chunk.mutable_qualifier()->set_value("C" + std::to_string(i));
+    chunk.set_value("V");
+    chunk.set_commit_row(true);
+    parser.Consume(chunk, batch);
+  }
+  EXPECT_EQ(std::size_t(qualifier_count), batch.qualifiers().size());
+  batch.clear();
+  EXPECT_TRUE(batch.qualifiers().empty());
+  EXPECT_EQ(1U, batch.family_names().size());
+
+  // This row reuses the last qualifier, its id must be valid in the new
+  // dictionary.
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK999999"
+         value: "V"
+         commit_row: true)",
+  });
+  parser.Consume(chunks[0], batch);
+  ASSERT_EQ(1U, batch.cell_count());
+  EXPECT_EQ(std::vector<std::uint32_t>{0}, batch.qualifier_ids());
+  EXPECT_EQ(std::vector<std::string>{"C1999"}, batch.qualifiers());
+
+  // A small dictionary is preserved.
+  batch.clear();
+  EXPECT_EQ(std::vector<std::string>{"C1999"}, batch.qualifiers());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that the parser uses the same validation as ReadRowsParser.
+TEST(RowBatchParserTest, InvalidChunks) {
+  auto chunks = ConvertChunks({
+      R"(row_key: "RK2"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V1"
+         commit_row: true)",
+      R"(row_key: "RK1"
+         family_name: < value: "F">
+         qualifier: < value: "C">
+         value: "V2"
+         commit_row: true)",
+  });
+
+  RowBatchParser parser;
+  parser.set_validate_row_keys(true);
+  RowBatch batch;
+  parser.Consume(chunks[0], batch);
+  EXPECT_THROW(parser.Consume(chunks[1], batch), std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,156 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/row_cache.h"
+#include <algorithm>
+#include <functional>
+#include "bigtable/client/internal/make_unique.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+RowCache::RowCache(RowCacheOptions const& options)
+    : shard_max_bytes_(std::max<std::size_t>(
+          1, options.max_bytes() / options.shard_count())),
+      ttl_(options.ttl()) {
+  shards_.reserve(options.shard_count());
+  for (std::size_t i = 0; i != options.shard_count(); ++i) {
+    shards_.emplace_back(make_unique<Shard>());
+  }
+}
+
+bool RowCache::Lookup(std::string const& row_key,
+                      std::string const& filter_key, Value& value,
+                      Ticket& ticket) {
+  auto& shard = ShardFor(row_key, ticket.shard);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  ticket.generation = shard.generation;
+  auto i = shard.index.find(row_key);
+  if (i != shard.index.end()) {
+    for (auto it : i->second) {
+      if (it->filter_key != filter_key) {
+        continue;
+      }
+      if (it->expiration <= Clock::now()) {
+        ++shard.expirations;
+        Erase(shard, it);
+        break;
+      }
+      ++shard.hits;
+      shard.lru.splice(shard.lru.begin(), shard.lru, it);
+      value = it->value;
+      return true;
+    }
+  }
+  ++shard.misses;
+  return false;
+}
+
+void RowCache::Insert(std::string const& row_key, std::string filter_key,
+                      Value value, Ticket const& ticket) {
+  auto const bytes = EstimatedSize(row_key, filter_key, value);
+  if (bytes > shard_max_bytes_) {
+    return;
+  }
+  auto& shard = *shards_[ticket.shard];
+  std::lock_guard<std::mutex> lk(shard.mu);
+  if (shard.generation != ticket.generation) {
+    // A mutation may have changed the row after it was read.
+    return;
+  }
+  auto& entries = shard.index[row_key];
+  for (auto it : entries) {
+    if (it->filter_key == filter_key) {
+      // Another thread read the same row concurrently, keep its entry.
+      return;
+    }
+  }
+  shard.lru.push_front(Entry{row_key, std::move(filter_key), std::move(value),
+                             Clock::now() + ttl_, bytes});
+  entries.push_back(shard.lru.begin());
+  shard.bytes += bytes;
+
+  while (shard.bytes > shard_max_bytes_) {
+    ++shard.evictions;
+    Erase(shard, std::prev(shard.lru.end()));
+  }
+}
+
+void RowCache::Invalidate(std::string const& row_key) {
+  std::size_t index;
+  auto& shard = ShardFor(row_key, index);
+  std::lock_guard<std::mutex> lk(shard.mu);
+  ++shard.generation;
+  auto i = shard.index.find(row_key);
+  if (i == shard.index.end()) {
+    return;
+  }
+  auto entries = std::move(i->second);
+  shard.index.erase(i);
+  for (auto it : entries) {
+    ++shard.invalidations;
+    shard.bytes -= it->bytes;
+    shard.lru.erase(it);
+  }
+}
+
+RowCacheStats RowCache::Stats() const {
+  RowCacheStats stats{0, 0, 0, 0, 0, 0, 0};
+  for (auto const& s : shards_) {
+    std::lock_guard<std::mutex> lk(s->mu);
+    stats.hits += s->hits;
+    stats.misses += s->misses;
+    stats.evictions += s->evictions;
+    stats.invalidations += s->invalidations;
+    stats.expirations += s->expirations;
+    stats.bytes += s->bytes;
+    stats.entries += s->lru.size();
+  }
+  return stats;
+}
+
+RowCache::Shard& RowCache::ShardFor(std::string const& row_key,
+                                    std::size_t& index) {
+  index = std::hash<std::string>()(row_key) % shards_.size();
+  return *shards_[index];
+}
+
+void RowCache::Erase(Shard& shard, EntryList::iterator it) {
+  auto i = shard.index.find(it->row_key);
+  if (i != shard.index.end()) {
+    auto& entries = i->second;
+    entries.erase(std::find(entries.begin(), entries.end(), it));
+    if (entries.empty()) {
+      shard.index.erase(i);
+    }
+  }
+  shard.bytes -= it->bytes;
+  shard.lru.erase(it);
+}
+
+std::size_t RowCache::EstimatedSize(std::string const& row_key,
+                                    std::string const& filter_key,
+                                    Value const& value) {
+  // Count the keys twice, they are also stored in the index.
+  std::size_t size = sizeof(Entry) + 2 * row_key.size() + filter_key.size();
+  for (auto const& cell : value.second.cells()) {
+    size += sizeof(Cell) + cell.family_name().size() +
+            cell.column_qualifier().size() + cell.value().size();
+  }
+  return size;
+}
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,132 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_CACHE_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_CACHE_H_
+
+#include "bigtable/client/row.h"
+#include "bigtable/client/row_cache_options.h"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+/**
+ * A sharded LRU cache for the results of `Table::ReadRow()`.
+ *
+ * The entries are keyed by the row key and the serialized filter, and the
+ * "row not found" results are cached too.  All the entries for a row key
+ * live in the same shard, so `Invalidate()` only locks one shard.
+ *
+ * To avoid caching stale data, a read that misses the cache obtains a
+ * `Ticket`, and `Insert()` discards the result if the shard was invalidated
+ * after the ticket was issued, i.e., if a mutation may have raced with the
+ * read.
+ */
+class RowCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using Value = std::pair<bool, Row>;
+
+  /// Identifies the state of a shard when a lookup missed.
+  struct Ticket {
+    std::size_t shard;
+    std::uint64_t generation;
+  };
+
+  explicit RowCache(RowCacheOptions const& options);
+
+  /**
+   * Find the cached result for @p row_key and @p filter_key.
+   *
+   * @return true on a hit, in which case @p value has a copy of the result.
+   *     On a miss @p ticket must be passed to the `Insert()` call that
+   *     stores the result.
+   */
+  bool Lookup(std::string const& row_key, std::string const& filter_key,
+              Value& value, Ticket& ticket);
+
+  /// Store the result of a read, unless it may be stale.
+  void Insert(std::string const& row_key, std::string filter_key,
+              Value value, Ticket const& ticket);
+
+  /// Remove all the entries for @p row_key.
+  void Invalidate(std::string const& row_key);
+
+  /// Return the counters, added over all the shards.
+  RowCacheStats Stats() const;
+
+ private:
+  struct Entry {
+    std::string row_key;
+    std::string filter_key;
+    Value value;
+    Clock::time_point expiration;
+    std::size_t bytes;
+  };
+  using EntryList = std::list<Entry>;
+
+  struct Shard {
+    Shard()
+        : bytes(0),
+          generation(0),
+          hits(0),
+          misses(0),
+          evictions(0),
+          invalidations(0),
+          expirations(0) {}
+
+    mutable std::mutex mu;
+    /// The entries, the most recently used first.
+    EntryList lru;
+    /// The entries for each row key, usually one per filter in use.
+    std::unordered_map<std::string, std::vector<EntryList::iterator>> index;
+    std::size_t bytes;
+    /// Incremented by each invalidation.
+    std::uint64_t generation;
+    std::int64_t hits;
+    std::int64_t misses;
+    std::int64_t evictions;
+    std::int64_t invalidations;
+    std::int64_t expirations;
+  };
+
+  Shard& ShardFor(std::string const& row_key, std::size_t& index);
+
+  /// Remove @p it from @p shard, must be called with the shard lock held.
+  static void Erase(Shard& shard, EntryList::iterator it);
+
+  /// Estimate the memory used by an entry.
+  static std::size_t EstimatedSize(std::string const& row_key,
+                                   std::string const& filter_key,
+                                   Value const& value);
+
+  std::size_t shard_max_bytes_;
+  Clock::duration ttl_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace internal
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_INTERNAL_ROW_CACHE_H_
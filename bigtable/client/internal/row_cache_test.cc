@@ -0,0 +1,134 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/internal/row_cache.h"
+
+#include <gmock/gmock.h>
+
+using bigtable::Cell;
+using bigtable::Row;
+using bigtable::RowCacheOptions;
+using bigtable::internal::RowCache;
+
+namespace {
+RowCache::Value Found(std::string row_key, std::string value = "value") {
+  std::vector<Cell> cells;
+  cells.emplace_back(Cell(row_key, "fam", "col", 0, std::move(value), {}));
+  return RowCache::Value(true, Row(std::move(row_key), std::move(cells)));
+}
+
+RowCache::Value NotFound() { return RowCache::Value(false, Row("", {})); }
+}  // anonymous namespace
+
+TEST(RowCacheTest, HitAndMiss) {
+  RowCache cache(RowCacheOptions().set_shard_count(4));
+  RowCache::Value value = NotFound();
+  RowCache::Ticket ticket;
+
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+  cache.Insert("r1", "f1", Found("r1"), ticket);
+  EXPECT_FALSE(cache.Lookup("missing", "f1", value, ticket));
+  cache.Insert("missing", "f1", NotFound(), ticket);
+
+  EXPECT_TRUE(cache.Lookup("r1", "f1", value, ticket));
+  EXPECT_TRUE(value.first);
+  EXPECT_EQ("r1", value.second.row_key());
+  ASSERT_EQ(1U, value.second.cells().size());
+  EXPECT_EQ("value", value.second.cells()[0].value());
+
+  // The negative results are cached too.
+  EXPECT_TRUE(cache.Lookup("missing", "f1", value, ticket));
+  EXPECT_FALSE(value.first);
+
+  // The filter is part of the key.
+  EXPECT_FALSE(cache.Lookup("r1", "f2", value, ticket));
+
+  auto stats = cache.Stats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(3, stats.misses);
+  EXPECT_EQ(2U, stats.entries);
+  EXPECT_LT(0U, stats.bytes);
+}
+
+TEST(RowCacheTest, Invalidate) {
+  RowCache cache{RowCacheOptions()};
+  RowCache::Value value = NotFound();
+  RowCache::Ticket ticket;
+
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+  cache.Insert("r1", "f1", Found("r1"), ticket);
+  EXPECT_FALSE(cache.Lookup("r1", "f2", value, ticket));
+  cache.Insert("r1", "f2", Found("r1"), ticket);
+
+  cache.Invalidate("r1");
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+  EXPECT_FALSE(cache.Lookup("r1", "f2", value, ticket));
+  auto stats = cache.Stats();
+  EXPECT_EQ(2, stats.invalidations);
+  EXPECT_EQ(0U, stats.entries);
+  EXPECT_EQ(0U, stats.bytes);
+}
+
+TEST(RowCacheTest, StaleInsertIsDiscarded) {
+  RowCache cache{RowCacheOptions()};
+  RowCache::Value value = NotFound();
+  RowCache::Ticket ticket;
+
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+  // A mutation completes while the row is being read.
+  cache.Invalidate("r1");
+  cache.Insert("r1", "f1", Found("r1", "old"), ticket);
+
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+}
+
+TEST(RowCacheTest, Expiration) {
+  RowCache cache(RowCacheOptions().set_ttl(std::chrono::milliseconds(0)));
+  RowCache::Value value = NotFound();
+  RowCache::Ticket ticket;
+
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+  cache.Insert("r1", "f1", Found("r1"), ticket);
+  EXPECT_FALSE(cache.Lookup("r1", "f1", value, ticket));
+
+  auto stats = cache.Stats();
+  EXPECT_EQ(1, stats.expirations);
+  EXPECT_EQ(0U, stats.entries);
+}
+
+TEST(RowCacheTest, EvictsLeastRecentlyUsed) {
+  std::string const large(1000, 'x');
+  // A single shard with room for two rows.
+  RowCache cache(
+      RowCacheOptions().set_shard_count(1).set_max_bytes(2 * large.size() +
+                                                         1000));
+  RowCache::Value value = NotFound();
+  RowCache::Ticket ticket;
+
+  for (auto const& key : {"r1", "r2"}) {
+    EXPECT_FALSE(cache.Lookup(key, "f", value, ticket));
+    cache.Insert(key, "f", Found(key, large), ticket);
+  }
+  // Use r1, so r2 is evicted.
+  EXPECT_TRUE(cache.Lookup("r1", "f", value, ticket));
+  EXPECT_FALSE(cache.Lookup("r3", "f", value, ticket));
+  cache.Insert("r3", "f", Found("r3", large), ticket);
+
+  EXPECT_TRUE(cache.Lookup("r1", "f", value, ticket));
+  EXPECT_TRUE(cache.Lookup("r3", "f", value, ticket));
+  EXPECT_FALSE(cache.Lookup("r2", "f", value, ticket));
+  auto stats = cache.Stats();
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(2U, stats.entries);
+}
@@ -60,6 +60,14 @@ namespace internal {
   RaiseException<std::runtime_error>(msg.c_str());
 }
 
+[[noreturn]] void RaiseParserError(char const *msg) {
+  RaiseException<ParserError>(msg);
+}
+
+[[noreturn]] void RaiseParserError(std::string const &msg) {
+  RaiseException<ParserError>(msg.c_str());
+}
+
 [[noreturn]] void RaiseLogicError(char const *msg) {
   RaiseException<std::logic_error>(msg);
 }
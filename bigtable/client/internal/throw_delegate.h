@@ -17,11 +17,24 @@
 
 #include <grpc++/grpc++.h>
 #include "bigtable/client/version.h"
+#include <stdexcept>
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
 namespace internal {
 
+/**
+ * The exception raised when a ReadRows response fails validation.
+ *
+ * The row readers convert these (and only these) exceptions into a status, so
+ * exceptions raised by application callbacks, such as a `CellVisitor`, reach
+ * the application unchanged.
+ */
+class ParserError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
 //@{
 /**
  * @name Delete exception raising to hidden functions.
@@ -42,6 +55,9 @@ namespace internal {
 [[noreturn]] void RaiseRuntimeError(char const* msg);
 [[noreturn]] void RaiseRuntimeError(std::string const& msg);
 
+[[noreturn]] void RaiseParserError(char const* msg);
+[[noreturn]] void RaiseParserError(std::string const& msg);
+
 [[noreturn]] void RaiseLogicError(char const* msg);
 [[noreturn]] void RaiseLogicError(std::string const& msg);
 
@@ -0,0 +1,337 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/mutation_batcher.h"
+
+#include <grpc++/alarm.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace btproto = ::google::bigtable::v2;
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/// Convert the failures in a batch of @p count mutations to their statuses.
+std::vector<grpc::Status> ToStatuses(
+    std::size_t count, std::vector<FailedMutation> const& failures) {
+  std::vector<grpc::Status> results(count);
+  for (auto const& failure : failures) {
+    auto index = failure.original_index();
+    if (index < 0 or static_cast<std::size_t>(index) >= results.size()) {
+      continue;
+    }
+    // The failures with an OK status are mutations that were not retried
+    // (or whose retries were exhausted), their result is unknown.
+    results[index] = failure.rpc_status().code() == grpc::StatusCode::OK
+                         ? grpc::Status(grpc::StatusCode::UNKNOWN,
+                                        "the result of the mutation is unknown")
+                         : failure.status();
+  }
+  return results;
+}
+}  // anonymous namespace
+
+class MutationBatcher::Impl : public std::enable_shared_from_this<Impl> {
+ public:
+  Impl(Table& table, CompletionQueue& cq, MutationBatcherOptions options)
+      : table_(table),
+        cq_(cq),
+        options_(std::move(options)),
+        batch_id_(0),
+        timer_(nullptr),
+        requests_in_flight_(0),
+        outstanding_bytes_(0),
+        outstanding_mutations_(0) {}
+
+  void Push(SingleRowMutation mut, Callback callback);
+  void Flush();
+  void WaitForCompletion();
+
+ private:
+  /// Flush a partially filled batch once its flush period expires.
+  class FlushTimer : public internal::AsyncOperation {
+   public:
+    FlushTimer(std::shared_ptr<Impl> impl, std::uint64_t batch_id)
+        : impl_(std::move(impl)), batch_id_(batch_id) {}
+
+    bool Notify(CompletionQueue&, bool ok) override {
+      impl_->OnTimer(this, batch_id_, ok);
+      return true;
+    }
+
+    grpc::Alarm alarm;
+
+   private:
+    std::shared_ptr<Impl> impl_;
+    std::uint64_t batch_id_;
+  };
+
+  /// A group of mutations sent in a single request.
+  struct Batch {
+    Batch() : bytes(0) {}
+
+    BulkMutation mutations;
+    std::vector<Callback> callbacks;
+    std::size_t bytes;
+  };
+
+  /// Close the current batch, must be called with `mu_` held.
+  void CloseBatch();
+
+  /// Start the flush timer for the current batch, requires `mu_`.
+  void StartTimer();
+
+  /// Remove the batches that can be sent now, must be called with `mu_` held.
+  std::vector<Batch> TakeReadyBatches();
+
+  /**
+   * Start the requests for @p batches, must be called without `mu_`.
+   *
+   * If the completion queue is shutdown the batches are canceled instead.
+   */
+  void Send(std::vector<Batch> batches);
+
+  /// Fail all the mutations in @p batches, must be called without `mu_`.
+  void Cancel(std::vector<Batch> batches);
+
+  /// Handle an expired (or canceled) flush timer.
+  void OnTimer(FlushTimer* timer, std::uint64_t batch_id, bool ok);
+
+  /// Handle a completed request, @p results has the status of each mutation.
+  void OnCompletion(std::vector<Callback> const& callbacks, std::size_t bytes,
+                    std::vector<grpc::Status> const& results);
+
+  Table& table_;
+  CompletionQueue& cq_;
+  MutationBatcherOptions const options_;
+
+  std::mutex mu_;
+  /// Signaled when outstanding bytes or mutations are released.
+  std::condition_variable cv_;
+  /// The batch receiving new mutations.
+  Batch current_;
+  /// Incremented each time `current_` is closed, used to detect stale timers.
+  std::uint64_t batch_id_;
+  /// The timer for `current_`, if any.
+  FlushTimer* timer_;
+  /// The closed batches waiting for a request slot.
+  std::deque<Batch> ready_;
+  std::size_t requests_in_flight_;
+  std::size_t outstanding_bytes_;
+  std::size_t outstanding_mutations_;
+};
+
+void MutationBatcher::Impl::Push(SingleRowMutation mut, Callback callback) {
+  // Compute the size outside the critical section, the mutation is moved
+  // (not copied) into the batch.
+  btproto::MutateRowsRequest::Entry entry;
+  mut.MoveTo(&entry);
+  auto const bytes = static_cast<std::size_t>(entry.ByteSizeLong());
+
+  std::unique_lock<std::mutex> lk(mu_);
+  while (outstanding_bytes_ != 0 and
+         outstanding_bytes_ + bytes > options_.max_outstanding_bytes()) {
+    // Do not wait for the flush timer, the current batch can only be released
+    // once it is sent.
+    if (not current_.callbacks.empty()) {
+      CloseBatch();
+    }
+    auto ready = TakeReadyBatches();
+    if (ready.empty()) {
+      cv_.wait(lk);
+      continue;
+    }
+    lk.unlock();
+    Send(std::move(ready));
+    lk.lock();
+  }
+
+  if (not current_.callbacks.empty() and
+      current_.bytes + bytes > options_.max_batch_bytes()) {
+    CloseBatch();
+  }
+  bool const is_first = current_.callbacks.empty();
+  current_.mutations.emplace_back(SingleRowMutation(std::move(entry)));
+  current_.callbacks.push_back(std::move(callback));
+  current_.bytes += bytes;
+  outstanding_bytes_ += bytes;
+  ++outstanding_mutations_;
+
+  if (current_.callbacks.size() >= options_.max_batch_size() or
+      current_.bytes >= options_.max_batch_bytes()) {
+    CloseBatch();
+  } else if (is_first) {
+    StartTimer();
+  }
+  auto ready = TakeReadyBatches();
+  lk.unlock();
+  Send(std::move(ready));
+}
+
+void MutationBatcher::Impl::Flush() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (not current_.callbacks.empty()) {
+    CloseBatch();
+  }
+  auto ready = TakeReadyBatches();
+  lk.unlock();
+  Send(std::move(ready));
+}
+
+void MutationBatcher::Impl::WaitForCompletion() {
+  Flush();
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return outstanding_mutations_ == 0; });
+}
+
+void MutationBatcher::Impl::CloseBatch() {
+  ready_.push_back(std::move(current_));
+  current_ = Batch();
+  ++batch_id_;
+  if (timer_ != nullptr) {
+    // The timer is still owned by the completion queue, it is deleted once the
+    // cancellation is delivered.
+    timer_->alarm.Cancel();
+    timer_ = nullptr;
+  }
+}
+
+void MutationBatcher::Impl::StartTimer() {
+  auto timer = new FlushTimer(shared_from_this(), batch_id_);
+  timer_ = timer;
+  timer->alarm.Set(&cq_.cq(),
+                   std::chrono::system_clock::now() + options_.flush_period(),
+                   timer);
+}
+
+std::vector<MutationBatcher::Impl::Batch>
+MutationBatcher::Impl::TakeReadyBatches() {
+  std::vector<Batch> result;
+  while (not ready_.empty() and
+         requests_in_flight_ < options_.max_outstanding_requests()) {
+    result.push_back(std::move(ready_.front()));
+    ready_.pop_front();
+    ++requests_in_flight_;
+  }
+  return result;
+}
+
+void MutationBatcher::Impl::Send(std::vector<Batch> batches) {
+  if (batches.empty()) {
+    return;
+  }
+  auto self = shared_from_this();
+  std::vector<Batch> canceled;
+  for (auto& batch : batches) {
+    auto callbacks = std::make_shared<std::vector<Callback>>();
+    auto bytes = batch.bytes;
+    bool const started = cq_.StartUnlessShutdown([&] {
+      callbacks->swap(batch.callbacks);
+      table_.AsyncBulkApply(
+          cq_, std::move(batch.mutations),
+          [self, callbacks, bytes](std::vector<FailedMutation> failures) {
+            self->OnCompletion(*callbacks, bytes,
+                               ToStatuses(callbacks->size(), failures));
+          });
+    });
+    if (not started) {
+      canceled.push_back(std::move(batch));
+    }
+  }
+  Cancel(std::move(canceled));
+}
+
+void MutationBatcher::Impl::Cancel(std::vector<Batch> batches) {
+  for (auto& batch : batches) {
+    std::vector<grpc::Status> results(
+        batch.callbacks.size(),
+        grpc::Status(grpc::StatusCode::CANCELLED,
+                     "the completion queue was shutdown"));
+    OnCompletion(batch.callbacks, batch.bytes, results);
+  }
+}
+
+void MutationBatcher::Impl::OnTimer(FlushTimer* timer, std::uint64_t batch_id,
+                                    bool ok) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (timer_ == timer) {
+    timer_ = nullptr;
+  }
+  if (batch_id != batch_id_ or current_.callbacks.empty()) {
+    // The batch was closed before the timer expired.
+    return;
+  }
+  CloseBatch();
+  auto ready = TakeReadyBatches();
+  lk.unlock();
+  if (not ok) {
+    // The timer was canceled by the completion queue, do not start new
+    // requests on it.
+    Cancel(std::move(ready));
+    return;
+  }
+  Send(std::move(ready));
+}
+
+void MutationBatcher::Impl::OnCompletion(
+    std::vector<Callback> const& callbacks, std::size_t bytes,
+    std::vector<grpc::Status> const& results) {
+  std::unique_lock<std::mutex> lk(mu_);
+  --requests_in_flight_;
+  outstanding_bytes_ -= bytes;
+  auto ready = TakeReadyBatches();
+  lk.unlock();
+  cv_.notify_all();
+  Send(std::move(ready));
+
+  for (std::size_t i = 0; i != callbacks.size(); ++i) {
+    callbacks[i](results[i]);
+  }
+
+  // Only release the mutations after their callbacks run, so
+  // WaitForCompletion() can guarantee that all the callbacks were invoked.
+  lk.lock();
+  outstanding_mutations_ -= callbacks.size();
+  lk.unlock();
+  cv_.notify_all();
+}
+
+MutationBatcher::MutationBatcher(Table& table, CompletionQueue& cq,
+                                 MutationBatcherOptions options)
+    : impl_(std::make_shared<Impl>(table, cq, std::move(options))) {}
+
+MutationBatcher::~MutationBatcher() { impl_->WaitForCompletion(); }
+
+void MutationBatcher::Push(SingleRowMutation mut, Callback callback) {
+  impl_->Push(std::move(mut), std::move(callback));
+}
+
+std::future<grpc::Status> MutationBatcher::Push(SingleRowMutation mut) {
+  auto promise = std::make_shared<std::promise<grpc::Status>>();
+  auto result = promise->get_future();
+  impl_->Push(std::move(mut), [promise](grpc::Status const& status) {
+    promise->set_value(status);
+  });
+  return result;
+}
+
+void MutationBatcher::Flush() { impl_->Flush(); }
+
+void MutationBatcher::WaitForCompletion() { impl_->WaitForCompletion(); }
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,121 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_H_
+
+#include "bigtable/client/completion_queue.h"
+#include "bigtable/client/mutation_batcher_options.h"
+#include "bigtable/client/table.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Batch mutations from many threads into `MutateRows` requests.
+ *
+ * Applications that write many independent rows often accumulate the
+ * mutations into a `BulkMutation` and call `Table::BulkApply()` when the batch
+ * is large enough.  This class does the same work in the background: any
+ * number of threads can `Push()` mutations, which are grouped into batches and
+ * sent using `Table::AsyncBulkApply()` once a batch is full (by count or by
+ * size), or once it has waited for `MutationBatcherOptions::flush_period()`.
+ *
+ * The number of concurrent requests is bounded, and `Push()` blocks while the
+ * mutations that have not completed exceed
+ * `MutationBatcherOptions::max_outstanding_bytes()`, so a fast producer cannot
+ * exhaust the memory of the application.
+ *
+ * @code
+ * bigtable::CompletionQueue cq;
+ * std::thread t([&cq]() { cq.Run(); });
+ * {
+ *   bigtable::MutationBatcher batcher(table, cq);
+ *   for (auto& m : mutations) {
+ *     batcher.Push(std::move(m), [](grpc::Status const& status) {
+ *       if (not status.ok()) { ... }
+ *     });
+ *   }
+ * }  // The destructor waits until all the mutations complete.
+ * cq.Shutdown();
+ * t.join();
+ * @endcode
+ *
+ * The requests and their callbacks run in @p cq, so some thread must be
+ * calling `cq.Run()` while the batcher is in use.  Both @p table and @p cq must
+ * outlive the batcher.
+ */
+class MutationBatcher {
+ public:
+  /// Receives the result of a single mutation.
+  using Callback = std::function<void(grpc::Status const&)>;
+
+  MutationBatcher(Table& table, CompletionQueue& cq,
+                  MutationBatcherOptions options = MutationBatcherOptions());
+
+  /// Wait until all the mutations pushed into the batcher complete.
+  ~MutationBatcher();
+
+  MutationBatcher(MutationBatcher const&) = delete;
+  MutationBatcher& operator=(MutationBatcher const&) = delete;
+
+  /**
+   * Add a mutation to the current batch.
+   *
+   * This function blocks while the outstanding mutations exceed
+   * `MutationBatcherOptions::max_outstanding_bytes()`.
+   *
+   * @param mut the mutation, the batcher takes ownership of its data.
+   * @param callback invoked exactly once, by a thread running `cq.Run()`, with
+   *     the result of the mutation.  Mutations that failed with transient
+   *     errors are retried, as in `Table::BulkApply()`.  Mutations whose
+   *     result is unknown (for example, because the retry policy was
+   *     exhausted) are reported with `grpc::StatusCode::UNKNOWN`.  The
+   *     callback should not block, as it delays the other operations in the
+   *     completion queue.
+   */
+  void Push(SingleRowMutation mut, Callback callback);
+
+  /**
+   * Add a mutation to the current batch.
+   *
+   * Like the previous overload, but the result is returned via a
+   * `std::future<>`.
+   */
+  std::future<grpc::Status> Push(SingleRowMutation mut);
+
+  /// Send the current batch without waiting for it to fill up.
+  void Flush();
+
+  /**
+   * Send the current batch and wait until all the mutations complete.
+   *
+   * On return, all the callbacks for mutations pushed before this call have
+   * been invoked.
+   */
+  void WaitForCompletion();
+
+ private:
+  /// The shared state, also referenced by the timers and pending requests.
+  class Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_H_
@@ -0,0 +1,140 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <chrono>
+#include <cstddef>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for `MutationBatcher`.
+ *
+ * @code
+ * bigtable::MutationBatcher batcher(
+ *     table, cq,
+ *     bigtable::MutationBatcherOptions()
+ *         .set_max_batch_size(500)
+ *         .set_flush_period(std::chrono::milliseconds(50)));
+ * @endcode
+ */
+class MutationBatcherOptions {
+ public:
+  MutationBatcherOptions()
+      : max_batch_size_(1000),
+        max_batch_bytes_(4 * 1024 * 1024),
+        flush_period_(std::chrono::milliseconds(10)),
+        max_outstanding_requests_(4),
+        max_outstanding_bytes_(64 * 1024 * 1024) {}
+
+  /// Set the maximum number of mutations sent in a single `MutateRows` request.
+  MutationBatcherOptions& set_max_batch_size(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "MutationBatcherOptions::set_max_batch_size requires n > 0");
+    }
+    max_batch_size_ = n;
+    return *this;
+  }
+  /// Return the maximum number of mutations in a single request.
+  std::size_t max_batch_size() const { return max_batch_size_; }
+
+  /**
+   * Set the maximum size (in bytes) of a single `MutateRows` request.
+   *
+   * A mutation larger than this limit is sent in a request by itself.
+   */
+  MutationBatcherOptions& set_max_batch_bytes(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "MutationBatcherOptions::set_max_batch_bytes requires n > 0");
+    }
+    max_batch_bytes_ = n;
+    return *this;
+  }
+  /// Return the maximum size of a single request.
+  std::size_t max_batch_bytes() const { return max_batch_bytes_; }
+
+  /**
+   * Set how long a partially filled batch waits before it is sent.
+   *
+   * The timer starts when the first mutation is added to an empty batch.
+   */
+  MutationBatcherOptions& set_flush_period(std::chrono::milliseconds period) {
+    if (period.count() <= 0) {
+      internal::RaiseRangeError(
+          "MutationBatcherOptions::set_flush_period requires period > 0");
+    }
+    flush_period_ = period;
+    return *this;
+  }
+  /// Return how long a partially filled batch waits before it is sent.
+  std::chrono::milliseconds flush_period() const { return flush_period_; }
+
+  /**
+   * Set the maximum number of concurrent `MutateRows` requests.
+   *
+   * The requests are distributed over the connections in the `DataClient`
+   * pool.  Batches that are ready while this many requests are in flight are
+   * queued until one of the requests completes.
+   */
+  MutationBatcherOptions& set_max_outstanding_requests(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "MutationBatcherOptions::set_max_outstanding_requests"
+          " requires n > 0");
+    }
+    max_outstanding_requests_ = n;
+    return *this;
+  }
+  /// Return the maximum number of concurrent requests.
+  std::size_t max_outstanding_requests() const {
+    return max_outstanding_requests_;
+  }
+
+  /**
+   * Set the maximum number of bytes in mutations that have not completed.
+   *
+   * `MutationBatcher::Push()` blocks while the mutations that are batched,
+   * queued, or in flight exceed this limit.
+   */
+  MutationBatcherOptions& set_max_outstanding_bytes(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "MutationBatcherOptions::set_max_outstanding_bytes requires n > 0");
+    }
+    max_outstanding_bytes_ = n;
+    return *this;
+  }
+  /// Return the maximum number of bytes in mutations that have not completed.
+  std::size_t max_outstanding_bytes() const { return max_outstanding_bytes_; }
+
+ private:
+  std::size_t max_batch_size_;
+  std::size_t max_batch_bytes_;
+  std::chrono::milliseconds flush_period_;
+  std::size_t max_outstanding_requests_;
+  std::size_t max_outstanding_bytes_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_MUTATION_BATCHER_OPTIONS_H_
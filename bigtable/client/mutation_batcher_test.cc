@@ -0,0 +1,308 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/mutation_batcher.h"
+#include "bigtable/client/internal/make_unique.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+#include <grpc++/alarm.h>
+#include <atomic>
+#include <set>
+#include <thread>
+
+using testing::_;
+using testing::Invoke;
+
+using google::bigtable::v2::MutateRowsRequest;
+using google::bigtable::v2::MutateRowsResponse;
+using bigtable::testing::MockAsyncMutateRowsStream;
+
+namespace {
+class MutationBatcherTest : public bigtable::testing::TableTestFixture {
+ protected:
+  MutationBatcherTest() : cq_thread_([this] { cq_.Run(); }) {
+    EXPECT_CALL(*bigtable_stub_, PrepareAsyncMutateRowsRaw(_, _, _))
+        .WillRepeatedly(Invoke([this](grpc::ClientContext*,
+                                      MutateRowsRequest const& request,
+                                      grpc::CompletionQueue*) {
+          return MakeStream(request);
+        }));
+  }
+
+  ~MutationBatcherTest() override {
+    cq_.Shutdown();
+    cq_thread_.join();
+  }
+
+  /// Deliver a completion for @p tag via the completion queue.
+  void Complete(void* tag, bool ok) {
+    auto alarm = bigtable::internal::make_unique<grpc::Alarm>();
+    if (ok) {
+      alarm->Set(&cq_.cq(), std::chrono::system_clock::now(), tag);
+    } else {
+      // A canceled alarm is delivered with `ok == false`.
+      alarm->Set(&cq_.cq(),
+                 std::chrono::system_clock::now() + std::chrono::hours(1),
+                 tag);
+      alarm->Cancel();
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    alarms_.push_back(std::move(alarm));
+  }
+
+  /// Start the requests that were held by `hold_`.
+  void Release() {
+    std::vector<void*> held;
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      hold_ = false;
+      held.swap(held_);
+    }
+    for (auto tag : held) {
+      Complete(tag, true);
+    }
+  }
+
+  /// Return the number of mutations in each request sent so far.
+  std::vector<int> RequestSizes() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return request_sizes_;
+  }
+
+  /// Create a stream that succeeds for all the mutations not in `fail_keys_`.
+  MockAsyncMutateRowsStream* MakeStream(MutateRowsRequest const& request) {
+    MutateRowsResponse response;
+    int index = 0;
+    for (auto const& entry : request.entries()) {
+      auto& e = *response.add_entries();
+      e.set_index(index++);
+      e.mutable_status()->set_code(fail_keys_.count(entry.row_key()) == 0
+                                       ? grpc::OK
+                                       : grpc::PERMISSION_DENIED);
+    }
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      request_sizes_.push_back(request.entries_size());
+    }
+
+    // must be a new pointer, it is wrapped in unique_ptr by the stub
+    auto stream = new MockAsyncMutateRowsStream;
+    EXPECT_CALL(*stream, StartCall(_)).WillOnce(Invoke([this](void* tag) {
+      std::unique_lock<std::mutex> lk(mu_);
+      if (hold_) {
+        held_.push_back(tag);
+        return;
+      }
+      lk.unlock();
+      Complete(tag, true);
+    }));
+    EXPECT_CALL(*stream, Read(_, _))
+        .WillOnce(Invoke([this, response](MutateRowsResponse* r, void* tag) {
+          *r = response;
+          Complete(tag, true);
+        }))
+        .WillOnce(Invoke([this](MutateRowsResponse*, void* tag) {
+          Complete(tag, false);
+        }));
+    EXPECT_CALL(*stream, Finish(_, _))
+        .WillOnce(Invoke([this](grpc::Status* status, void* tag) {
+          *status = grpc::Status::OK;
+          Complete(tag, true);
+        }));
+    return stream;
+  }
+
+  bigtable::CompletionQueue cq_;
+  std::set<std::string> fail_keys_;
+
+  std::mutex mu_;
+  bool hold_ = false;
+  std::vector<void*> held_;
+  std::vector<int> request_sizes_;
+  std::vector<std::unique_ptr<grpc::Alarm>> alarms_;
+
+  std::thread cq_thread_;
+};
+
+bigtable::SingleRowMutation MakeMutation(std::string row_key) {
+  return bigtable::SingleRowMutation(
+      std::move(row_key), {bigtable::SetCell("fam", "col", 0, "value")});
+}
+
+/// A flush period long enough to never expire during the tests.
+auto const kLongPeriod = std::chrono::hours(1);
+auto const kWait = std::chrono::seconds(10);
+}  // anonymous namespace
+
+/// @test Verify that full batches are sent without waiting for the timer.
+TEST_F(MutationBatcherTest, FlushOnBatchSize) {
+  std::vector<std::future<grpc::Status>> results;
+  {
+    bigtable::MutationBatcher batcher(table_, cq_,
+                                      bigtable::MutationBatcherOptions()
+                                          .set_max_batch_size(2)
+                                          .set_flush_period(kLongPeriod));
+    for (auto key : {"r0", "r1", "r2", "r3"}) {
+      results.emplace_back(batcher.Push(MakeMutation(key)));
+    }
+    for (auto& r : results) {
+      ASSERT_EQ(std::future_status::ready, r.wait_for(kWait));
+    }
+  }
+  for (auto& r : results) {
+    EXPECT_TRUE(r.get().ok());
+  }
+  EXPECT_EQ((std::vector<int>{2, 2}), RequestSizes());
+}
+
+/// @test Verify that large mutations close the batch.
+TEST_F(MutationBatcherTest, FlushOnBatchBytes) {
+  {
+    bigtable::MutationBatcher batcher(table_, cq_,
+                                      bigtable::MutationBatcherOptions()
+                                          .set_max_batch_bytes(1)
+                                          .set_flush_period(kLongPeriod));
+    for (auto key : {"r0", "r1", "r2"}) {
+      batcher.Push(MakeMutation(key), [](grpc::Status const&) {});
+    }
+  }
+  EXPECT_EQ((std::vector<int>{1, 1, 1}), RequestSizes());
+}
+
+/// @test Verify that partial batches are sent once the flush period expires.
+TEST_F(MutationBatcherTest, FlushOnTimer) {
+  bigtable::MutationBatcher batcher(
+      table_, cq_,
+      bigtable::MutationBatcherOptions().set_flush_period(
+          std::chrono::milliseconds(10)));
+  auto r0 = batcher.Push(MakeMutation("r0"));
+  auto r1 = batcher.Push(MakeMutation("r1"));
+  ASSERT_EQ(std::future_status::ready, r0.wait_for(kWait));
+  ASSERT_EQ(std::future_status::ready, r1.wait_for(kWait));
+  EXPECT_TRUE(r0.get().ok());
+  EXPECT_TRUE(r1.get().ok());
+  EXPECT_EQ((std::vector<int>{2}), RequestSizes());
+}
+
+/// @test Verify that WaitForCompletion() flushes and waits for the callbacks.
+TEST_F(MutationBatcherTest, WaitForCompletion) {
+  bigtable::MutationBatcher batcher(
+      table_, cq_,
+      bigtable::MutationBatcherOptions().set_flush_period(kLongPeriod));
+  std::atomic<int> count(0);
+  for (auto key : {"r0", "r1", "r2"}) {
+    batcher.Push(MakeMutation(key), [&count](grpc::Status const& status) {
+      EXPECT_TRUE(status.ok());
+      ++count;
+    });
+  }
+  batcher.WaitForCompletion();
+  EXPECT_EQ(3, count.load());
+  EXPECT_EQ((std::vector<int>{3}), RequestSizes());
+}
+
+/// @test Verify that each mutation receives its own status.
+TEST_F(MutationBatcherTest, PerMutationStatus) {
+  fail_keys_.insert("r1");
+  bigtable::MutationBatcher batcher(
+      table_, cq_,
+      bigtable::MutationBatcherOptions().set_flush_period(kLongPeriod));
+  auto r0 = batcher.Push(MakeMutation("r0"));
+  auto r1 = batcher.Push(MakeMutation("r1"));
+  auto r2 = batcher.Push(MakeMutation("r2"));
+  batcher.Flush();
+  EXPECT_TRUE(r0.get().ok());
+  EXPECT_EQ(grpc::StatusCode::PERMISSION_DENIED, r1.get().error_code());
+  EXPECT_TRUE(r2.get().ok());
+  EXPECT_EQ((std::vector<int>{3}), RequestSizes());
+}
+
+/// @test Verify that a batch waiting for its timer is canceled on shutdown.
+TEST_F(MutationBatcherTest, ShutdownCancelsPendingBatch) {
+  {
+    bigtable::MutationBatcher batcher(
+        table_, cq_,
+        bigtable::MutationBatcherOptions().set_flush_period(
+            std::chrono::milliseconds(50)));
+    auto r0 = batcher.Push(MakeMutation("r0"));
+    cq_.Shutdown();
+    ASSERT_EQ(std::future_status::ready, r0.wait_for(kWait));
+    EXPECT_EQ(grpc::StatusCode::CANCELLED, r0.get().error_code());
+    // The destructor must not block waiting for the canceled mutations.
+  }
+  EXPECT_TRUE(RequestSizes().empty());
+}
+
+/// @test Verify that the number of concurrent requests is bounded.
+TEST_F(MutationBatcherTest, MaxOutstandingRequests) {
+  hold_ = true;
+  bigtable::MutationBatcher batcher(table_, cq_,
+                                    bigtable::MutationBatcherOptions()
+                                        .set_max_batch_size(1)
+                                        .set_max_outstanding_requests(1));
+  auto r0 = batcher.Push(MakeMutation("r0"));
+  auto r1 = batcher.Push(MakeMutation("r1"));
+  // The second batch is queued until the first request completes.
+  EXPECT_EQ((std::vector<int>{1}), RequestSizes());
+  Release();
+  ASSERT_EQ(std::future_status::ready, r0.wait_for(kWait));
+  ASSERT_EQ(std::future_status::ready, r1.wait_for(kWait));
+  EXPECT_TRUE(r0.get().ok());
+  EXPECT_TRUE(r1.get().ok());
+  EXPECT_EQ((std::vector<int>{1, 1}), RequestSizes());
+}
+
+/// @test Verify that Push() blocks while too many bytes are outstanding.
+TEST_F(MutationBatcherTest, Backpressure) {
+  hold_ = true;
+  bigtable::MutationBatcher batcher(table_, cq_,
+                                    bigtable::MutationBatcherOptions()
+                                        .set_max_batch_size(1)
+                                        .set_max_outstanding_bytes(1));
+  auto r0 = batcher.Push(MakeMutation("r0"));
+
+  std::atomic<bool> pushed(false);
+  std::future<grpc::Status> r1;
+  std::thread producer([&] {
+    r1 = batcher.Push(MakeMutation("r1"));
+    pushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(pushed.load());
+  EXPECT_EQ((std::vector<int>{1}), RequestSizes());
+
+  Release();
+  producer.join();
+  EXPECT_TRUE(pushed.load());
+  EXPECT_TRUE(r0.get().ok());
+  EXPECT_TRUE(r1.get().ok());
+  EXPECT_EQ((std::vector<int>{1, 1}), RequestSizes());
+}
+
+TEST(MutationBatcherOptionsTest, Defaults) {
+  bigtable::MutationBatcherOptions options;
+  EXPECT_EQ(1000U, options.max_batch_size());
+  EXPECT_EQ(4U * 1024 * 1024, options.max_batch_bytes());
+  EXPECT_EQ(std::chrono::milliseconds(10), options.flush_period());
+  EXPECT_EQ(4U, options.max_outstanding_requests());
+  EXPECT_EQ(64U * 1024 * 1024, options.max_outstanding_bytes());
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(options.set_max_batch_size(0), std::range_error);
+  EXPECT_THROW(options.set_max_batch_bytes(0), std::range_error);
+  EXPECT_THROW(options.set_flush_period(std::chrono::milliseconds(0)),
+               std::range_error);
+  EXPECT_THROW(options.set_max_outstanding_requests(0), std::range_error);
+  EXPECT_THROW(options.set_max_outstanding_bytes(0), std::range_error);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
@@ -21,7 +21,9 @@
 #include <google/bigtable/v2/data.pb.h>
 #include <grpc++/grpc++.h>
 
+#include <iterator>
 #include <type_traits>
+#include <vector>
 
 #include "bigtable/client/internal/conjunction.h"
 
@@ -37,7 +39,20 @@ struct Mutation {
   google::bigtable::v2::Mutation op;
 };
 
-/// Create a mutation to set a cell value.
+/**
+ * Create a mutation to set a cell value.
+ *
+ * The arguments are moved into the mutation.  To write large values without
+ * copying them, pass a `std::string` rvalue, and use the variadic
+ * `SingleRowMutation` constructor, which moves the mutation into the request
+ * sent to the server:
+ *
+ * @code
+ * std::string blob = ...;  // A large value.
+ * table.Apply(bigtable::SingleRowMutation(
+ *     "row-key", bigtable::SetCell("fam", "col", 0, std::move(blob))));
+ * @endcode
+ */
 Mutation SetCell(std::string family, std::string column, std::int64_t timestamp,
                  std::string value);
 
@@ -102,7 +117,13 @@ class SingleRowMutation {
   explicit SingleRowMutation(std::string row_key)
       : row_key_(std::move(row_key)) {}
 
-  /// Create a row mutation from a initializer list.
+  /**
+   * Create a row mutation from a initializer list.
+   *
+   * The elements of a `std::initializer_list<>` are `const`, so they are
+   * copied.  Use the `std::vector<Mutation>&&` or the variadic constructors
+   * to move large values instead.
+   */
   SingleRowMutation(std::string row_key, std::initializer_list<Mutation> list)
       : row_key_(std::move(row_key)) {
     for (auto&& i : list) {
@@ -110,7 +131,22 @@ class SingleRowMutation {
     }
   }
 
-  /// Create a single-row multiple-cell mutation from a variadic list.
+  /// Create a row mutation moving the mutations from a vector.
+  SingleRowMutation(std::string row_key, std::vector<Mutation>&& mutations)
+      : row_key_(std::move(row_key)) {
+    ops_.Reserve(static_cast<int>(mutations.size()));
+    for (auto& m : mutations) {
+      emplace_back(std::move(m));
+    }
+    mutations.clear();
+  }
+
+  /**
+   * Create a single-row multiple-cell mutation from a variadic list.
+   *
+   * The arguments are forwarded: rvalues are moved into this object, lvalues
+   * are copied.
+   */
   template <typename... M>
   explicit SingleRowMutation(std::string row_key, M&&... m)
       : row_key_(std::move(row_key)) {
@@ -158,13 +194,16 @@ class SingleRowMutation {
 
  private:
   /// Add multiple mutations to single row
-  template <typename... M>
-  void emplace_many(Mutation&& first, M&&... tail) {
-    emplace_back(std::forward<Mutation>(first));
+  template <typename First, typename... M>
+  void emplace_many(First&& first, M&&... tail) {
+    Add(std::forward<First>(first));
     emplace_many(std::forward<M>(tail)...);
   }
 
-  void emplace_many(Mutation&& m) { emplace_back(std::forward<Mutation>(m)); }
+  void emplace_many() {}
+
+  void Add(Mutation&& m) { emplace_back(std::move(m)); }
+  void Add(Mutation const& m) { *ops_.Add() = m.op; }
 
  private:
   std::string row_key_;
@@ -185,7 +224,7 @@ class FailedMutation {
       : FailedMutation(std::move(mut), std::move(status), -1) {}
   FailedMutation(SingleRowMutation mut, google::rpc::Status status, int index)
       : mutation_(std::move(mut)),
-        status_(to_grpc_status(status)),
+        status_(std::move(status)),
         original_index_(index) {}
 
   FailedMutation(FailedMutation&&) = default;
@@ -196,10 +235,20 @@ class FailedMutation {
   //@{
   /// @name accessors
   SingleRowMutation const& mutation() const { return mutation_; }
-  grpc::Status const& status() const { return status_; }
   int original_index() const { return original_index_; }
   //@}
 
+  /**
+   * The error for this mutation.
+   *
+   * The error details are formatted as text each time this function is
+   * called, use `rpc_status()` to examine the error without that cost.
+   */
+  grpc::Status status() const { return to_grpc_status(status_); }
+
+  /// The error for this mutation, as returned by the server.
+  google::rpc::Status const& rpc_status() const { return status_; }
+
   friend class BulkMutation;
 
  private:
@@ -207,7 +256,7 @@ class FailedMutation {
 
  private:
   SingleRowMutation mutation_;
-  grpc::Status status_;
+  google::rpc::Status status_;
   int original_index_;
 };
 
@@ -264,21 +313,39 @@ class BulkMutation {
   /// Create an empty set of mutations.
   BulkMutation() : request_() {}
 
-  /// Create a multi-row mutation from a range of SingleRowMutations.
+  /**
+   * Create a multi-row mutation from a range of SingleRowMutations.
+   *
+   * The mutations are moved if the iterators return rvalues, e.g. when using
+   * `std::make_move_iterator()`, and copied otherwise.
+   */
   template <typename iterator>
   BulkMutation(iterator begin, iterator end) {
     static_assert(
         std::is_convertible<decltype(*begin), SingleRowMutation>::value,
         "The iterator value type must be convertible to SingleRowMutation");
     for (auto i = begin; i != end; ++i) {
-      push_back(*i);
+      Add(*i);
     }
   }
 
-  /// Create a multi-row mutation from a initializer list.
+  /**
+   * Create a multi-row mutation from a initializer list.
+   *
+   * The elements of a `std::initializer_list<>` are `const`, so they are
+   * copied.  Use the `std::vector<SingleRowMutation>&&` or the variadic
+   * constructors to move large values instead.
+   */
   BulkMutation(std::initializer_list<SingleRowMutation> list)
       : BulkMutation(list.begin(), list.end()) {}
 
+  /// Create a multi-row mutation moving the mutations from a vector.
+  explicit BulkMutation(std::vector<SingleRowMutation>&& mutations)
+      : BulkMutation(std::make_move_iterator(mutations.begin()),
+                     std::make_move_iterator(mutations.end())) {
+    mutations.clear();
+  }
+
   /// Create a muti-row mutation from a SingleRowMutation
   explicit BulkMutation(SingleRowMutation&& mutation) : BulkMutation() {
     emplace_back(std::move(mutation));
@@ -291,7 +358,12 @@ class BulkMutation {
     emplace_back(std::move(m2));
   }
 
-  /// Create a muti-row mutation from a variadic list.
+  /**
+   * Create a muti-row mutation from a variadic list.
+   *
+   * The arguments are forwarded: rvalues are moved into this object, lvalues
+   * are copied.
+   */
   template <typename... M>
   BulkMutation(M&&... m) : BulkMutation() {
     static_assert(
@@ -304,45 +376,76 @@ class BulkMutation {
 
   // Add a mutation to the batch.
   BulkMutation& emplace_back(SingleRowMutation&& mut) {
-    mut.MoveTo(request_.add_entries());
+    auto& entry = *request_.add_entries();
+    mut.MoveTo(&entry);
+    Track(entry);
     return *this;
   }
 
   // Add a failed mutation to the batch.
   BulkMutation& emplace_back(FailedMutation&& fm) {
-    fm.mutation_.MoveTo(request_.add_entries());
-    fm.status_ = grpc::Status::OK;
+    auto& entry = *request_.add_entries();
+    fm.mutation_.MoveTo(&entry);
+    fm.status_.Clear();
+    Track(entry);
     return *this;
   }
 
   // Add a mutation to the batch.
   BulkMutation& push_back(SingleRowMutation mut) {
-    mut.MoveTo(request_.add_entries());
-    return *this;
+    return emplace_back(std::move(mut));
   }
 
   /// Move the contents into a bigtable::v2::MutateRowsRequest
   void MoveTo(google::bigtable::v2::MutateRowsRequest* request) {
     request_.Swap(request);
     request_ = {};
+    mutation_count_ = 0;
+    byte_size_ = 0;
   }
 
   /// Return true if there are no mutations in this set.
   bool empty() const { return request_.entries().empty(); }
 
+  /// Return the number of rows modified by this set.
+  std::size_t size() const {
+    return static_cast<std::size_t>(request_.entries_size());
+  }
+
+  /**
+   * Return the number of mutations in this set, across all the rows.
+   *
+   * The service limits the number of mutations in a single `MutateRows`
+   * request, `Table::BulkApply()` uses this value to split large sets.
+   */
+  std::size_t mutation_count() const { return mutation_count_; }
+
+  /// Return the size (in bytes) of the serialized mutations in this set.
+  std::size_t byte_size() const { return byte_size_; }
+
  private:
-  template <typename... M>
-  void emplace_many(SingleRowMutation&& first, M&&... tail) {
-    emplace_back(std::forward<SingleRowMutation>(first));
-    emplace_many(std::forward<M>(tail)...);
+  /// Update the counters after adding @p entry.
+  void Track(google::bigtable::v2::MutateRowsRequest::Entry const& entry) {
+    mutation_count_ += static_cast<std::size_t>(entry.mutations_size());
+    byte_size_ += entry.ByteSizeLong();
   }
 
-  void emplace_many(SingleRowMutation&& m) {
-    emplace_back(std::forward<SingleRowMutation>(m));
+  template <typename First, typename... M>
+  void emplace_many(First&& first, M&&... tail) {
+    Add(std::forward<First>(first));
+    emplace_many(std::forward<M>(tail)...);
   }
 
+  void emplace_many() {}
+
+  void Add(SingleRowMutation&& m) { emplace_back(std::move(m)); }
+  void Add(SingleRowMutation const& m) { push_back(m); }
+
  private:
+  friend class Table;
   google::bigtable::v2::MutateRowsRequest request_;
+  std::size_t mutation_count_ = 0;
+  std::size_t byte_size_ = 0;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -140,6 +140,9 @@ TEST(MutationsTest, FailedMutation) {
   EXPECT_EQ("something failed", fm.status().error_message());
   EXPECT_FALSE(fm.status().error_details().empty());
   EXPECT_EQ("foo", fm.mutation().row_key());
+  EXPECT_EQ(grpc::StatusCode::FAILED_PRECONDITION, fm.rpc_status().code());
+  EXPECT_EQ("something failed", fm.rpc_status().message());
+  EXPECT_EQ(3, fm.rpc_status().details_size());
 }
 
 /// @test Verify that MultipleRowMutations works as expected.
@@ -193,6 +196,35 @@ TEST(MutationsTest, MutipleRowMutations) {
   EXPECT_EQ("foo3", request.entries(1).row_key());
 }
 
+/// @test Verify that BulkMutation tracks the number and size of mutations.
+TEST(MutationsTest, BulkMutationCounters) {
+  bigtable::BulkMutation actual;
+  EXPECT_EQ(0U, actual.size());
+  EXPECT_EQ(0U, actual.mutation_count());
+  EXPECT_EQ(0U, actual.byte_size());
+
+  actual
+      .emplace_back(bigtable::SingleRowMutation(
+          "foo1", {bigtable::SetCell("f", "c", 0, "v1"),
+                   bigtable::SetCell("f", "c", 1, "v2")}))
+      .push_back(bigtable::SingleRowMutation(
+          "foo2", {bigtable::SetCell("f", "c", 0, "v2")}));
+  EXPECT_EQ(2U, actual.size());
+  EXPECT_EQ(3U, actual.mutation_count());
+
+  google::bigtable::v2::MutateRowsRequest request;
+  auto byte_size = actual.byte_size();
+  actual.MoveTo(&request);
+  std::size_t expected = 0;
+  for (auto const& e : request.entries()) {
+    expected += e.ByteSizeLong();
+  }
+  EXPECT_EQ(expected, byte_size);
+  EXPECT_EQ(0U, actual.size());
+  EXPECT_EQ(0U, actual.mutation_count());
+  EXPECT_EQ(0U, actual.byte_size());
+}
+
 /// @test Verify variadic Mutations for SingleRowMutations.
 TEST(MutationsTest, SingleRowMutationMultipleVariadic) {
   std::string const row_key = "row-key-1";
@@ -225,3 +257,102 @@ TEST(MutationsTest, SingleRowMutationSingleVariadic) {
   ASSERT_EQ(1, entry.mutations_size());
   EXPECT_EQ(row_key, entry.row_key());
 }
+
+/// @test Verify that large values are moved, not copied, into the request.
+TEST(MutationsTest, VariadicMovesValues) {
+  std::string value(1024 * 1024, 'x');
+  char const* data = value.data();
+
+  bigtable::BulkMutation bulk(bigtable::SingleRowMutation(
+      "row-key-1", bigtable::SetCell("fam", "col", 0, std::move(value))));
+
+  google::bigtable::v2::MutateRowsRequest request;
+  bulk.MoveTo(&request);
+  ASSERT_EQ(1, request.entries_size());
+  auto const& entry = request.entries(0);
+  EXPECT_EQ("row-key-1", entry.row_key());
+  ASSERT_EQ(1, entry.mutations_size());
+  auto const& set_cell = entry.mutations(0).set_cell();
+  EXPECT_EQ(1024U * 1024U, set_cell.value().size());
+  EXPECT_EQ(data, set_cell.value().data());
+}
+
+/// @test Verify that BulkMutation can move the mutations from a range.
+TEST(MutationsTest, BulkMutationMoveIterator) {
+  std::vector<bigtable::SingleRowMutation> mutations;
+  std::vector<char const*> data;
+  for (int i = 0; i != 3; ++i) {
+    std::string value(1024 * 1024, 'x');
+    data.push_back(value.data());
+    mutations.emplace_back(bigtable::SingleRowMutation(
+        "row-key-" + std::to_string(i),
+        bigtable::SetCell("fam", "col", 0, std::move(value))));
+  }
+
+  bigtable::BulkMutation bulk(std::make_move_iterator(mutations.begin()),
+                              std::make_move_iterator(mutations.end()));
+
+  google::bigtable::v2::MutateRowsRequest request;
+  bulk.MoveTo(&request);
+  ASSERT_EQ(3, request.entries_size());
+  for (int i = 0; i != 3; ++i) {
+    auto const& entry = request.entries(i);
+    EXPECT_EQ("row-key-" + std::to_string(i), entry.row_key());
+    ASSERT_EQ(1, entry.mutations_size());
+    EXPECT_EQ(data[i], entry.mutations(0).set_cell().value().data());
+  }
+}
+
+/// @test Verify that the vector constructors move the mutations.
+TEST(MutationsTest, VectorMovesValues) {
+  std::vector<bigtable::SingleRowMutation> rows;
+  std::vector<char const*> data;
+  for (int i = 0; i != 3; ++i) {
+    std::vector<bigtable::Mutation> mutations;
+    for (int j = 0; j != 2; ++j) {
+      std::string value(1024 * 1024, 'x');
+      data.push_back(value.data());
+      mutations.emplace_back(
+          bigtable::SetCell("fam", "col", j, std::move(value)));
+    }
+    rows.emplace_back("row-key-" + std::to_string(i), std::move(mutations));
+    EXPECT_TRUE(mutations.empty());
+  }
+
+  bigtable::BulkMutation bulk(std::move(rows));
+  EXPECT_TRUE(rows.empty());
+  EXPECT_EQ(6U, bulk.mutation_count());
+
+  google::bigtable::v2::MutateRowsRequest request;
+  bulk.MoveTo(&request);
+  ASSERT_EQ(3, request.entries_size());
+  std::size_t index = 0;
+  for (auto const& entry : request.entries()) {
+    ASSERT_EQ(2, entry.mutations_size());
+    for (auto const& m : entry.mutations()) {
+      EXPECT_EQ(data[index++], m.set_cell().value().data());
+    }
+  }
+}
+
+/// @test Verify that the variadic constructors copy lvalue arguments.
+TEST(MutationsTest, VariadicCopiesLvalues) {
+  auto const set_cell = bigtable::SetCell("fam", "col", 0, "value");
+  bigtable::SingleRowMutation row("row-key-1", set_cell,
+                                  bigtable::DeleteFromRow());
+  EXPECT_EQ("value", set_cell.op.set_cell().value());
+
+  bigtable::BulkMutation bulk(row, bigtable::SingleRowMutation("row-key-2"),
+                              bigtable::SingleRowMutation("row-key-3"));
+  EXPECT_EQ("row-key-1", row.row_key());
+  EXPECT_EQ(2U, bulk.mutation_count());
+
+  google::bigtable::v2::MutateRowsRequest request;
+  bulk.MoveTo(&request);
+  ASSERT_EQ(3, request.entries_size());
+  auto const& entry = request.entries(0);
+  EXPECT_EQ("row-key-1", entry.row_key());
+  ASSERT_EQ(2, entry.mutations_size());
+  EXPECT_EQ("value", entry.mutations(0).set_cell().value());
+  EXPECT_TRUE(entry.mutations(1).has_delete_from_row());
+}
@@ -0,0 +1,109 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_PARALLEL_SCAN_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_PARALLEL_SCAN_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <cstddef>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for `Table::ParallelReadRows()`.
+ *
+ * @code
+ * table.ParallelReadRows(
+ *     row_set, filter, on_row,
+ *     bigtable::ParallelScanOptions().set_max_streams(8).set_ordered(true));
+ * @endcode
+ */
+class ParallelScanOptions {
+ public:
+  ParallelScanOptions()
+      : max_streams_(4), shard_count_(0), ordered_(false), queue_size_(1024) {}
+
+  /**
+   * Set the maximum number of concurrent `ReadRows` streams.
+   *
+   * Each stream is served by its own thread, and the streams are distributed
+   * over the connections in the `DataClient` pool.
+   */
+  ParallelScanOptions& set_max_streams(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "ParallelScanOptions::set_max_streams requires n > 0");
+    }
+    max_streams_ = n;
+    return *this;
+  }
+  /// Return the maximum number of concurrent streams.
+  std::size_t max_streams() const { return max_streams_; }
+
+  /**
+   * Set the number of shards the scan is split into.
+   *
+   * The shards are created at the boundaries returned by `SampleRowKeys()`,
+   * so the actual number of shards may be smaller.  Using more shards than
+   * streams balances the load when some shards are slower than others.  The
+   * default (0) uses `4 * max_streams()` shards.
+   */
+  ParallelScanOptions& set_shard_count(std::size_t n) {
+    shard_count_ = n;
+    return *this;
+  }
+  /// Return the number of shards, or 0 to use the default.
+  std::size_t shard_count() const { return shard_count_; }
+
+  /**
+   * Deliver the rows in row key order.
+   *
+   * By default the rows are delivered in the order they are received, which
+   * is the fastest option.  In ordered mode the rows for later shards are
+   * buffered (up to `queue_size()` rows per shard) until the earlier shards
+   * are consumed.
+   */
+  ParallelScanOptions& set_ordered(bool ordered) {
+    ordered_ = ordered;
+    return *this;
+  }
+  /// Return true if the rows are delivered in row key order.
+  bool ordered() const { return ordered_; }
+
+  /// Set the maximum number of rows buffered for each shard.
+  ParallelScanOptions& set_queue_size(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "ParallelScanOptions::set_queue_size requires n > 0");
+    }
+    queue_size_ = n;
+    return *this;
+  }
+  /// Return the maximum number of rows buffered for each shard.
+  std::size_t queue_size() const { return queue_size_; }
+
+ private:
+  std::size_t max_streams_;
+  std::size_t shard_count_;
+  bool ordered_;
+  std::size_t queue_size_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_PARALLEL_SCAN_OPTIONS_H_
@@ -0,0 +1,76 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_READ_ROW_COALESCING_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_READ_ROW_COALESCING_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <chrono>
+#include <cstddef>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for `Table::EnableReadRowCoalescing()`.
+ *
+ * @code
+ * table.EnableReadRowCoalescing(
+ *     bigtable::ReadRowCoalescingOptions()
+ *         .set_window(std::chrono::microseconds(500))
+ *         .set_max_keys(200));
+ * @endcode
+ */
+class ReadRowCoalescingOptions {
+ public:
+  ReadRowCoalescingOptions()
+      : window_(std::chrono::milliseconds(1)), max_keys_(100) {}
+
+  /**
+   * Set how long the first `ReadRow()` call in a batch waits for others.
+   *
+   * The calls that arrive within this period (for the same filter) are sent
+   * in a single `ReadRows` request.  Larger values merge more calls, at the
+   * cost of adding up to this much latency to each call.
+   */
+  ReadRowCoalescingOptions& set_window(std::chrono::microseconds window) {
+    window_ = window;
+    return *this;
+  }
+  /// Return how long the first call in a batch waits for others.
+  std::chrono::microseconds window() const { return window_; }
+
+  /// Set the maximum number of calls merged in a batch.
+  ReadRowCoalescingOptions& set_max_keys(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "ReadRowCoalescingOptions::set_max_keys requires n > 0");
+    }
+    max_keys_ = n;
+    return *this;
+  }
+  /// Return the maximum number of calls merged in a batch.
+  std::size_t max_keys() const { return max_keys_; }
+
+ private:
+  std::chrono::microseconds window_;
+  std::size_t max_keys_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_READ_ROW_COALESCING_OPTIONS_H_
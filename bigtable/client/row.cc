@@ -0,0 +1,154 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/row.h"
+#include <algorithm>
+#include <numeric>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/// Compare two cells by family name and column qualifier.
+int CompareColumns(Cell const& lhs, Cell const& rhs) {
+  int r = lhs.family_name().compare(rhs.family_name());
+  if (r != 0) {
+    return r;
+  }
+  return lhs.column_qualifier().compare(rhs.column_qualifier());
+}
+
+/// Compare a cell with a family name and optional column qualifier.
+int CompareColumns(Cell const& cell, std::string const& family,
+                   std::string const* qualifier) {
+  int r = cell.family_name().compare(family);
+  if (r != 0 or qualifier == nullptr) {
+    return r;
+  }
+  return cell.column_qualifier().compare(*qualifier);
+}
+}  // anonymous namespace
+
+// Copying reads index_ atomically, other threads may be building it.
+Row::Row(Row const& rhs)
+    : row_key_(rhs.row_key_),
+      cells_(rhs.cells_),
+      index_(std::atomic_load(&rhs.index_)) {}
+
+Row& Row::operator=(Row const& rhs) {
+  Row tmp(rhs);
+  *this = std::move(tmp);
+  return *this;
+}
+
+Row::CellRange Row::cells(std::string const& family_name,
+                          std::string const& column_qualifier) const {
+  return EqualRange(family_name, &column_qualifier);
+}
+
+Row::CellRange Row::cells_in(std::string const& family_name) const {
+  return EqualRange(family_name, nullptr);
+}
+
+Cell const* Row::find(std::string const& family_name,
+                      std::string const& column_qualifier) const {
+  auto range = EqualRange(family_name, &column_qualifier);
+  if (range.empty()) {
+    return nullptr;
+  }
+  return &*range.begin();
+}
+
+std::vector<Cell const*> Row::latest_cells_in(
+    std::string const& family_name) const {
+  std::vector<Cell const*> result;
+  for (auto const& cell : cells_in(family_name)) {
+    if (result.empty() or
+        result.back()->column_qualifier() != cell.column_qualifier()) {
+      result.push_back(&cell);
+    }
+  }
+  return result;
+}
+
+std::shared_ptr<Row::Index const> Row::GetIndex() const {
+  auto index = std::atomic_load(&index_);
+  if (index) {
+    return index;
+  }
+
+  auto built = std::make_shared<Index>();
+  bool sorted = true;
+  for (std::size_t i = 1; i < cells_.size(); ++i) {
+    if (CompareColumns(cells_[i - 1], cells_[i]) > 0) {
+      sorted = false;
+      break;
+    }
+  }
+  if (not sorted) {
+    // A stable sort preserves the order of the versions in each column.
+    built->order.resize(cells_.size());
+    std::iota(built->order.begin(), built->order.end(), std::size_t(0));
+    std::stable_sort(built->order.begin(), built->order.end(),
+                     [this](std::size_t lhs, std::size_t rhs) {
+                       return CompareColumns(cells_[lhs], cells_[rhs]) < 0;
+                     });
+  }
+
+  // If another thread built the index first use theirs, they are equivalent.
+  std::shared_ptr<Index const> expected;
+  std::shared_ptr<Index const> desired = std::move(built);
+  if (std::atomic_compare_exchange_strong(&index_, &expected, desired)) {
+    return desired;
+  }
+  return expected;
+}
+
+Row::CellRange Row::EqualRange(std::string const& family,
+                               std::string const* qualifier) const {
+  auto index = GetIndex();
+  std::size_t const* order =
+      index->order.empty() ? nullptr : index->order.data();
+  auto cell_at = [this, order](std::size_t pos) -> Cell const& {
+    return order ? cells_[order[pos]] : cells_[pos];
+  };
+
+  // Find the first position not less than the key.
+  std::size_t lo = 0;
+  std::size_t hi = cells_.size();
+  while (lo < hi) {
+    auto mid = lo + (hi - lo) / 2;
+    if (CompareColumns(cell_at(mid), family, qualifier) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  auto const begin = lo;
+  // Find the first position greater than the key.
+  hi = cells_.size();
+  while (lo < hi) {
+    auto mid = lo + (hi - lo) / 2;
+    if (CompareColumns(cell_at(mid), family, qualifier) <= 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  // The range does not keep the index alive, but the row does, and the
+  // range is only valid while the row is unchanged.
+  return CellRange(cells_.data(), order, begin, lo);
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
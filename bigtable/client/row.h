@@ -19,10 +19,18 @@
 
 #include "bigtable/client/cell.h"
 
+#include <iterator>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class ReadRowsParser;
+class ResumableRequest;
+}  // namespace internal
+
 /**
  * The in-memory representation of a Bigtable row.
  *
@@ -31,21 +39,159 @@ inline namespace BIGTABLE_CLIENT_NS {
  * all the data available.
  */
 class Row {
+ private:
+  struct Index;
+
  public:
   /// Create a row from a list of cells.
   Row(std::string row_key, std::vector<Cell> cells)
-      : row_key_(std::move(row_key)), cells_(std::move(cells)) {}
+      : row_key_(std::make_shared<std::string const>(std::move(row_key))),
+        cells_(std::move(cells)) {}
+
+  Row(Row const& rhs);
+  Row(Row&& rhs) noexcept = default;
+  Row& operator=(Row const& rhs);
+  Row& operator=(Row&& rhs) noexcept = default;
 
   /// Return the row key. The returned value is not valid
   /// after this object is deleted.
-  std::string const& row_key() const { return row_key_; }
+  std::string const& row_key() const {
+    return row_key_ ? *row_key_ : internal::EmptyName();
+  }
 
   /// Return all cells.
   std::vector<Cell> const& cells() const { return cells_; }
 
+  /**
+   * A range of cells in a row, returned by the lookup functions.
+   *
+   * The range refers to the cells in the row, it is invalidated if the row
+   * is modified or deleted.
+   */
+  class CellRange {
+   public:
+    /// A forward iterator over the cells in the range.
+    class const_iterator
+        : public std::iterator<std::forward_iterator_tag, Cell const> {
+     public:
+      const_iterator() : cells_(nullptr), order_(nullptr), pos_(0) {}
+
+      Cell const& operator*() const {
+        return order_ ? cells_[order_[pos_]] : cells_[pos_];
+      }
+      Cell const* operator->() const { return &**this; }
+      const_iterator& operator++() {
+        ++pos_;
+        return *this;
+      }
+      const_iterator operator++(int) {
+        const_iterator tmp(*this);
+        ++pos_;
+        return tmp;
+      }
+      bool operator==(const_iterator const& rhs) const {
+        return pos_ == rhs.pos_;
+      }
+      bool operator!=(const_iterator const& rhs) const {
+        return pos_ != rhs.pos_;
+      }
+
+     private:
+      friend class CellRange;
+      const_iterator(Cell const* cells, std::size_t const* order,
+                     std::size_t pos)
+          : cells_(cells), order_(order), pos_(pos) {}
+
+      Cell const* cells_;
+      std::size_t const* order_;
+      std::size_t pos_;
+    };
+    using iterator = const_iterator;
+
+    const_iterator begin() const { return const_iterator(cells_, order_, b_); }
+    const_iterator end() const { return const_iterator(cells_, order_, e_); }
+    std::size_t size() const { return e_ - b_; }
+    bool empty() const { return b_ == e_; }
+
+   private:
+    friend class Row;
+    CellRange(Cell const* cells, std::size_t const* order, std::size_t b,
+              std::size_t e)
+        : cells_(cells), order_(order), b_(b), e_(e) {}
+
+    Cell const* cells_;
+    std::size_t const* order_;
+    std::size_t b_;
+    std::size_t e_;
+  };
+
+  //@{
+  /**
+   * @name Column lookups.
+   *
+   * These functions use a binary search, and run in O(log n) time after the
+   * first call.  The cells returned by the service are sorted by column
+   * (within each family), in that case the first call validates the order
+   * in O(n) time and no additional memory is used.  Otherwise the first call
+   * builds an index in O(n log n) time.  The index is built at most once,
+   * and it is safe to call these functions from multiple threads.
+   */
+
+  /**
+   * Return all the cells in a column, in the order they appear in the row.
+   *
+   * For rows returned by the service the cells are sorted by decreasing
+   * timestamp, i.e., the newest version is first.
+   */
+  CellRange cells(std::string const& family_name,
+                  std::string const& column_qualifier) const;
+
+  /// Return all the cells in a column family, sorted by column qualifier.
+  CellRange cells_in(std::string const& family_name) const;
+
+  /**
+   * Return the first cell in a column, or nullptr if there is none.
+   *
+   * For rows returned by the service this is the newest version.
+   */
+  Cell const* find(std::string const& family_name,
+                   std::string const& column_qualifier) const;
+
+  /// Return the first cell (the newest version) of each column in a family.
+  std::vector<Cell const*> latest_cells_in(
+      std::string const& family_name) const;
+  //@}
+
  private:
-  std::string row_key_;
+  friend class internal::ReadRowsParser;
+  friend class internal::ResumableRequest;
+
+  /// Create a row sharing the row key with its cells.
+  Row(std::shared_ptr<std::string const> row_key, std::vector<Cell> cells)
+      : row_key_(std::move(row_key)), cells_(std::move(cells)) {}
+
+  /**
+   * The cells sorted by family name and column qualifier.
+   *
+   * If the cells are already sorted `order` is empty, otherwise it holds
+   * the indices of the cells in sorted order.
+   */
+  struct Index {
+    std::vector<std::size_t> order;
+  };
+
+  /// Return the index, building it if needed.
+  std::shared_ptr<Index const> GetIndex() const;
+
+  /// Return the range of cells that match @p family and (optionally) @p
+  /// qualifier.
+  CellRange EqualRange(std::string const& family,
+                       std::string const* qualifier) const;
+
+  std::shared_ptr<std::string const> row_key_;
   std::vector<Cell> cells_;
+  /// Built on demand by the lookup functions.
+  mutable std::shared_ptr<Index const> index_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -0,0 +1,76 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/row_batch.h"
+#include <algorithm>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace {
+/**
+ * The maximum number of qualifiers kept by `clear()`.
+ *
+ * Scans over tables that use the column qualifiers as data (e.g. timestamps)
+ * would otherwise accumulate all the qualifiers in the table.
+ */
+constexpr std::size_t kMaxInternedNames = 1024;
+}  // anonymous namespace
+
+void RowBatch::clear() {
+  data_.clear();
+  row_key_offsets_.clear();
+  row_key_sizes_.clear();
+  row_cell_offsets_.assign(1, 0);
+  family_ids_.clear();
+  qualifier_ids_.clear();
+  timestamps_.clear();
+  value_offsets_.clear();
+  value_sizes_.clear();
+  labels_.clear();
+  if (qualifiers_.size() > kMaxInternedNames) {
+    qualifiers_.clear();
+    qualifier_index_.clear();
+  }
+}
+
+std::uint32_t RowBatch::FindOrAdd(
+    std::unordered_map<std::string, std::uint32_t>& index,
+    std::vector<std::string>& names, std::string const& name) {
+  auto it = index.find(name);
+  if (it != index.end()) {
+    return it->second;
+  }
+  auto id = static_cast<std::uint32_t>(names.size());
+  names.push_back(name);
+  index.emplace(name, id);
+  return id;
+}
+
+void RowBatch::Truncate(std::size_t cell, std::size_t data_size) {
+  data_.resize(data_size);
+  family_ids_.resize(cell);
+  qualifier_ids_.resize(cell);
+  timestamps_.resize(cell);
+  value_offsets_.resize(cell);
+  value_sizes_.resize(cell);
+  auto first_label = std::lower_bound(
+      labels_.begin(), labels_.end(), cell,
+      [](std::pair<std::size_t, std::string> const& label, std::size_t c) {
+        return label.first < c;
+      });
+  labels_.erase(first_label, labels_.end());
+}
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
@@ -0,0 +1,179 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_BATCH_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_BATCH_H_
+
+#include "bigtable/client/version.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class RowBatchBuilder;
+}  // namespace internal
+
+/**
+ * A batch of rows in columnar (struct-of-arrays) format.
+ *
+ * Analytic scans often copy the values of each cell into column vectors, and
+ * discard the `Row` and `Cell` objects immediately.  `RowReader::NextBatch()`
+ * can instead parse the response data directly into this class, which stores
+ * each attribute of the rows and cells in its own array:
+ *
+ * - The row keys and cell values are stored back to back in a single buffer,
+ *   `data()`, the rows and cells hold offsets and sizes into it.
+ * - The family names and column qualifiers are replaced by small integer ids,
+ *   the names can be found in `family_names()` and `qualifiers()`.
+ * - The cells of row `i` are the cells in the range
+ *   `[row_cell_offsets()[i], row_cell_offsets()[i + 1])`.
+ *
+ * @code
+ * bigtable::RowBatch batch;
+ * while (reader.NextBatch(batch, 1000)) {
+ *   for (std::size_t i = 0; i != batch.cell_count(); ++i) {
+ *     total += batch.value_sizes()[i];
+ *   }
+ * }
+ * @endcode
+ *
+ * The ids are assigned in the order the names are first seen, and they are
+ * preserved by `clear()`, so they are stable across the batches filled by the
+ * same reader into the same object.  The exception are tables that use the
+ * column qualifiers as data (e.g. timestamps): once there are more than 1024
+ * qualifiers `clear()` discards the qualifier dictionary, so it does not grow
+ * without bound, and the qualifier ids start again from 0.
+ */
+class RowBatch {
+ public:
+  RowBatch() : row_cell_offsets_(1, 0) {}
+
+  /// The number of rows in the batch.
+  std::size_t row_count() const { return row_key_offsets_.size(); }
+  /// The number of cells in the batch, across all rows.
+  std::size_t cell_count() const { return timestamps_.size(); }
+  /// True if there are no rows in the batch.
+  bool empty() const { return row_key_offsets_.empty(); }
+
+  /// The buffer holding all the row keys and values.
+  std::string const& data() const { return data_; }
+
+  //@{
+  /// @name Per-row arrays, all of them with `row_count()` elements.
+  std::vector<std::size_t> const& row_key_offsets() const {
+    return row_key_offsets_;
+  }
+  std::vector<std::size_t> const& row_key_sizes() const {
+    return row_key_sizes_;
+  }
+  //@}
+
+  /**
+   * The index of the first cell in each row.
+   *
+   * This array has `row_count() + 1` elements, the last one is
+   * `cell_count()`.
+   */
+  std::vector<std::size_t> const& row_cell_offsets() const {
+    return row_cell_offsets_;
+  }
+
+  //@{
+  /// @name Per-cell arrays, all of them with `cell_count()` elements.
+  std::vector<std::uint32_t> const& family_ids() const { return family_ids_; }
+  std::vector<std::uint32_t> const& qualifier_ids() const {
+    return qualifier_ids_;
+  }
+  std::vector<std::int64_t> const& timestamps() const { return timestamps_; }
+  std::vector<std::size_t> const& value_offsets() const {
+    return value_offsets_;
+  }
+  std::vector<std::size_t> const& value_sizes() const { return value_sizes_; }
+  //@}
+
+  /**
+   * The labels attached to the cells, as (cell index, label) pairs.
+   *
+   * Labels are only present when using `Filter::Label()`, so they are stored
+   * separately, sorted by cell index.
+   */
+  std::vector<std::pair<std::size_t, std::string>> const& labels() const {
+    return labels_;
+  }
+
+  //@{
+  /// @name Dictionaries to map ids to names.
+  std::vector<std::string> const& family_names() const {
+    return family_names_;
+  }
+  std::vector<std::string> const& qualifiers() const { return qualifiers_; }
+  //@}
+
+  //@{
+  /// @name Convenience functions, these copy the data.
+  std::string row_key(std::size_t row) const {
+    return data_.substr(row_key_offsets_[row], row_key_sizes_[row]);
+  }
+  std::string value(std::size_t cell) const {
+    return data_.substr(value_offsets_[cell], value_sizes_[cell]);
+  }
+  //@}
+
+  /**
+   * Remove all the rows and cells, keeping the allocated memory and ids.
+   *
+   * The qualifier ids are discarded if there are too many of them, see the
+   * class documentation.
+   */
+  void clear();
+
+ private:
+  friend class internal::RowBatchBuilder;
+
+  /// Return the id for @p name in @p names, adding it if needed.
+  static std::uint32_t FindOrAdd(
+      std::unordered_map<std::string, std::uint32_t>& index,
+      std::vector<std::string>& names, std::string const& name);
+
+  /// Remove the cells (and their data) starting at @p cell and @p data_size.
+  void Truncate(std::size_t cell, std::size_t data_size);
+
+  std::string data_;
+
+  std::vector<std::size_t> row_key_offsets_;
+  std::vector<std::size_t> row_key_sizes_;
+  std::vector<std::size_t> row_cell_offsets_;
+
+  std::vector<std::uint32_t> family_ids_;
+  std::vector<std::uint32_t> qualifier_ids_;
+  std::vector<std::int64_t> timestamps_;
+  std::vector<std::size_t> value_offsets_;
+  std::vector<std::size_t> value_sizes_;
+  std::vector<std::pair<std::size_t, std::string>> labels_;
+
+  std::vector<std::string> family_names_;
+  std::unordered_map<std::string, std::uint32_t> family_index_;
+  std::vector<std::string> qualifiers_;
+  std::unordered_map<std::string, std::uint32_t> qualifier_index_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_BATCH_H_
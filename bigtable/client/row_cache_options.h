@@ -0,0 +1,120 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_CACHE_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_CACHE_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for `Table::EnableRowCache()`.
+ *
+ * @code
+ * table.EnableRowCache(bigtable::RowCacheOptions()
+ *                          .set_max_bytes(256 * 1024 * 1024)
+ *                          .set_ttl(std::chrono::seconds(30)));
+ * @endcode
+ */
+class RowCacheOptions {
+ public:
+  RowCacheOptions()
+      : max_bytes_(64 * 1024 * 1024),
+        ttl_(std::chrono::seconds(10)),
+        shard_count_(16) {}
+
+  /**
+   * Set the maximum size of the cached rows.
+   *
+   * The limit is split evenly among the shards, each shard evicts its least
+   * recently used rows when its share is exceeded.  The size of a row is
+   * estimated from the size of its key, column names and values.
+   */
+  RowCacheOptions& set_max_bytes(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "RowCacheOptions::set_max_bytes requires n > 0");
+    }
+    max_bytes_ = n;
+    return *this;
+  }
+  /// Return the maximum size of the cached rows.
+  std::size_t max_bytes() const { return max_bytes_; }
+
+  /**
+   * Set how long a row stays in the cache.
+   *
+   * Mutations applied through the same `Table` object invalidate the cached
+   * rows immediately, but changes made by other clients are only observed
+   * after the entry expires.
+   */
+  RowCacheOptions& set_ttl(std::chrono::milliseconds ttl) {
+    ttl_ = ttl;
+    return *this;
+  }
+  /// Return how long a row stays in the cache.
+  std::chrono::milliseconds ttl() const { return ttl_; }
+
+  /**
+   * Set the number of shards.
+   *
+   * Each shard has its own lock, use more shards to reduce contention when
+   * many threads read from the same table.
+   */
+  RowCacheOptions& set_shard_count(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "RowCacheOptions::set_shard_count requires n > 0");
+    }
+    shard_count_ = n;
+    return *this;
+  }
+  /// Return the number of shards.
+  std::size_t shard_count() const { return shard_count_; }
+
+ private:
+  std::size_t max_bytes_;
+  std::chrono::milliseconds ttl_;
+  std::size_t shard_count_;
+};
+
+/// Counters reported by `Table::row_cache_stats()`.
+struct RowCacheStats {
+  /// The number of `ReadRow()` calls served from the cache.
+  std::int64_t hits;
+  /// The number of `ReadRow()` calls sent to the server.
+  std::int64_t misses;
+  /// The number of rows removed to stay within the size limit.
+  std::int64_t evictions;
+  /// The number of rows removed because they were mutated.
+  std::int64_t invalidations;
+  /// The number of rows removed because their TTL expired.
+  std::int64_t expirations;
+  /// The estimated size of the cached rows.
+  std::size_t bytes;
+  /// The number of cached rows.
+  std::size_t entries;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_CACHE_OPTIONS_H_
@@ -0,0 +1,48 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_KEY_SAMPLE_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_KEY_SAMPLE_H_
+
+#include "bigtable/client/version.h"
+
+#include <cstdint>
+#include <string>
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * A sample of the row keys in a table, as returned by `Table::SampleRowKeys()`.
+ *
+ * The samples delimit contiguous sections of the table of approximately equal
+ * size, typically the tablets, and can be used to break up the data for
+ * distributed or parallel computations.
+ */
+struct RowKeySample {
+  /**
+   * A row key, the samples are returned in increasing row key order.
+   *
+   * The last sample in the table may have an empty row key, representing the
+   * end of the table.
+   */
+  std::string row_key;
+
+  /// Approximate total storage space used by all rows before `row_key`.
+  std::int64_t offset_bytes;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_KEY_SAMPLE_H_
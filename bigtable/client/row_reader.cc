@@ -43,25 +43,36 @@ static_assert(std::is_same<decltype(++std::declval<RowReader::iterator>()),
               "++it when it is of RowReader::iterator type must be a "
               "RowReader::iterator &>");
 
+RowReader::RowReader(std::shared_ptr<DataClient> client,
+                     std::string table_name, RowSet row_set,
+                     std::int64_t rows_limit, Filter filter,
+                     std::unique_ptr<RPCRetryPolicy> retry_policy,
+                     std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+                     RowReaderOptions options)
+    : RowReader(std::move(client), std::move(table_name), std::move(row_set),
+                rows_limit, std::move(filter), std::move(retry_policy),
+                std::move(backoff_policy),
+                std::unique_ptr<internal::ReadRowsParserFactory>(),
+                std::move(options)) {}
+
 RowReader::RowReader(
     std::shared_ptr<DataClient> client, std::string table_name, RowSet row_set,
     std::int64_t rows_limit, Filter filter,
     std::unique_ptr<RPCRetryPolicy> retry_policy,
     std::unique_ptr<RPCBackoffPolicy> backoff_policy,
-    std::unique_ptr<internal::ReadRowsParserFactory> parser_factory)
+    std::unique_ptr<internal::ReadRowsParserFactory> parser_factory,
+    RowReaderOptions options)
     : client_(std::move(client)),
-      table_name_(std::move(table_name)),
-      row_set_(std::move(row_set)),
-      rows_limit_(rows_limit),
-      filter_(std::move(filter)),
+      request_(table_name, std::move(row_set), rows_limit, filter),
       retry_policy_(std::move(retry_policy)),
       backoff_policy_(std::move(backoff_policy)),
+      options_(std::move(options)),
       context_(),
       parser_factory_(std::move(parser_factory)),
       stream_is_open_(false),
       operation_cancelled_(false),
-      processed_chunks_count_(0),
-      rows_count_(0) {}
+      response_(internal::make_unique<ResponseHolder>()),
+      processed_chunks_count_(0) {}
 
 RowReader::iterator RowReader::begin() {
   if (operation_cancelled_) {
@@ -79,44 +90,64 @@ RowReader::iterator RowReader::end() {
 }
 
 void RowReader::MakeRequest() {
-  response_ = {};
-  processed_chunks_count_ = 0;
-
-  google::bigtable::v2::ReadRowsRequest request;
-  request.set_table_name(std::string(table_name_));
-
-  auto row_set_proto = row_set_.as_proto();
-  request.mutable_rows()->Swap(&row_set_proto);
-
-  auto filter_proto = filter_.as_proto();
-  request.mutable_filter()->Swap(&filter_proto);
-
-  if (rows_limit_ != NO_ROWS_LIMIT) {
-    request.set_rows_limit(rows_limit_ - rows_count_);
+  if (read_ahead_) {
+    // The previous stream may still be open (e.g. if the parser rejected its
+    // data), cancel it so the background thread is not blocked on it.
+    context_->TryCancel();
+    read_ahead_.reset();
   }
+  response_->Reset();
+  processed_chunks_count_ = 0;
 
   context_ = bigtable::internal::make_unique<grpc::ClientContext>();
   retry_policy_->setup(*context_);
   backoff_policy_->setup(*context_);
-  stream_ = client_->Stub()->ReadRows(context_.get(), request);
+  stream_ = client_->Stub()->ReadRows(context_.get(), request_.request());
   stream_is_open_ = true;
+  if (options_.read_ahead_responses() != 0) {
+    read_ahead_ = internal::make_unique<internal::ReadAheadReader>(
+        *stream_, options_.read_ahead_responses(),
+        options_.read_ahead_bytes());
+  }
 
-  parser_ = parser_factory_->Create();
+  if (parser_factory_) {
+    injected_parser_ = parser_factory_->Create();
+  } else {
+    parser_ = internal::make_unique<internal::ReadRowsParser>();
+    parser_->set_max_row_bytes(options_.max_row_bytes());
+  }
+  batch_parser_.reset();
+  visitor_parser_.reset();
 }
 
 bool RowReader::NextChunk() {
   ++processed_chunks_count_;
-  while (processed_chunks_count_ >= response_.chunks_size()) {
+  while (processed_chunks_count_ >= response_->get().chunks_size()) {
     processed_chunks_count_ = 0;
-    bool response_is_valid = stream_->Read(&response_);
-    if (not response_is_valid) {
-      response_ = {};
+    if (not ReadResponse()) {
       return false;
     }
   }
   return true;
 }
 
+bool RowReader::ReadResponse() {
+  if (read_ahead_) {
+    // Hand back the consumed response for reuse, and get the next one.
+    if (read_ahead_->Read(response_)) {
+      return true;
+    }
+    // The background thread is done, release it before Finish().
+    read_ahead_.reset();
+    response_->Reset();
+    return false;
+  }
+  // The parser does not keep references into the previous response, so we
+  // can release it and reuse the arena for the next one.
+  response_->Reset();
+  return stream_->Read(&response_->get());
+}
+
 void RowReader::Advance(internal::OptionalRow& row) {
   while (true) {
     grpc::Status status = grpc::Status::OK;
@@ -132,87 +163,440 @@ void RowReader::Advance(internal::OptionalRow& row) {
     status = AdvanceOrFail(row);
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
-    if (status.ok()) {
+    if (status.ok() or not RestartAfterFailure(status)) {
       return;
     }
+  }
+}
 
-    // In the unlikely case when we have already reached the requested
-    // number of rows and still receive an error (the parser can throw
-    // an error at end of stream for example), there is no need to
-    // retry and we have no good value for rows_limit anyway.
-    if (rows_limit_ != NO_ROWS_LIMIT and rows_limit_ <= rows_count_) {
-      return;
-    }
+bool RowReader::RestartAfterFailure(grpc::Status const& status) {
+  grpc::Status permanent_error;
+  if (RestartAfterFailure(status, permanent_error)) {
+    return true;
+  }
+  if (not permanent_error.ok()) {
+    internal::RaiseRuntimeError("Unretriable error: " +
+                                permanent_error.error_message());
+  }
+  return false;
+}
 
-    if (not last_read_row_key_.empty()) {
-      // We've returned some rows and need to make sure we don't
-      // request them again.
-      row_set_ = row_set_.Intersect(RowRange::Open(last_read_row_key_, ""));
-    }
+bool RowReader::RestartAfterFailure(grpc::Status const& status,
+                                    grpc::Status& permanent_error) {
+  // Skip the rows already returned, and stop if there is nothing left to
+  // retry.
+  if (not request_.PrepareRetry()) {
+    return false;
+  }
 
-    // If we receive an error, but the retriable set is empty, stop.
-    if (row_set_.IsEmpty()) {
-      return;
+  if (not retry_policy_->on_failure(status)) {
+    permanent_error = status;
+    return false;
+  }
+
+  auto delay = backoff_policy_->on_completion(status);
+  std::this_thread::sleep_for(delay);
+
+  // If we reach this place, we failed and need to restart the call.
+  MakeRequest();
+  return true;
+}
+
+grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
+  if (injected_parser_) {
+    return AdvanceOrFail(*injected_parser_, row);
+  }
+  return AdvanceOrFail(*parser_, row);
+}
+
+template <typename Parser>
+grpc::Status RowReader::AdvanceOrFail(Parser& parser,
+                                      internal::OptionalRow& row) {
+  row.reset();
+  grpc::Status status = ParseNextRow(parser);
+  if (not status.ok() or not parser.HasNext()) {
+    return status;
+  }
+
+  // We have a complete row in the parser.
+  row.emplace(parser.Next());
+  request_.OnRow(row.value());
+
+  return grpc::Status::OK;
+}
+
+bool RowReader::Next(Row& row) {
+  if (operation_cancelled_) {
+    internal::RaiseRuntimeError("Operation already cancelled.");
+  }
+  grpc::Status status;
+  bool const has_row = Next(row, status);
+  if (not status.ok()) {
+    internal::RaiseRuntimeError("Unretriable error: " +
+                                status.error_message());
+  }
+  return has_row;
+}
+
+bool RowReader::Next(Row& row, grpc::Status& status) {
+  status = grpc::Status::OK;
+  if (operation_cancelled_) {
+    status = grpc::Status(grpc::StatusCode::CANCELLED,
+                          "Operation already cancelled.");
+    return false;
+  }
+  if (not stream_) {
+    MakeRequest();
+  } else if (not stream_is_open_) {
+    return false;
+  }
+
+  while (true) {
+    bool has_row = false;
+    grpc::Status stream_status = grpc::Status::OK;
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      stream_status = NextOrFail(row, has_row);
+    } catch (std::exception const& ex) {
+      // Parser exceptions arrive here.
+      stream_status = grpc::Status(grpc::INTERNAL, ex.what());
     }
+#else
+    stream_status = NextOrFail(row, has_row);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
-    if (not status.ok() and not retry_policy_->on_failure(status)) {
-      internal::RaiseRuntimeError("Unretriable error: " +
-                                  status.error_message());
+    if (has_row) {
+      return true;
+    }
+    if (stream_status.ok() or
+        not RestartAfterFailure(stream_status, status)) {
+      return false;
     }
+  }
+}
 
-    auto delay = backoff_policy_->on_completion(status);
-    std::this_thread::sleep_for(delay);
+grpc::Status RowReader::NextOrFail(Row& row, bool& has_row) {
+  if (injected_parser_) {
+    return NextOrFail(*injected_parser_, row, has_row);
+  }
+  return NextOrFail(*parser_, row, has_row);
+}
 
-    // If we reach this place, we failed and need to restart the call.
-    MakeRequest();
+template <typename Parser>
+grpc::Status RowReader::NextOrFail(Parser& parser, Row& row, bool& has_row) {
+  grpc::Status status = ParseNextRow(parser);
+  if (not status.ok() or not parser.HasNext()) {
+    return status;
   }
+
+  parser.Next(row);
+  has_row = true;
+  request_.OnRow(row);
+
+  return grpc::Status::OK;
 }
 
-grpc::Status RowReader::AdvanceOrFail(internal::OptionalRow& row) {
-  row.reset();
-  while (not parser_->HasNext()) {
+template <typename Parser>
+grpc::Status RowReader::ParseNextRow(Parser& parser) {
+  while (not parser.HasNext()) {
     if (NextChunk()) {
-      parser_->HandleChunk(
-          std::move(*(response_.mutable_chunks(processed_chunks_count_))));
+      parser.ConsumeChunk(
+          *(response_->get().mutable_chunks(processed_chunks_count_)));
       continue;
     }
 
     // Here, there are no more chunks to look at. Close the stream,
     // finalize the parser and return OK with no rows unless something
     // fails during cleanup.
-    stream_is_open_ = false;
-    grpc::Status status = stream_->Finish();
-    if (not status.ok()) {
-      return status;
+    grpc::Status status = FinishStream();
+    if (status.ok()) {
+      parser.HandleEndOfStream();
     }
-    parser_->HandleEndOfStream();
-    return grpc::Status::OK;
+    return status;
   }
+  return grpc::Status::OK;
+}
 
-  // We have a complete row in the parser.
-  row.emplace(parser_->Next());
-  ++rows_count_;
-  last_read_row_key_ = std::string(row.value().row_key());
+bool RowReader::NextBatch(std::vector<Row>& out, std::size_t max_rows,
+                          std::size_t max_bytes) {
+  out.clear();
+  if (max_rows == 0) {
+    internal::RaiseInvalidArgument("NextBatch() requires max_rows > 0");
+  }
+  if (operation_cancelled_) {
+    internal::RaiseRuntimeError("Operation already cancelled.");
+  }
+  if (not stream_) {
+    MakeRequest();
+  } else if (not stream_is_open_) {
+    return false;
+  }
+
+  while (true) {
+    auto const previous_size = out.size();
+    grpc::Status status = grpc::Status::OK;
 
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      status = FillBatchOrFail(out, max_rows, max_bytes);
+    } catch (std::exception const& ex) {
+      // Parser exceptions arrive here.
+      status = grpc::Status(grpc::INTERNAL, ex.what());
+    }
+#else
+    status = FillBatchOrFail(out, max_rows, max_bytes);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+    // Update the bookkeeping for retries once per batch, including the rows
+    // received before any failure.
+    if (out.size() != previous_size) {
+      request_.OnRows(static_cast<std::int64_t>(out.size() - previous_size),
+                      out.back().row_key());
+    }
+
+    if (status.ok() or not RestartAfterFailure(status)) {
+      return not out.empty();
+    }
+    if (not out.empty()) {
+      // The rows received so far are valid, return them and continue with
+      // the new stream in the next call.
+      return true;
+    }
+  }
+}
+
+grpc::Status RowReader::FillBatchOrFail(std::vector<Row>& out,
+                                        std::size_t max_rows,
+                                        std::size_t max_bytes) {
+  if (injected_parser_) {
+    return FillBatchOrFail(*injected_parser_, out, max_rows, max_bytes);
+  }
+  return FillBatchOrFail(*parser_, out, max_rows, max_bytes);
+}
+
+template <typename Parser>
+grpc::Status RowReader::FillBatchOrFail(Parser& parser, std::vector<Row>& out,
+                                        std::size_t max_rows,
+                                        std::size_t max_bytes) {
+  std::size_t bytes = 0;
+  while (out.size() < max_rows and bytes < max_bytes) {
+    if (parser.HasNext()) {
+      out.emplace_back(parser.Next());
+      bytes += EstimatedSize(out.back());
+      continue;
+    }
+    // Once we have some rows, only parse the data already received, do not
+    // block waiting for more.
+    if (not out.empty() and
+        processed_chunks_count_ + 1 >= response_->get().chunks_size()) {
+      break;
+    }
+    if (NextChunk()) {
+      parser.ConsumeChunk(
+          *(response_->get().mutable_chunks(processed_chunks_count_)));
+      continue;
+    }
+    grpc::Status status = FinishStream();
+    if (status.ok()) {
+      parser.HandleEndOfStream();
+    }
+    return status;
+  }
   return grpc::Status::OK;
 }
 
+bool RowReader::NextBatch(RowBatch& batch, std::size_t max_rows,
+                          std::size_t max_bytes) {
+  batch.clear();
+  if (max_rows == 0) {
+    internal::RaiseInvalidArgument("NextBatch() requires max_rows > 0");
+  }
+  if (operation_cancelled_) {
+    internal::RaiseRuntimeError("Operation already cancelled.");
+  }
+  if (not stream_) {
+    MakeRequest();
+  } else if (not stream_is_open_) {
+    return false;
+  }
+
+  while (true) {
+    auto const previous_rows = batch.row_count();
+    grpc::Status status = grpc::Status::OK;
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      status = FillRowBatchOrFail(batch, max_rows, max_bytes);
+    } catch (std::exception const& ex) {
+      // Parser exceptions arrive here.
+      status = grpc::Status(grpc::INTERNAL, ex.what());
+    }
+#else
+    status = FillRowBatchOrFail(batch, max_rows, max_bytes);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+    if (not status.ok()) {
+      // The new stream restarts from the last committed row.
+      batch_parser_->DiscardPartialRow(batch);
+    }
+    if (batch.row_count() != previous_rows) {
+      request_.OnRows(
+          static_cast<std::int64_t>(batch.row_count() - previous_rows),
+          batch.row_key(batch.row_count() - 1));
+    }
+
+    if (status.ok() or not RestartAfterFailure(status)) {
+      return not batch.empty();
+    }
+    if (not batch.empty()) {
+      return true;
+    }
+  }
+}
+
+grpc::Status RowReader::FillRowBatchOrFail(RowBatch& batch,
+                                           std::size_t max_rows,
+                                           std::size_t max_bytes) {
+  if (not batch_parser_) {
+    batch_parser_ = internal::make_unique<internal::RowBatchParser>();
+    batch_parser_->set_max_row_bytes(options_.max_row_bytes());
+  }
+  while (true) {
+    // Only stop at row boundaries, the rest of a partial row may be
+    // appended to a different batch in the next call.
+    if (not batch.empty() and not batch_parser_->row_in_progress()) {
+      if (batch.row_count() >= max_rows or batch.data().size() >= max_bytes) {
+        break;
+      }
+      // Once we have some rows, only parse the data already received.
+      if (processed_chunks_count_ + 1 >= response_->get().chunks_size()) {
+        break;
+      }
+    }
+    if (NextChunk()) {
+      batch_parser_->Consume(
+          *(response_->get().mutable_chunks(processed_chunks_count_)), batch);
+      continue;
+    }
+    grpc::Status status = FinishStream();
+    if (status.ok()) {
+      batch_parser_->HandleEndOfStream();
+    }
+    return status;
+  }
+  return grpc::Status::OK;
+}
+
+std::size_t RowReader::EstimatedSize(Row const& row) {
+  std::size_t size = row.row_key().size();
+  for (auto const& cell : row.cells()) {
+    size += cell.family_name().size() + cell.column_qualifier().size() +
+            cell.value().size() + sizeof(std::int64_t);
+  }
+  return size;
+}
+
+grpc::Status RowReader::FinishStream() {
+  stream_is_open_ = false;
+  return stream_->Finish();
+}
+
+void RowReader::Visit(CellVisitor& visitor) {
+  if (operation_cancelled_) {
+    internal::RaiseRuntimeError("Operation already cancelled.");
+  }
+  if (not stream_) {
+    MakeRequest();
+  } else if (not stream_is_open_) {
+    return;
+  }
+
+  while (true) {
+    grpc::Status status = grpc::Status::OK;
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      status = VisitOrFail(visitor);
+    } catch (internal::ParserError const& ex) {
+      // Only invalid responses become a (retryable) status, exceptions raised
+      // by the visitor propagate to the application unchanged.
+      status = grpc::Status(grpc::INTERNAL, ex.what());
+    }
+#else
+    status = VisitOrFail(visitor);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+    // The rows are not copied, so the bookkeeping for retries uses the
+    // parser state, and it is only updated once per stream.
+    request_.OnRows(visitor_parser_->TakeCommittedRows(),
+                    visitor_parser_->last_seen_row_key());
+    if (not status.ok()) {
+      // The new stream restarts from the last committed row.
+      visitor_parser_->DiscardPartialRow(visitor);
+    }
+
+    if (status.ok() or not RestartAfterFailure(status)) {
+      return;
+    }
+  }
+}
+
+grpc::Status RowReader::VisitOrFail(CellVisitor& visitor) {
+  if (not visitor_parser_) {
+    visitor_parser_ = internal::make_unique<internal::CellVisitorParser>();
+    visitor_parser_->set_max_row_bytes(options_.max_row_bytes());
+  }
+  while (NextChunk()) {
+    visitor_parser_->Consume(
+        *(response_->get().mutable_chunks(processed_chunks_count_)), visitor);
+  }
+  grpc::Status status = FinishStream();
+  if (status.ok()) {
+    visitor_parser_->HandleEndOfStream();
+  }
+  return status;
+}
+
 void RowReader::Cancel() {
   operation_cancelled_ = true;
   if (not stream_is_open_) {
     return;
   }
+  // Once the call is cancelled the status is available immediately, there is
+  // no need to read (and discard) the rest of the data before Finish().
   context_->TryCancel();
-
-  // Also drain any data left unread
-  google::bigtable::v2::ReadRowsResponse response;
-  while (stream_->Read(&response)) {
-  }
+  // Stop the background thread before using the stream in this thread, its
+  // pending Read() returns as soon as the call is cancelled.
+  read_ahead_.reset();
+  // Release the buffered data now, the reader may be kept around.
+  response_->Reset();
+  processed_chunks_count_ = 0;
 
   stream_is_open_ = false;
   (void)stream_->Finish();  // ignore errors
 }
 
+std::size_t RowReader::buffered_bytes() const {
+  std::size_t bytes = 0;
+  if (read_ahead_) {
+    bytes += read_ahead_->buffered_bytes();
+  }
+  if (response_) {
+    // The chunks already parsed no longer hold their data, so this is
+    // (approximately) the size of the data not yet parsed.
+    bytes += response_->get().ByteSizeLong();
+  }
+  if (visitor_parser_) {
+    bytes += visitor_parser_->partial_row_bytes();
+  } else if (batch_parser_) {
+    bytes += batch_parser_->partial_row_bytes();
+  } else if (parser_) {
+    bytes += parser_->partial_row_bytes();
+  }
+  return bytes;
+}
+
 RowReader::~RowReader() {
   // Make sure we don't leave open streams.
   Cancel();
@@ -19,11 +19,21 @@
 #include <grpc++/grpc++.h>
 #include <cinttypes>
 #include <iterator>
+#include <limits>
+#include <vector>
+#include "bigtable/client/cell_visitor.h"
 #include "bigtable/client/data_client.h"
 #include "bigtable/client/filters.h"
+#include "bigtable/client/internal/arena_message.h"
+#include "bigtable/client/internal/cell_visitor_parser.h"
+#include "bigtable/client/internal/read_ahead_reader.h"
 #include "bigtable/client/internal/readrowsparser.h"
+#include "bigtable/client/internal/resumable_request.h"
+#include "bigtable/client/internal/row_batch_parser.h"
 #include "bigtable/client/internal/rowreaderiterator.h"
 #include "bigtable/client/row.h"
+#include "bigtable/client/row_batch.h"
+#include "bigtable/client/row_reader_options.h"
 #include "bigtable/client/row_set.h"
 #include "bigtable/client/rpc_backoff_policy.h"
 #include "bigtable/client/rpc_retry_policy.h"
@@ -49,7 +59,22 @@ class RowReader {
             RowSet row_set, std::int64_t rows_limit, Filter filter,
             std::unique_ptr<RPCRetryPolicy> retry_policy,
             std::unique_ptr<RPCBackoffPolicy> backoff_policy,
-            std::unique_ptr<internal::ReadRowsParserFactory> parser_factory);
+            RowReaderOptions options = RowReaderOptions());
+
+  /**
+   * Create a reader that uses the parsers returned by @p parser_factory.
+   *
+   * This is only intended for tests, the other constructors use a
+   * `ReadRowsParser` without any virtual function calls.  The parsers created
+   * by @p parser_factory are only used by the iterators and the
+   * `NextBatch(std::vector<Row>&, ...)` function.
+   */
+  RowReader(std::shared_ptr<DataClient> client, std::string table_name,
+            RowSet row_set, std::int64_t rows_limit, Filter filter,
+            std::unique_ptr<RPCRetryPolicy> retry_policy,
+            std::unique_ptr<RPCBackoffPolicy> backoff_policy,
+            std::unique_ptr<internal::ReadRowsParserFactory> parser_factory,
+            RowReaderOptions options = RowReaderOptions());
   RowReader(RowReader&& rhs) noexcept = default;
 
   ~RowReader();
@@ -77,13 +102,136 @@ class RowReader {
   /// End iterator over the rows in the response.
   iterator end();
 
+  /**
+   * Read the next row into @p row, reusing the memory of its previous contents.
+   *
+   * This is an alternative to the iterators for scans that process one row at
+   * a time.  The reader keeps the cells of the previous contents of @p row,
+   * and overwrites them with the data of the following rows, so a loop like:
+   *
+   * @code
+   * bigtable::Row row("", {});
+   * while (reader.Next(row)) {
+   *   Process(row);
+   * }
+   * @endcode
+   *
+   * does not allocate memory for each row when the rows are of similar shape.
+   * Any references to the cells of @p row are invalidated by the call.
+   *
+   * Retry and backoff policies are honored.  Mixing this function with the
+   * iterators or `NextBatch()` on the same RowReader is unsupported.
+   *
+   * @return false if there are no more rows, in which case @p row is not
+   *     modified.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   */
+  bool Next(Row& row);
+
+  /**
+   * Read the next row into @p row, reporting errors in @p status.
+   *
+   * Like `Next(Row&)`, but it does not raise an exception when the read
+   * fails after retries (or was cancelled), instead it returns false and
+   * @p status contains the error.  @p status is OK when the function returns
+   * true, or when there are no more rows.
+   */
+  bool Next(Row& row, grpc::Status& status);
+
+  /**
+   * Read the next batch of rows.
+   *
+   * Blocks until at least one row is available, then returns all the rows
+   * that can be parsed from the data already received, up to @p max_rows
+   * rows and (approximately) @p max_bytes bytes.  This avoids the per-row
+   * overhead of the iterators, and updates the bookkeeping for retries once
+   * per batch.
+   *
+   * Retry and backoff policies are honored.  Mixing this function with the
+   * iterators on the same RowReader is unsupported.
+   *
+   * @param out the rows are returned here, any previous contents are
+   *     discarded.  Reusing the same vector across calls avoids reallocations.
+   * @param max_rows the maximum number of rows in the batch, must be > 0.
+   * @param max_bytes stop adding rows to the batch once their estimated size
+   *     reaches this value.  The batch always has at least one row.
+   * @return false if there are no more rows, in which case @p out is empty.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   * @throws std::invalid_argument if @p max_rows is 0.
+   */
+  bool NextBatch(std::vector<Row>& out, std::size_t max_rows,
+                 std::size_t max_bytes =
+                     std::numeric_limits<std::size_t>::max());
+
+  /**
+   * Read the next batch of rows in columnar format.
+   *
+   * Like `NextBatch(std::vector<Row>&, ...)`, but the response data is
+   * parsed directly into @p batch, without creating `Row` or `Cell` objects.
+   * Rows are never split across batches, so a batch may contain more data
+   * than received at the time of the call.
+   *
+   * @param batch the rows are returned here, any previous rows are
+   *     discarded.  Reusing the same object across calls avoids
+   *     reallocations and keeps the family and qualifier ids stable (see
+   *     `RowBatch` for the limits on the number of qualifiers).
+   * @param max_rows the maximum number of rows in the batch, must be > 0.
+   * @param max_bytes stop adding rows to the batch once the size of their
+   *     keys and values reaches this value.  The batch always has at least
+   *     one row.
+   * @return false if there are no more rows, in which case @p batch is
+   *     empty.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   * @throws std::invalid_argument if @p max_rows is 0.
+   */
+  bool NextBatch(RowBatch& batch, std::size_t max_rows,
+                 std::size_t max_bytes =
+                     std::numeric_limits<std::size_t>::max());
+
+  /**
+   * Report all the remaining cells in the response to @p visitor.
+   *
+   * The cells are passed to the visitor as the response data is parsed,
+   * without creating `Row` or `Cell` objects.  If a stream fails in the
+   * middle of a row the visitor receives `OnRowReset()` for that row, and
+   * the row is reported again by the retried stream.
+   *
+   * Retry and backoff policies are honored.  Mixing this function with the
+   * iterators or `NextBatch()` on the same RowReader is unsupported.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   *     Exceptions raised by @p visitor propagate unchanged, and the read
+   *     is not retried.
+   */
+  void Visit(CellVisitor& visitor);
+
   /**
    * Gracefully terminate a streaming read.
    *
+   * Cancels the streaming RPC and returns promptly, any data not yet consumed
+   * is discarded without reading the rest of the stream.  The destructor
+   * calls this function, so abandoning a large scan is cheap.
+   *
    * Invalidates iterators.
    */
   void Cancel();
 
+  /**
+   * Return the approximate memory used by the data buffered in this reader.
+   *
+   * This includes the responses received ahead of the application (see
+   * `RowReaderOptions::read_ahead_bytes()`), the unparsed part of the current
+   * response, and the data received for the row in progress.  Rows already
+   * returned to the application are not included.
+   *
+   * Like the rest of this class, it must be called from the thread consuming
+   * the rows.
+   */
+  std::size_t buffered_bytes() const;
+
  private:
   /**
    * Read and parse the next row in the response.
@@ -98,6 +246,67 @@ class RowReader {
   /// Called by Advance(), does not handle retries.
   grpc::Status AdvanceOrFail(internal::OptionalRow& row);
 
+  /// Implement AdvanceOrFail() for the production and the test parsers.
+  template <typename Parser>
+  grpc::Status AdvanceOrFail(Parser& parser, internal::OptionalRow& row);
+
+  /// Called by Next(Row&), does not handle retries.
+  grpc::Status NextOrFail(Row& row, bool& has_row);
+
+  /// Implement NextOrFail() for the production and the test parsers.
+  template <typename Parser>
+  grpc::Status NextOrFail(Parser& parser, Row& row, bool& has_row);
+
+  /**
+   * Parse chunks until @p parser has a complete row or the stream ends.
+   *
+   * Returns the status of the stream if it ended, OK otherwise.
+   */
+  template <typename Parser>
+  grpc::Status ParseNextRow(Parser& parser);
+
+  /**
+   * Prepare a new request after @p status terminated the current stream.
+   *
+   * Returns false if the read is complete, i.e., there is nothing left to
+   * retry.  Sleeps according to the backoff policy before making the new
+   * request.
+   *
+   * @throws std::runtime_error if the retry policy rejects the error.
+   */
+  bool RestartAfterFailure(grpc::Status const& status);
+
+  /**
+   * Like `RestartAfterFailure(grpc::Status const&)`, but does not raise.
+   *
+   * If the retry policy rejects the error this returns false, and sets
+   * @p permanent_error to @p status.
+   */
+  bool RestartAfterFailure(grpc::Status const& status,
+                           grpc::Status& permanent_error);
+
+  /// Called by NextBatch(), does not handle retries.
+  grpc::Status FillBatchOrFail(std::vector<Row>& out, std::size_t max_rows,
+                               std::size_t max_bytes);
+
+  /// Implement FillBatchOrFail() for the production and the test parsers.
+  template <typename Parser>
+  grpc::Status FillBatchOrFail(Parser& parser, std::vector<Row>& out,
+                               std::size_t max_rows, std::size_t max_bytes);
+
+  /// Called by NextBatch(RowBatch&, ...), does not handle retries.
+  grpc::Status FillRowBatchOrFail(RowBatch& batch, std::size_t max_rows,
+                                  std::size_t max_bytes);
+
+  /// Called by Visit(), does not handle retries.
+  grpc::Status VisitOrFail(CellVisitor& visitor);
+
+  /// Approximate size of a row, used to limit the size of a batch.
+  static std::size_t EstimatedSize(Row const& row);
+
+  /// Close the stream after the last chunk, return its final status.
+  grpc::Status FinishStream();
+
   /**
    * Move the `processed_chunks_count_` index to the next chunk,
    * reading data if needed.
@@ -106,41 +315,49 @@ class RowReader {
    *
    * This call is used internally by AdvanceOrFail to prepare data for
    * parsing. When it returns true, the value of
-   * `response_.chunks(processed_chunks_count_)` is valid and holds
+   * `response_->get().chunks(processed_chunks_count_)` is valid and holds
    * the next chunk to parse.
    */
   bool NextChunk();
 
+  /// Receive the next response from the stream, or from the read-ahead queue.
+  bool ReadResponse();
+
   /// Sends the ReadRows request to the stub.
   void MakeRequest();
 
   std::shared_ptr<DataClient> client_;
-  std::string table_name_;
-  RowSet row_set_;
-  std::int64_t rows_limit_;
-  Filter filter_;
+  /// The request, updated to skip the rows already received on retries.
+  internal::ResumableRequest request_;
   std::unique_ptr<RPCRetryPolicy> retry_policy_;
   std::unique_ptr<RPCBackoffPolicy> backoff_policy_;
+  RowReaderOptions options_;
 
   std::unique_ptr<grpc::ClientContext> context_;
 
+  /// Creates `injected_parser_` in tests, null otherwise.
   std::unique_ptr<internal::ReadRowsParserFactory> parser_factory_;
   std::unique_ptr<internal::ReadRowsParser> parser_;
+  std::unique_ptr<internal::ReadRowsParserInterface> injected_parser_;
+  /// The parser used by NextBatch(RowBatch&, ...), created on demand.
+  std::unique_ptr<internal::RowBatchParser> batch_parser_;
+  /// The parser used by Visit(), created on demand.
+  std::unique_ptr<internal::CellVisitorParser> visitor_parser_;
   std::unique_ptr<
       grpc::ClientReaderInterface<google::bigtable::v2::ReadRowsResponse>>
       stream_;
+  /// Receives the responses ahead of the parser, if read-ahead is enabled.
+  std::unique_ptr<internal::ReadAheadReader> read_ahead_;
   bool stream_is_open_;
   bool operation_cancelled_;
 
+  using ResponseHolder =
+      internal::ArenaMessage<google::bigtable::v2::ReadRowsResponse>;
   /// The last received response, chunks are being parsed one by one from it.
-  google::bigtable::v2::ReadRowsResponse response_;
+  /// It lives in an arena reused for all the responses in this reader.
+  std::unique_ptr<ResponseHolder> response_;
   /// Number of chunks already parsed in response_.
   int processed_chunks_count_;
-
-  /// Number of rows read so far, used to set row_limit in retries.
-  std::int64_t rows_count_;
-  /// Holds the last read row key, for retries.
-  std::string last_read_row_key_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
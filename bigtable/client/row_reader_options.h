@@ -0,0 +1,120 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_READER_OPTIONS_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_READER_OPTIONS_H_
+
+#include "bigtable/client/version.h"
+
+#include <cstddef>
+#include <limits>
+
+#include "bigtable/client/internal/throw_delegate.h"
+
+namespace bigtable {
+inline namespace BIGTABLE_CLIENT_NS {
+/**
+ * Configuration options for the `RowReader` returned by `Table::ReadRows()`.
+ *
+ * @code
+ * auto reader = table.ReadRows(
+ *     row_set, filter,
+ *     bigtable::RowReaderOptions().set_read_ahead_responses(16));
+ * @endcode
+ *
+ * The memory used by a reader is bounded by two limits: `read_ahead_bytes()`
+ * is a soft limit on the response data buffered by the reader, when it is
+ * reached the reader stops receiving data until the application consumes
+ * some rows.  `max_row_bytes()` is a hard limit on the size of a single row,
+ * the reader fails with an error if a row exceeds it.
+ */
+class RowReaderOptions {
+ public:
+  /// The default value for `read_ahead_bytes()`.
+  static constexpr std::size_t kDefaultReadAheadBytes = 16 * 1024 * 1024;
+
+  /// The default value for `max_row_bytes()`, i.e., no limit.
+  static constexpr std::size_t kDefaultMaxRowBytes =
+      std::numeric_limits<std::size_t>::max();
+
+  RowReaderOptions()
+      : read_ahead_responses_(0),
+        read_ahead_bytes_(kDefaultReadAheadBytes),
+        max_row_bytes_(kDefaultMaxRowBytes) {}
+
+  /**
+   * Enable read-ahead, receiving up to @p n responses ahead of the consumer.
+   *
+   * By default (n == 0) the `RowReader` only reads from the stream when the
+   * application asks for a row that is not buffered yet, so the network,
+   * the parser and the application work take turns.  With read-ahead enabled
+   * a background thread receives the responses into a bounded queue, while
+   * the application consumes the rows from previous responses.
+   */
+  RowReaderOptions& set_read_ahead_responses(std::size_t n) {
+    read_ahead_responses_ = n;
+    return *this;
+  }
+  /// Return the maximum number of responses read ahead, 0 if disabled.
+  std::size_t read_ahead_responses() const { return read_ahead_responses_; }
+
+  /**
+   * Set the maximum number of bytes buffered by read-ahead.
+   *
+   * The background thread stops reading when the (serialized) size of the
+   * responses in the queue, plus the response being parsed, reaches this
+   * value, and resumes once the application consumes the rows.  At least one
+   * response is always buffered, even if it is larger than this limit.
+   */
+  RowReaderOptions& set_read_ahead_bytes(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "RowReaderOptions::set_read_ahead_bytes requires n > 0");
+    }
+    read_ahead_bytes_ = n;
+    return *this;
+  }
+  /// Return the maximum number of bytes buffered by read-ahead.
+  std::size_t read_ahead_bytes() const { return read_ahead_bytes_; }
+
+  /**
+   * Set the maximum size of a row.
+   *
+   * The size of a row is the size of its key, plus the family names, column
+   * qualifiers, values and labels of its cells.  The reader fails with an
+   * error as soon as the data received for a row exceeds this value, without
+   * buffering the rest of the row.  The error is not retried with the
+   * default retry policies.
+   */
+  RowReaderOptions& set_max_row_bytes(std::size_t n) {
+    if (n == 0) {
+      internal::RaiseRangeError(
+          "RowReaderOptions::set_max_row_bytes requires n > 0");
+    }
+    max_row_bytes_ = n;
+    return *this;
+  }
+  /// Return the maximum size of a row.
+  std::size_t max_row_bytes() const { return max_row_bytes_; }
+
+ private:
+  std::size_t read_ahead_responses_;
+  std::size_t read_ahead_bytes_;
+  std::size_t max_row_bytes_;
+};
+
+}  // namespace BIGTABLE_CLIENT_NS
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_ROW_READER_OPTIONS_H_
@@ -23,6 +23,7 @@
 #include <deque>
 #include <initializer_list>
 
+using testing::AtMost;
 using testing::DoAll;
 using testing::Eq;
 using testing::Matcher;
@@ -47,10 +48,10 @@ class MockResponseStream
 using bigtable::Row;
 
 namespace {
-class ReadRowsParserMock : public bigtable::internal::ReadRowsParser {
+class ReadRowsParserMock : public bigtable::internal::ReadRowsParserInterface {
  public:
   MOCK_METHOD1(HandleChunkHook, void(ReadRowsResponse_CellChunk chunk));
-  void HandleChunk(ReadRowsResponse_CellChunk chunk) override {
+  void ConsumeChunk(ReadRowsResponse_CellChunk& chunk) override {
     HandleChunkHook(chunk);
   }
 
@@ -76,10 +77,25 @@ class ReadRowsParserMock : public bigtable::internal::ReadRowsParser {
   std::deque<Row> rows_;
 };
 
+// Forwards to a ReadRowsParser, used once the mocks are exhausted.
+class ForwardingParser : public bigtable::internal::ReadRowsParserInterface {
+ public:
+  void ConsumeChunk(ReadRowsResponse_CellChunk& chunk) override {
+    parser_.ConsumeChunk(chunk);
+  }
+  void HandleEndOfStream() override { parser_.HandleEndOfStream(); }
+  bool HasNext() const override { return parser_.HasNext(); }
+  Row Next() override { return parser_.Next(); }
+
+ private:
+  bigtable::internal::ReadRowsParser parser_;
+};
+
 // Returns a preconfigured set of parsers, so expectations can be set on each.
 class ReadRowsParserMockFactory
     : public bigtable::internal::ReadRowsParserFactory {
-  using ParserPtr = std::unique_ptr<bigtable::internal::ReadRowsParser>;
+  using ParserPtr =
+      std::unique_ptr<bigtable::internal::ReadRowsParserInterface>;
 
  public:
   void AddParser(ParserPtr parser) { parsers_.emplace_back(std::move(parser)); }
@@ -90,7 +106,7 @@ class ReadRowsParserMockFactory
   ParserPtr Create() override {
     CreateHook();
     if (parsers_.empty()) {
-      return ParserPtr(new bigtable::internal::ReadRowsParser);
+      return ParserPtr(new ForwardingParser);
     }
     ParserPtr parser = std::move(parsers_.front());
     parsers_.pop_front();
@@ -234,11 +250,10 @@ TEST_F(RowReaderTest, ReadOneOfTwoRowsClosesStream) {
   {
     testing::InSequence s;
     EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
-    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+    // The call is cancelled, the unread data is not drained.
+    EXPECT_CALL(*stream, Read(_)).Times(0);
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::StatusCode::CANCELLED, "")));
   }
 
   parser_factory_->AddParser(std::move(parser));
@@ -315,6 +330,44 @@ TEST_F(RowReaderTest, FailedStreamWithNoRetryThrows) {
 }
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
+TEST_F(RowReaderTest, FailedStreamWithNoRetryReportsStatus) {
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::INTERNAL, "retry")));
+
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(false));
+    EXPECT_CALL(*backoff_policy_, on_completion_impl(_)).Times(0);
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_));
+
+  bigtable::Row row("", {});
+  grpc::Status status;
+  EXPECT_FALSE(reader.Next(row, status));
+  EXPECT_EQ(grpc::INTERNAL, status.error_code());
+  EXPECT_EQ("retry", status.error_message());
+}
+
+TEST_F(RowReaderTest, NextReportsStatusAfterCancel) {
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), std::move(parser_factory_));
+  reader.Cancel();
+
+  bigtable::Row row("", {});
+  grpc::Status status;
+  EXPECT_FALSE(reader.Next(row, status));
+  EXPECT_EQ(grpc::CANCELLED, status.error_code());
+}
+
 TEST_F(RowReaderTest, FailedStreamRetriesSkipAlreadyReadRows) {
   auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
   auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
@@ -588,11 +641,10 @@ TEST_F(RowReaderTest, BeginThrowsAfterCancelClosesStream) {
   {
     testing::InSequence s;
     EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
-    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
-    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+    // The rest of the stream is not read after the call is cancelled.
+    EXPECT_CALL(*stream, Read(_)).Times(0);
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::StatusCode::CANCELLED, "")));
   }
 
   parser_factory_->AddParser(std::move(parser));
@@ -682,3 +734,378 @@ TEST_F(RowReaderTest, FailedStreamRetryNewContext) {
   EXPECT_EQ(it->row_key(), "r1");
   EXPECT_EQ(++it, reader.end());
 }
+
+TEST_F(RowReaderTest, ReadAheadRetriesSkipAlreadyReadRows) {
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1"});
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(2)))
+        .WillOnce(Return(stream));
+
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::INTERNAL, "retry")));
+
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(true));
+    EXPECT_CALL(*backoff_policy_, on_completion_impl(_))
+        .WillOnce(Return(std::chrono::milliseconds(0)));
+
+    auto stream_retry = new MockResponseStream();  // the stub will free it
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(1)))
+        .WillOnce(Return(stream_retry));
+    EXPECT_CALL(*stream_retry, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet("r1", "r2"),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      std::move(parser_factory_),
+      bigtable::RowReaderOptions().set_read_ahead_responses(4));
+
+  auto it = reader.begin();
+  EXPECT_NE(it, reader.end());
+  EXPECT_EQ(it->row_key(), "r1");
+  EXPECT_EQ(++it, reader.end());
+}
+
+TEST_F(RowReaderTest, ReadAheadCancelStopsBackgroundReader) {
+  auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1"});
+  auto* stream = new MockResponseStream();
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+  // The background thread reads ahead of the consumer, at most until Cancel()
+  // stops it.
+  EXPECT_CALL(*stream, Read(_))
+      .Times(AtMost(4))
+      .WillOnce(Return(true))
+      .WillOnce(Return(true))
+      .WillOnce(Return(true))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), std::move(parser_factory_),
+      bigtable::RowReaderOptions().set_read_ahead_responses(1));
+
+  auto it = reader.begin();
+  EXPECT_NE(it, reader.end());
+  EXPECT_EQ(it->row_key(), "r1");
+  reader.Cancel();
+}
+
+TEST_F(RowReaderTest, NextBatchReturnsBufferedRows) {
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1", "r2", "r3"});
+  EXPECT_CALL(*parser, HandleEndOfStreamHook()).Times(1);
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), std::move(parser_factory_));
+
+  std::vector<Row> batch;
+  ASSERT_TRUE(reader.NextBatch(batch, 10));
+  ASSERT_EQ(3U, batch.size());
+  EXPECT_EQ("r1", batch[0].row_key());
+  EXPECT_EQ("r2", batch[1].row_key());
+  EXPECT_EQ("r3", batch[2].row_key());
+  EXPECT_FALSE(reader.NextBatch(batch, 10));
+  EXPECT_TRUE(batch.empty());
+  // Calling again after the end of the stream is harmless.
+  EXPECT_FALSE(reader.NextBatch(batch, 10));
+}
+
+TEST_F(RowReaderTest, NextBatchHonorsMaxRows) {
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1", "r2", "r3"});
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_), std::move(parser_factory_));
+
+  std::vector<Row> batch;
+  ASSERT_TRUE(reader.NextBatch(batch, 2));
+  ASSERT_EQ(2U, batch.size());
+  EXPECT_EQ("r2", batch[1].row_key());
+  ASSERT_TRUE(reader.NextBatch(batch, 2));
+  ASSERT_EQ(1U, batch.size());
+  EXPECT_EQ("r3", batch[0].row_key());
+  EXPECT_FALSE(reader.NextBatch(batch, 2));
+}
+
+TEST_F(RowReaderTest, NextBatchRetriesSkipAlreadyReadRows) {
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  auto parser = bigtable::internal::make_unique<ReadRowsParserMock>();
+  parser->SetRows({"r1"});
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(2)))
+        .WillOnce(Return(stream));
+
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(true));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::INTERNAL, "retry")));
+
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(true));
+    EXPECT_CALL(*backoff_policy_, on_completion_impl(_))
+        .WillOnce(Return(std::chrono::milliseconds(0)));
+
+    auto stream_retry = new MockResponseStream();  // the stub will free it
+    // The row returned in the first batch is not requested again.
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(1)))
+        .WillOnce(Return(stream_retry));
+    EXPECT_CALL(*stream_retry, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  parser_factory_->AddParser(std::move(parser));
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet("r1", "r2"),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_),
+      std::move(parser_factory_));
+
+  std::vector<Row> batch;
+  ASSERT_TRUE(reader.NextBatch(batch, 10));
+  ASSERT_EQ(1U, batch.size());
+  EXPECT_EQ("r1", batch[0].row_key());
+  EXPECT_FALSE(reader.NextBatch(batch, 10));
+}
+
+namespace {
+ReadRowsResponse_CellChunk MakeChunk(std::string const& row_key,
+                                     std::string const& value, bool commit) {
+  ReadRowsResponse_CellChunk chunk;
+  chunk.set_row_key(row_key);
+  chunk.mutable_family_name()->set_value("fam");
+  chunk.mutable_qualifier()->set_value("qual");
+  chunk.set_timestamp_micros(1000);
+  chunk.set_value(value);
+  chunk.set_commit_row(commit);
+  return chunk;
+}
+}  // anonymous namespace
+
+TEST_F(RowReaderTest, NextRowBatchRetryDiscardsPartialRow) {
+  ReadRowsResponse r1;
+  *r1.add_chunks() = MakeChunk("r1", "v1", true);
+  // r2 is not committed before the stream fails.
+  *r1.add_chunks() = MakeChunk("r2", "partial", false);
+  ReadRowsResponse r2;
+  *r2.add_chunks() = MakeChunk("r2", "v2", true);
+
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(2)))
+        .WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(r1), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::UNAVAILABLE, "retry")));
+
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(true));
+    EXPECT_CALL(*backoff_policy_, on_completion_impl(_))
+        .WillOnce(Return(std::chrono::milliseconds(0)));
+
+    auto stream_retry = new MockResponseStream();  // the stub will free it
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, RequestWithRowKeysCount(1)))
+        .WillOnce(Return(stream_retry));
+    EXPECT_CALL(*stream_retry, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(r2), Return(true)));
+    EXPECT_CALL(*stream_retry, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet("r1", "r2"),
+      bigtable::RowReader::NO_ROWS_LIMIT, bigtable::Filter::PassAllFilter(),
+      std::move(retry_policy_), std::move(backoff_policy_));
+
+  bigtable::RowBatch batch;
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  while (reader.NextBatch(batch, 10)) {
+    for (std::size_t i = 0; i != batch.row_count(); ++i) {
+      keys.push_back(batch.row_key(i));
+    }
+    for (std::size_t i = 0; i != batch.cell_count(); ++i) {
+      values.push_back(batch.value(i));
+    }
+  }
+  EXPECT_EQ((std::vector<std::string>{"r1", "r2"}), keys);
+  EXPECT_EQ((std::vector<std::string>{"v1", "v2"}), values);
+}
+
+TEST_F(RowReaderTest, NextReusesRow) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "v1"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "v2"
+        commit_row: true
+      }
+      )");
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  auto* stream_retry = new MockResponseStream();
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::StatusCode::INTERNAL, "retry")));
+
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(true));
+    EXPECT_CALL(*backoff_policy_, on_completion_impl(_))
+        .WillOnce(Return(std::chrono::milliseconds(0)));
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+        .WillOnce(Return(stream_retry));
+    EXPECT_CALL(*stream_retry, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_));
+
+  bigtable::Row row("", {});
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  while (reader.Next(row)) {
+    keys.push_back(row.row_key());
+    ASSERT_EQ(1U, row.cells().size());
+    values.push_back(row.cells()[0].value());
+  }
+  EXPECT_EQ((std::vector<std::string>{"r1", "r2"}), keys);
+  EXPECT_EQ((std::vector<std::string>{"v1", "v2"}), values);
+  // The row is not modified at the end of the stream.
+  EXPECT_EQ("r2", row.row_key());
+  // Calling again after the end of the stream is harmless.
+  EXPECT_FALSE(reader.Next(row));
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST_F(RowReaderTest, RowLargerThanMaxRowBytesThrows) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "a-value-that-is-too-large"
+        commit_row: true
+      }
+      )");
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*retry_policy_, on_failure_impl(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish())
+        .WillOnce(Return(grpc::Status(grpc::StatusCode::CANCELLED, "")));
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_),
+      bigtable::RowReaderOptions().set_max_row_bytes(16));
+
+  EXPECT_THROW(reader.begin(), std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+TEST_F(RowReaderTest, BufferedBytesReportsUnconsumedData) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "v1"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "qual" }
+        timestamp_micros: 42000
+        value: "a-somewhat-larger-value"
+        commit_row: true
+      }
+      )");
+  auto* stream = new MockResponseStream();  // wrapped in unique_ptr by ReadRows
+  {
+    testing::InSequence s;
+    EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)));
+    EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+  }
+
+  bigtable::RowReader reader(
+      client_, "", bigtable::RowSet(), bigtable::RowReader::NO_ROWS_LIMIT,
+      bigtable::Filter::PassAllFilter(), std::move(retry_policy_),
+      std::move(backoff_policy_));
+  EXPECT_EQ(0U, reader.buffered_bytes());
+
+  auto it = reader.begin();
+  ASSERT_NE(it, reader.end());
+  EXPECT_EQ("r1", it->row_key());
+  // The second row is still in the response.
+  auto const before = reader.buffered_bytes();
+  EXPECT_LT(std::string("a-somewhat-larger-value").size(), before);
+  ++it;
+  ASSERT_NE(it, reader.end());
+  EXPECT_EQ("r2", it->row_key());
+  // The data for the second row was moved out of the response.
+  EXPECT_GE(before - std::string("a-somewhat-larger-value").size(),
+            reader.buffered_bytes());
+  EXPECT_EQ(++it, reader.end());
+  EXPECT_EQ(0U, reader.buffered_bytes());
+}
@@ -34,3 +34,91 @@ TEST(RowTest, RowInstantiation) {
   EXPECT_EQ(2U, two_cells_row.cells().size());
   EXPECT_EQ(std::next(two_cells_row.cells().begin())->value(), cell2.value());
 }
+
+/// @test Verify that a moved-from Row returns an empty row key.
+TEST(RowTest, MovedFrom) {
+  bigtable::Row row("row", {bigtable::Cell("row", "family", "column", 42,
+                                           "value", {})});
+  bigtable::Row moved(std::move(row));
+  EXPECT_EQ("row", moved.row_key());
+  EXPECT_EQ("", row.row_key());
+  EXPECT_TRUE(row.cells().empty());
+  EXPECT_EQ(nullptr, row.find("family", "column"));
+
+  bigtable::Row assigned("r", {});
+  assigned = std::move(moved);
+  EXPECT_EQ("row", assigned.row_key());
+  EXPECT_EQ("column", assigned.cells().begin()->column_qualifier());
+  EXPECT_EQ("", moved.row_key());
+}
+
+namespace {
+std::vector<std::string> Values(bigtable::Row::CellRange const& range) {
+  std::vector<std::string> values;
+  for (auto const& cell : range) {
+    values.push_back(cell.value());
+  }
+  return values;
+}
+}  // anonymous namespace
+
+/// @test Verify the column lookups on rows sorted as the service returns them.
+TEST(RowTest, LookupSortedRow) {
+  std::string row_key = "row";
+  bigtable::Row row(row_key, {
+                                 {row_key, "fam1", "a", 20, "a20", {}},
+                                 {row_key, "fam1", "a", 10, "a10", {}},
+                                 {row_key, "fam1", "b", 30, "b30", {}},
+                                 {row_key, "fam2", "a", 40, "f2a40", {}},
+                             });
+
+  EXPECT_EQ((std::vector<std::string>{"a20", "a10"}),
+            Values(row.cells("fam1", "a")));
+  EXPECT_EQ(std::vector<std::string>{"b30"}, Values(row.cells("fam1", "b")));
+  EXPECT_TRUE(row.cells("fam1", "c").empty());
+  EXPECT_TRUE(row.cells("fam0", "a").empty());
+  EXPECT_EQ((std::vector<std::string>{"a20", "a10", "b30"}),
+            Values(row.cells_in("fam1")));
+  EXPECT_EQ(1U, row.cells_in("fam2").size());
+  EXPECT_TRUE(row.cells_in("fam3").empty());
+
+  auto const* cell = row.find("fam1", "a");
+  ASSERT_NE(nullptr, cell);
+  EXPECT_EQ("a20", cell->value());
+  // The first cell is returned, which is in the row storage.
+  EXPECT_EQ(&row.cells()[0], cell);
+  EXPECT_EQ(nullptr, row.find("fam2", "b"));
+
+  auto latest = row.latest_cells_in("fam1");
+  ASSERT_EQ(2U, latest.size());
+  EXPECT_EQ("a20", latest[0]->value());
+  EXPECT_EQ("b30", latest[1]->value());
+}
+
+/// @test Verify the column lookups on rows with unsorted families and columns.
+TEST(RowTest, LookupUnsortedRow) {
+  std::string row_key = "row";
+  bigtable::Row row(row_key, {
+                                 {row_key, "fam2", "b", 40, "f2b40", {}},
+                                 {row_key, "fam1", "b", 30, "b30", {}},
+                                 {row_key, "fam1", "a", 20, "a20", {}},
+                                 {row_key, "fam2", "a", 50, "f2a50", {}},
+                                 {row_key, "fam1", "a", 10, "a10", {}},
+                             });
+
+  // The versions of each column keep their order in the row.
+  EXPECT_EQ((std::vector<std::string>{"a20", "a10"}),
+            Values(row.cells("fam1", "a")));
+  EXPECT_EQ((std::vector<std::string>{"a20", "a10", "b30"}),
+            Values(row.cells_in("fam1")));
+  EXPECT_EQ((std::vector<std::string>{"f2a50", "f2b40"}),
+            Values(row.cells_in("fam2")));
+  ASSERT_NE(nullptr, row.find("fam2", "b"));
+  EXPECT_EQ("f2b40", row.find("fam2", "b")->value());
+
+  // Copies can use the index of the original row.
+  bigtable::Row copy = row;
+  EXPECT_EQ((std::vector<std::string>{"a20", "a10"}),
+            Values(copy.cells("fam1", "a")));
+  EXPECT_EQ(&copy.cells()[2], copy.find("fam1", "a"));
+}
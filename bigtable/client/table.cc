@@ -16,8 +16,15 @@
 
 #include <thread>
 
-#include "bigtable/client/internal/bulk_mutator.h"
+#include "bigtable/client/internal/async_bulk_mutator.h"
+#include "bigtable/client/internal/async_row_mutator.h"
+#include "bigtable/client/internal/async_row_reader.h"
+#include "bigtable/client/internal/hedged_reader.h"
 #include "bigtable/client/internal/make_unique.h"
+#include "bigtable/client/internal/parallel_scan.h"
+#include "bigtable/client/internal/pipelined_bulk_mutator.h"
+#include "bigtable/client/internal/read_row_coalescer.h"
+#include "bigtable/client/internal/row_cache.h"
 
 namespace btproto = ::google::bigtable::v2;
 
@@ -41,13 +48,33 @@ namespace {
   std::abort();
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
+
+/// Return true if all the mutations in @p request are idempotent.
+bool IsIdempotent(bigtable::IdempotentMutationPolicy& policy,
+                  btproto::MutateRowRequest const& request) {
+  return std::all_of(request.mutations().begin(), request.mutations().end(),
+                     [&policy](btproto::Mutation const& m) {
+                       return policy.is_idempotent(m);
+                     });
+}
 }  // namespace
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+void Table::Apply(SingleRowMutation&& mut) {
+  grpc::Status status;
+  auto failures = Apply(std::move(mut), status);
+  if (not failures.empty()) {
+    ReportPermanentFailures(
+        "Permanent (or too many transient) errors in Table::Apply()", status,
+        std::move(failures));
+  }
+}
+
 // Call the `google.bigtable.v2.Bigtable.MutateRow` RPC repeatedly until
 // successful, or until the policies in effect tell us to stop.
-void Table::Apply(SingleRowMutation&& mut) {
+std::vector<FailedMutation> Table::Apply(SingleRowMutation&& mut,
+                                         grpc::Status& status) {
   // Copy the policies in effect for this operation.  Many policy classes change
   // their state as the operation makes progress (or fails to make progress), so
   // we need fresh instances.
@@ -55,117 +82,409 @@ void Table::Apply(SingleRowMutation&& mut) {
   auto backoff_policy = rpc_backoff_policy_->clone();
   auto idempotent_policy = idempotent_mutation_policy_->clone();
 
-  // Build the RPC request, try to minimize copying.
-  btproto::MutateRowRequest request;
-  request.set_table_name(table_name_);
-  request.set_row_key(std::move(mut.row_key_));
-  request.mutable_mutations()->Swap(&mut.ops_);
-  bool const is_idempotent =
-      std::all_of(request.mutations().begin(), request.mutations().end(),
-                  [&idempotent_policy](btproto::Mutation const& m) {
-                    return idempotent_policy->is_idempotent(m);
-                  });
+  auto request = MakeMutateRowRequest(std::move(mut));
+  bool const is_idempotent = IsIdempotent(*idempotent_policy, request);
 
   btproto::MutateRowResponse response;
   while (true) {
     grpc::ClientContext client_context;
     rpc_policy->setup(client_context);
     backoff_policy->setup(client_context);
-    grpc::Status status =
-        client_->Stub()->MutateRow(&client_context, request, &response);
+    status = client_->Stub()->MutateRow(&client_context, request, &response);
     if (status.ok()) {
-      return;
+      InvalidateCachedRow(request.row_key());
+      return {};
     }
     // It is up to the policy to terminate this loop, it could run
     // forever, but that would be a bad policy (pun intended).
     if (not rpc_policy->on_failure(status) or not is_idempotent) {
+      // The mutation may have been applied even if the request failed.
+      InvalidateCachedRow(request.row_key());
       std::vector<FailedMutation> failures;
       google::rpc::Status rpc_status;
       rpc_status.set_code(status.error_code());
       rpc_status.set_message(status.error_message());
-      failures.emplace_back(SingleRowMutation(std::move(request)), rpc_status,
-                            0);
-      // TODO(#234) - just return the failures instead
-      ReportPermanentFailures(
-          "Permanent (or too many transient) errors in Table::Apply()", status,
-          std::move(failures));
+      failures.emplace_back(SingleRowMutation(std::move(request)),
+                            std::move(rpc_status), 0);
+      return failures;
     }
     auto delay = backoff_policy->on_completion(status);
     std::this_thread::sleep_for(delay);
   }
 }
 
+btproto::MutateRowRequest Table::MakeMutateRowRequest(
+    SingleRowMutation&& mut) const {
+  // Build the RPC request, try to minimize copying.
+  btproto::MutateRowRequest request;
+  request.set_table_name(table_name_);
+  request.set_row_key(std::move(mut.row_key_));
+  request.mutable_mutations()->Swap(&mut.ops_);
+  return request;
+}
+
+void Table::BulkApply(BulkMutation&& mut) {
+  grpc::Status status;
+  auto failures = BulkApply(std::move(mut), status);
+  if (not failures.empty()) {
+    ReportPermanentFailures(
+        "Permanent (or too many transient) errors in Table::BulkApply()",
+        status, std::move(failures));
+  }
+}
+
 // Call the `google.bigtable.v2.Bigtable.MutateRows` RPC repeatedly until
 // successful, or until the policies in effect tell us to stop.  When the RPC
 // is partially successful, this function retries only the mutations that did
 // not succeed.
-void Table::BulkApply(BulkMutation&& mut) {
+std::vector<FailedMutation> Table::BulkApply(BulkMutation&& mut,
+                                             grpc::Status& status) {
+  std::vector<std::string> row_keys;
+  if (row_cache_) {
+    for (auto const& entry : mut.request_.entries()) {
+      row_keys.push_back(entry.row_key());
+    }
+  }
+
   // Copy the policies in effect for this operation.  Many policy classes change
   // their state as the operation makes progress (or fails to make progress), so
   // we need fresh instances.
-  auto backoff_policy = rpc_backoff_policy_->clone();
-  auto retry_policy = rpc_retry_policy_->clone();
   auto idemponent_policy = idempotent_mutation_policy_->clone();
+  internal::PipelinedBulkMutator mutator(
+      table_name_, *idemponent_policy, std::forward<BulkMutation>(mut),
+      rpc_retry_policy_->clone(), rpc_backoff_policy_->clone());
+  status = mutator.Run([this] { return client_->Stub(); });
 
-  internal::BulkMutator mutator(table_name_, *idemponent_policy,
-                                std::forward<BulkMutation>(mut));
-
-  grpc::Status status = grpc::Status::OK;
-  while (mutator.HasPendingMutations()) {
-    grpc::ClientContext client_context;
-    backoff_policy->setup(client_context);
-    retry_policy->setup(client_context);
-
-    status = mutator.MakeOneRequest(*client_->Stub(), client_context);
-    if (not status.ok() and not retry_policy->on_failure(status)) {
-      break;
-    }
-    auto delay = backoff_policy->on_completion(status);
-    std::this_thread::sleep_for(delay);
-  }
-  auto failures = mutator.ExtractFinalFailures();
-  if (not failures.empty()) {
-    // TODO(#234) - just return the failures instead
-    ReportPermanentFailures(
-        "Permanent (or too many transient) errors in Table::BulkApply()",
-        status, std::move(failures));
+  // Invalidate all the rows, failed mutations may have been partially applied.
+  for (auto const& row_key : row_keys) {
+    InvalidateCachedRow(row_key);
   }
+  return mutator.ExtractFinalFailures();
 }
 
 RowReader Table::ReadRows(RowSet row_set, Filter filter) {
+  return ReadRows(std::move(row_set), std::move(filter), RowReaderOptions());
+}
+
+RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
+                          Filter filter) {
+  return ReadRows(std::move(row_set), rows_limit, std::move(filter),
+                  RowReaderOptions());
+}
+
+void Table::ReadRows(RowSet row_set, Filter filter, CellVisitor& visitor) {
+  ReadRows(std::move(row_set), std::move(filter)).Visit(visitor);
+}
+
+RowReader Table::ReadRows(RowSet row_set, Filter filter,
+                          RowReaderOptions const& options) {
   return RowReader(client_, table_name(), std::move(row_set),
                    RowReader::NO_ROWS_LIMIT, std::move(filter),
                    rpc_retry_policy_->clone(), rpc_backoff_policy_->clone(),
-                   bigtable::internal::make_unique<
-                       bigtable::internal::ReadRowsParserFactory>());
+                   options);
 }
 
 RowReader Table::ReadRows(RowSet row_set, std::int64_t rows_limit,
-                          Filter filter) {
+                          Filter filter, RowReaderOptions const& options) {
   if (rows_limit <= 0) {
     internal::RaiseInvalidArgument("rows_limit must be >0");
   }
   return RowReader(client_, table_name(), std::move(row_set), rows_limit,
                    std::move(filter), rpc_retry_policy_->clone(),
-                   rpc_backoff_policy_->clone(),
-                   bigtable::internal::make_unique<
-                       bigtable::internal::ReadRowsParserFactory>());
+                   rpc_backoff_policy_->clone(), options);
 }
 
 std::pair<bool, Row> Table::ReadRow(std::string row_key, Filter filter) {
+  grpc::Status status;
+  auto result = ReadRow(std::move(row_key), std::move(filter), status);
+  if (not status.ok()) {
+    internal::RaiseRuntimeError("Unretriable error: " +
+                                status.error_message());
+  }
+  return result;
+}
+
+std::pair<bool, Row> Table::ReadRow(std::string row_key, Filter filter,
+                                    grpc::Status& status) {
+  if (not row_cache_) {
+    return ReadRowFromServer(std::move(row_key), std::move(filter), status);
+  }
+  auto filter_key = filter.as_proto().SerializeAsString();
+  auto result = std::make_pair(false, Row("", {}));
+  internal::RowCache::Ticket ticket;
+  if (row_cache_->Lookup(row_key, filter_key, result, ticket)) {
+    status = grpc::Status::OK;
+    return result;
+  }
+  result = ReadRowFromServer(row_key, std::move(filter), status);
+  if (status.ok()) {
+    row_cache_->Insert(row_key, std::move(filter_key), result, ticket);
+  }
+  return result;
+}
+
+std::pair<bool, Row> Table::ReadRowFromServer(std::string row_key,
+                                              Filter filter,
+                                              grpc::Status& status) {
+  if (read_row_coalescer_) {
+    return read_row_coalescer_->ReadRow(
+        std::move(row_key), filter,
+        [this](RowSet row_set, Filter const& f, std::vector<Row>& rows) {
+          return ReadRowsNoThrow(std::move(row_set), RowReader::NO_ROWS_LIMIT,
+                                 f, rows);
+        },
+        status);
+  }
   RowSet row_set(std::move(row_key));
   std::int64_t const rows_limit = 1;
-  RowReader reader =
-      ReadRows(std::move(row_set), rows_limit, std::move(filter));
-  auto it = reader.begin();
-  if (it == reader.end()) {
+  std::vector<Row> rows;
+  status = ReadRowsNoThrow(std::move(row_set), rows_limit, filter, rows);
+  if (not status.ok() or rows.empty()) {
     return std::make_pair(false, Row("", {}));
   }
-  auto result = std::make_pair(true, std::move(*it));
-  if (++it != reader.end()) {
-    internal::RaiseRuntimeError(
+  if (rows.size() != 1U) {
+    status = grpc::Status(
+        grpc::StatusCode::INTERNAL,
         "internal error - RowReader returned 2 rows in ReadRow()");
+    return std::make_pair(false, Row("", {}));
+  }
+  return std::make_pair(true, std::move(rows.front()));
+}
+
+grpc::Status Table::ReadRowsNoThrow(RowSet row_set, std::int64_t rows_limit,
+                                    Filter const& filter,
+                                    std::vector<Row>& rows) {
+  if (hedged_reader_) {
+    return ReadRowsHedged(std::move(row_set), rows_limit, filter, rows);
   }
+  RowReader reader(client_, table_name(), std::move(row_set), rows_limit,
+                   filter, rpc_retry_policy_->clone(),
+                   rpc_backoff_policy_->clone());
+  grpc::Status status;
+  Row row("", {});
+  while (reader.Next(row, status)) {
+    rows.emplace_back(std::move(row));
+  }
+  return status;
+}
+
+void Table::EnableReadRowCoalescing(ReadRowCoalescingOptions const& options) {
+  read_row_coalescer_ = std::make_shared<internal::ReadRowCoalescer>(options);
+}
+
+void Table::EnableRowCache(RowCacheOptions const& options) {
+  row_cache_ = std::make_shared<internal::RowCache>(options);
+}
+
+RowCacheStats Table::row_cache_stats() const {
+  if (not row_cache_) {
+    return RowCacheStats{0, 0, 0, 0, 0, 0, 0};
+  }
+  return row_cache_->Stats();
+}
+
+void Table::EnableHedging(HedgingOptions const& options) {
+  hedged_reader_ = std::make_shared<internal::HedgedReader>(client_, options);
+}
+
+// Call the `google.bigtable.v2.Bigtable.ReadRows` RPC, with hedging, until
+// successful or until the policies in effect tell us to stop.  Each attempt
+// reads all the rows, so this is only used for small reads.
+grpc::Status Table::ReadRowsHedged(RowSet row_set, std::int64_t rows_limit,
+                                   Filter const& filter,
+                                   std::vector<Row>& rows) {
+  auto retry_policy = rpc_retry_policy_->clone();
+  auto backoff_policy = rpc_backoff_policy_->clone();
+
+  btproto::ReadRowsRequest request;
+  request.set_table_name(table_name_);
+  auto row_set_proto = row_set.as_proto_move();
+  request.mutable_rows()->Swap(&row_set_proto);
+  auto filter_proto = filter.as_proto();
+  request.mutable_filter()->Swap(&filter_proto);
+  if (rows_limit != RowReader::NO_ROWS_LIMIT) {
+    request.set_rows_limit(rows_limit);
+  }
+
+  auto setup = [&retry_policy, &backoff_policy](grpc::ClientContext& context) {
+    retry_policy->setup(context);
+    backoff_policy->setup(context);
+  };
+  while (true) {
+    rows.clear();
+    auto status = hedged_reader_->Read(request, setup, rows);
+    if (status.ok() or not retry_policy->on_failure(status)) {
+      return status;
+    }
+    auto delay = backoff_policy->on_completion(status);
+    std::this_thread::sleep_for(delay);
+  }
+}
+
+void Table::InvalidateCachedRow(std::string const& row_key) {
+  if (row_cache_) {
+    row_cache_->Invalidate(row_key);
+  }
+}
+
+void Table::ParallelReadRows(RowSet row_set, Filter filter,
+                             std::function<bool(Row)> const& on_row,
+                             ParallelScanOptions const& options) {
+  if (row_set.IsEmpty()) {
+    return;
+  }
+  auto shard_count = options.shard_count();
+  if (shard_count == 0) {
+    shard_count = 4 * options.max_streams();
+  }
+  auto shards = internal::SplitRowSet(row_set, SampleRowKeys(), shard_count);
+  internal::ParallelScan(std::move(shards),
+                         [this, &filter](RowSet shard) {
+                           return ReadRows(std::move(shard), filter);
+                         },
+                         options, on_row);
+}
+
+// Call the `google.bigtable.v2.Bigtable.SampleRowKeys` RPC until successful,
+// or until the policies in effect tell us to stop.  The samples cannot be
+// resumed, so each retry starts from the beginning.
+std::vector<RowKeySample> Table::SampleRowKeys() {
+  auto retry_policy = rpc_retry_policy_->clone();
+  auto backoff_policy = rpc_backoff_policy_->clone();
+
+  btproto::SampleRowKeysRequest request;
+  request.set_table_name(table_name_);
+
+  std::vector<RowKeySample> samples;
+  while (true) {
+    grpc::ClientContext client_context;
+    retry_policy->setup(client_context);
+    backoff_policy->setup(client_context);
+
+    samples.clear();
+    auto stream = client_->Stub()->SampleRowKeys(&client_context, request);
+    btproto::SampleRowKeysResponse response;
+    while (stream->Read(&response)) {
+      samples.emplace_back(RowKeySample{std::move(*response.mutable_row_key()),
+                                        response.offset_bytes()});
+    }
+    auto status = stream->Finish();
+    if (status.ok()) {
+      return samples;
+    }
+    if (not retry_policy->on_failure(status)) {
+      internal::RaiseRuntimeError("Unretriable error: " +
+                                  status.error_message());
+    }
+    auto delay = backoff_policy->on_completion(status);
+    std::this_thread::sleep_for(delay);
+  }
+}
+
+void Table::AsyncReadRows(CompletionQueue& cq, std::function<bool(Row)> on_row,
+                          std::function<void(grpc::Status const&)> on_finish,
+                          RowSet row_set, std::int64_t rows_limit,
+                          Filter filter) {
+  if (rows_limit < 0) {
+    internal::RaiseInvalidArgument("rows_limit must be >=0");
+  }
+  auto op = internal::make_unique<internal::AsyncRowReader>(
+      client_, table_name(), std::move(row_set), rows_limit, std::move(filter),
+      rpc_retry_policy_->clone(), rpc_backoff_policy_->clone(),
+      std::move(on_row), std::move(on_finish));
+  if (op->Start(cq)) {
+    // The completion queue owns the operation from this point on.
+    op.release();
+  }
+}
+
+std::future<grpc::Status> Table::AsyncReadRows(
+    CompletionQueue& cq, std::function<bool(Row)> on_row, RowSet row_set,
+    std::int64_t rows_limit, Filter filter) {
+  auto promise = std::make_shared<std::promise<grpc::Status>>();
+  auto result = promise->get_future();
+  AsyncReadRows(cq, std::move(on_row),
+                [promise](grpc::Status const& status) {
+                  promise->set_value(status);
+                },
+                std::move(row_set), rows_limit, std::move(filter));
+  return result;
+}
+
+void Table::AsyncApply(
+    CompletionQueue& cq, SingleRowMutation&& mut,
+    std::function<void(std::vector<FailedMutation>)> on_finish) {
+  auto idempotent_policy = idempotent_mutation_policy_->clone();
+  auto request = MakeMutateRowRequest(std::move(mut));
+  bool const is_idempotent = IsIdempotent(*idempotent_policy, request);
+  if (row_cache_) {
+    // As in Apply(), the row is invalidated even if the mutation failed.  The
+    // operation may outlive this object, so capture the cache, not `this`.
+    auto row_cache = row_cache_;
+    auto row_key = request.row_key();
+    auto callback = std::move(on_finish);
+    on_finish = [row_cache, row_key,
+                 callback](std::vector<FailedMutation> failures) {
+      row_cache->Invalidate(row_key);
+      callback(std::move(failures));
+    };
+  }
+  auto op = new internal::AsyncRowMutator(
+      client_, std::move(request), is_idempotent, rpc_retry_policy_->clone(),
+      rpc_backoff_policy_->clone(), std::move(on_finish));
+  // The completion queue owns the operation from this point on.
+  op->Start(cq);
+}
+
+std::future<std::vector<FailedMutation>> Table::AsyncApply(
+    CompletionQueue& cq, SingleRowMutation&& mut) {
+  auto promise =
+      std::make_shared<std::promise<std::vector<FailedMutation>>>();
+  auto result = promise->get_future();
+  AsyncApply(cq, std::move(mut),
+             [promise](std::vector<FailedMutation> failures) {
+               promise->set_value(std::move(failures));
+             });
+  return result;
+}
+
+void Table::AsyncBulkApply(
+    CompletionQueue& cq, BulkMutation&& mut,
+    std::function<void(std::vector<FailedMutation>)> on_finish) {
+  if (row_cache_) {
+    std::vector<std::string> row_keys;
+    for (auto const& entry : mut.request_.entries()) {
+      row_keys.push_back(entry.row_key());
+    }
+    // As in BulkApply(), invalidate all the rows once the operation completes.
+    auto row_cache = row_cache_;
+    auto callback = std::move(on_finish);
+    on_finish = [row_cache, row_keys,
+                 callback](std::vector<FailedMutation> failures) {
+      for (auto const& row_key : row_keys) {
+        row_cache->Invalidate(row_key);
+      }
+      callback(std::move(failures));
+    };
+  }
+  auto idempotent_policy = idempotent_mutation_policy_->clone();
+  auto op = new internal::AsyncBulkMutator(
+      client_, table_name_, *idempotent_policy, std::move(mut),
+      rpc_retry_policy_->clone(), rpc_backoff_policy_->clone(),
+      std::move(on_finish));
+  // The completion queue owns the operation from this point on.
+  op->Start(cq);
+}
+
+std::future<std::vector<FailedMutation>> Table::AsyncBulkApply(
+    CompletionQueue& cq, BulkMutation&& mut) {
+  auto promise =
+      std::make_shared<std::promise<std::vector<FailedMutation>>>();
+  auto result = promise->get_future();
+  AsyncBulkApply(cq, std::move(mut),
+                 [promise](std::vector<FailedMutation> failures) {
+                   promise->set_value(std::move(failures));
+                 });
   return result;
 }
 
@@ -15,19 +15,36 @@
 #ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_TABLE_H_
 #define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_TABLE_H_
 
+#include "bigtable/client/cell_visitor.h"
+#include "bigtable/client/completion_queue.h"
 #include "bigtable/client/data_client.h"
 #include "bigtable/client/filters.h"
+#include "bigtable/client/hedging_options.h"
 #include "bigtable/client/idempotent_mutation_policy.h"
 #include "bigtable/client/mutations.h"
+#include "bigtable/client/parallel_scan_options.h"
+#include "bigtable/client/read_row_coalescing_options.h"
+#include "bigtable/client/row_cache_options.h"
+#include "bigtable/client/row_key_sample.h"
 #include "bigtable/client/row_reader.h"
+#include "bigtable/client/row_reader_options.h"
 #include "bigtable/client/row_set.h"
 #include "bigtable/client/rpc_backoff_policy.h"
 #include "bigtable/client/rpc_retry_policy.h"
 
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <functional>
+#include <future>
+#include <vector>
 
 namespace bigtable {
 inline namespace BIGTABLE_CLIENT_NS {
+namespace internal {
+class HedgedReader;
+class ReadRowCoalescer;
+class RowCache;
+}  // namespace internal
+
 /**
  * Return the full table name.
  *
@@ -148,6 +165,22 @@ class Table {
    */
   void Apply(SingleRowMutation&& mut);
 
+  /**
+   * Attempts to apply the mutation to a row, without raising exceptions.
+   *
+   * Follows the same policies as `Apply(SingleRowMutation&&)`, but reports
+   * errors in the return value.  This avoids the cost of raising and
+   * handling exceptions when many mutations fail, e.g., during a service
+   * disruption, and it works the same when exceptions are disabled.
+   *
+   * @param mut the mutation, this function takes ownership of its data.
+   * @param status receives the status of the last `MutateRow` request.
+   * @return the mutation if it could not be applied, with the error in
+   *     `FailedMutation::status()`, or an empty vector on success.
+   */
+  std::vector<FailedMutation> Apply(SingleRowMutation&& mut,
+                                    grpc::Status& status);
+
   /**
    * Attempts to apply mutations to multiple rows.
    *
@@ -164,9 +197,34 @@ class Table {
    *     in the exception. The exception contains a copy of the original
    *     mutations, in case the application wants to retry, log, or otherwise
    *     handle the failed mutations.
+   *
+   * Large sets of mutations are split into several `MutateRows` requests, so
+   * each request is within the service limits.  These requests run in
+   * parallel, over different connections in the `DataClient` pool, and the
+   * failures are reported with their index in @p mut.  Mutations that fail
+   * with transient errors are retried as soon as their own backoff period
+   * expires, without waiting for the other requests to complete.
    */
   void BulkApply(BulkMutation&& mut);
 
+  /**
+   * Attempts to apply mutations to multiple rows, without raising exceptions.
+   *
+   * Follows the same policies as `BulkApply(BulkMutation&&)`, but reports
+   * the failed mutations in the return value, instead of raising
+   * `PermanentMutationFailure`.
+   *
+   * @param mut the mutations, this function takes ownership of their data.
+   * @param status receives the status of the operation, as in
+   *     `PermanentMutationFailure::status()`.  Note that it can be OK even if
+   *     some mutations failed.
+   * @return the mutations that could not be applied, as in
+   *     `PermanentMutationFailure::failures()`.  The vector is empty if all
+   *     the mutations succeeded.
+   */
+  std::vector<FailedMutation> BulkApply(BulkMutation&& mut,
+                                        grpc::Status& status);
+
   /**
    * Reads a set of rows from the table.
    *
@@ -187,6 +245,49 @@ class Table {
    */
   RowReader ReadRows(RowSet row_set, std::int64_t rows_limit, Filter filter);
 
+  /**
+   * Reads a set of rows from the table, reporting the cells to a visitor.
+   *
+   * Use this function for aggregations that do not need to keep the rows,
+   * the cells are reported as the response data is parsed, and no `Row` or
+   * `Cell` objects are created.  The function returns when all the rows
+   * have been reported.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param visitor receives the cells, see `CellVisitor` for details.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   *     Exceptions raised by @p visitor propagate unchanged, and the read
+   *     is not retried.
+   */
+  void ReadRows(RowSet row_set, Filter filter, CellVisitor& visitor);
+
+  /**
+   * Reads a set of rows from the table, with non-default reader options.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param options configure the returned reader, e.g. to enable read-ahead.
+   */
+  RowReader ReadRows(RowSet row_set, Filter filter,
+                     RowReaderOptions const& options);
+
+  /**
+   * Reads a limited set of rows from the table, with non-default reader
+   * options.
+   *
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read. Must be larger than
+   *     zero.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param options configure the returned reader, e.g. to enable read-ahead.
+   *
+   * @throws std::invalid_argument if rows_limit is <= 0.
+   */
+  RowReader ReadRows(RowSet row_set, std::int64_t rows_limit, Filter filter,
+                     RowReaderOptions const& options);
+
   /**
    * Read and return a single row from the table.
    *
@@ -200,12 +301,230 @@ class Table {
    */
   std::pair<bool, Row> ReadRow(std::string row_key, Filter filter);
 
+  /**
+   * Read and return a single row from the table, without raising exceptions.
+   *
+   * Like `ReadRow(std::string, Filter)`, but if the read fails after retries
+   * the error is returned in @p status, and the first element of the result
+   * is `false`.
+   */
+  std::pair<bool, Row> ReadRow(std::string row_key, Filter filter,
+                               grpc::Status& status);
+
+  /**
+   * Merge concurrent `ReadRow()` calls into multi-key `ReadRows` requests.
+   *
+   * After this call, `ReadRow()` calls with the same filter that arrive
+   * within `options.window()` of each other are sent as a single `ReadRows`
+   * request (with up to `options.max_keys()` keys), and the rows are
+   * returned to each caller by key.  This reduces the number of RPCs when
+   * many threads call `ReadRow()` on the same table, at the cost of up to
+   * `options.window()` additional latency for each call.  If the request
+   * fails, all the calls in the batch fail.
+   *
+   * This function is not thread-safe, call it before the table is shared
+   * with other threads.
+   */
+  void EnableReadRowCoalescing(
+      ReadRowCoalescingOptions const& options = ReadRowCoalescingOptions());
+
+  /**
+   * Cache the results of `ReadRow()` in this object.
+   *
+   * The cache is keyed by the row key and the filter, and the rows that do
+   * not exist are cached too.  `Apply()` and `BulkApply()` on this object
+   * invalidate the cached results for the rows they modify, but changes made
+   * by other clients (including other `Table` objects) are only observed
+   * after the entries expire, see `RowCacheOptions::set_ttl()`.  Only
+   * `ReadRow()` uses the cache.
+   *
+   * This function is not thread-safe, call it before the table is shared
+   * with other threads.
+   */
+  void EnableRowCache(RowCacheOptions const& options = RowCacheOptions());
+
+  /// Return the row cache counters, all zero if the cache is not enabled.
+  RowCacheStats row_cache_stats() const;
+
+  /**
+   * Hedge the `ReadRow()` requests.
+   *
+   * If a `ReadRow()` request has not completed after `options.delay()` (or
+   * the configured latency percentile), a second request is sent on a
+   * different connection from the client's pool.  The first request to
+   * succeed is used and the other one is cancelled.  The budget limits the
+   * second requests to a fraction of the reads, and there are no second
+   * requests if the client has a single connection.  The requests run on a
+   * background thread owned by the table.  When `ReadRow()` calls are
+   * coalesced (see `EnableReadRowCoalescing()`) the multi-key requests are
+   * hedged instead.
+   *
+   * The streaming reads returned by `ReadRows()` are not hedged.
+   *
+   * This function is not thread-safe, call it before the table is shared
+   * with other threads.
+   */
+  void EnableHedging(HedgingOptions const& options = HedgingOptions());
+
+  /**
+   * Read rows from the table using multiple concurrent streams.
+   *
+   * The function splits @p row_set at the boundaries returned by
+   * `SampleRowKeys()` and reads the resulting shards in parallel, using up to
+   * `options.max_streams()` streams.  The streams are spread over the
+   * connections in the client's pool, so the scan throughput scales with the
+   * number of streams, up to the limits of the pool and the server.
+   *
+   * The function blocks until all the rows are delivered, or until @p on_row
+   * returns `false`.  @p on_row is always called from the calling thread.
+   *
+   * @param row_set the rows to read from.
+   * @param filter is applied on the server-side to data in the rows.
+   * @param on_row invoked for each row, return `false` to stop the scan.
+   * @param options control the number of streams and the order of the rows.
+   *
+   * @throws std::runtime_error if the read failed after retries.
+   */
+  void ParallelReadRows(RowSet row_set, Filter filter,
+                        std::function<bool(Row)> const& on_row,
+                        ParallelScanOptions const& options =
+                            ParallelScanOptions());
+
+  /**
+   * Sample the row keys in the table.
+   *
+   * Returns a list of row keys that delimit contiguous sections of the table
+   * of approximately equal size.  The samples can be used to break up the
+   * data for distributed or parallel processing.
+   *
+   * @throws std::runtime_error if the operation failed after retries.
+   */
+  std::vector<RowKeySample> SampleRowKeys();
+
+  /**
+   * Asynchronously read a set of rows from the table.
+   *
+   * The operation runs in @p cq, the callbacks are invoked by the threads
+   * running `cq.Run()`.  The next response is not requested from the server
+   * until @p on_row has consumed all the rows in the current response, so
+   * slow callbacks naturally throttle the stream.  Retries and the backoff
+   * between them follow the same policies as `ReadRows()`, without blocking
+   * any thread.
+   *
+   * @param cq the completion queue used to run the operation.
+   * @param on_row invoked for each row, in order.  Return `false` to stop the
+   *     scan early, in which case @p on_finish receives an OK status.
+   * @param on_finish invoked exactly once, with the final status of the scan.
+   *     If @p cq is already shut down it is invoked (before this function
+   *     returns) with `grpc::StatusCode::CANCELLED`.
+   * @param row_set the rows to read from.
+   * @param rows_limit the maximum number of rows to read, use 0 to read all
+   *     matching rows.
+   * @param filter is applied on the server-side to data in the rows.
+   *
+   * @throws std::invalid_argument if rows_limit is < 0.
+   */
+  void AsyncReadRows(CompletionQueue& cq, std::function<bool(Row)> on_row,
+                     std::function<void(grpc::Status const&)> on_finish,
+                     RowSet row_set, std::int64_t rows_limit, Filter filter);
+
+  /**
+   * Asynchronously read a set of rows from the table.
+   *
+   * Like the previous overload, but the final status is returned via a
+   * `std::future<>`.
+   */
+  std::future<grpc::Status> AsyncReadRows(CompletionQueue& cq,
+                                          std::function<bool(Row)> on_row,
+                                          RowSet row_set,
+                                          std::int64_t rows_limit,
+                                          Filter filter);
+
+  /**
+   * Asynchronously apply a mutation to a row.
+   *
+   * The operation runs in @p cq, and follows the same policies as `Apply()`,
+   * but the backoff between retries is a timer in @p cq, so no thread is
+   * blocked while the mutation is pending.  A single thread running
+   * `cq.Run()` can keep many mutations in flight.
+   *
+   * @param cq the completion queue used to run the operation.
+   * @param mut the mutation, this function takes ownership of its data.
+   * @param on_finish invoked exactly once, by a thread running `cq.Run()`.
+   *     It receives the mutation if it could not be applied (with the error
+   *     in `FailedMutation::status()`), or an empty vector on success.
+   */
+  void AsyncApply(
+      CompletionQueue& cq, SingleRowMutation&& mut,
+      std::function<void(std::vector<FailedMutation>)> on_finish);
+
+  /**
+   * Asynchronously apply a mutation to a row.
+   *
+   * Like the previous overload, but the result is returned via a
+   * `std::future<>`.
+   */
+  std::future<std::vector<FailedMutation>> AsyncApply(
+      CompletionQueue& cq, SingleRowMutation&& mut);
+
+  /**
+   * Asynchronously apply mutations to multiple rows.
+   *
+   * The operation runs in @p cq, and follows the same policies as
+   * `BulkApply()`: only the mutations that fail with transient errors are
+   * retried, and the backoff between requests is a timer in @p cq.
+   *
+   * @param cq the completion queue used to run the operation.
+   * @param mut the mutations, this function takes ownership of their data.
+   * @param on_finish invoked exactly once, by a thread running `cq.Run()`.
+   *     It receives the mutations that could not be applied, as in the
+   *     `PermanentMutationFailure` exception raised by `BulkApply()`.  The
+   *     vector is empty if all the mutations succeeded.
+   */
+  void AsyncBulkApply(
+      CompletionQueue& cq, BulkMutation&& mut,
+      std::function<void(std::vector<FailedMutation>)> on_finish);
+
+  /**
+   * Asynchronously apply mutations to multiple rows.
+   *
+   * Like the previous overload, but the result is returned via a
+   * `std::future<>`.
+   */
+  std::future<std::vector<FailedMutation>> AsyncBulkApply(
+      CompletionQueue& cq, BulkMutation&& mut);
+
  private:
+  /// Build the `MutateRow` request for `Apply()` and `AsyncApply()`.
+  google::bigtable::v2::MutateRowRequest MakeMutateRowRequest(
+      SingleRowMutation&& mut) const;
+
+  /// Implement `ReadRow()` without using the cache.
+  std::pair<bool, Row> ReadRowFromServer(std::string row_key, Filter filter,
+                                         grpc::Status& status);
+
+  /// Read all the rows in @p row_set into @p rows, without raising exceptions.
+  grpc::Status ReadRowsNoThrow(RowSet row_set, std::int64_t rows_limit,
+                               Filter const& filter, std::vector<Row>& rows);
+
+  /// Read a small set of rows using hedged requests, with retries.
+  grpc::Status ReadRowsHedged(RowSet row_set, std::int64_t rows_limit,
+                              Filter const& filter, std::vector<Row>& rows);
+
+  /// Remove the results of `ReadRow()` for @p row_key from the cache.
+  void InvalidateCachedRow(std::string const& row_key);
+
   std::shared_ptr<DataClient> client_;
   std::string table_name_;
   std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
   std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
   std::unique_ptr<IdempotentMutationPolicy> idempotent_mutation_policy_;
+  /// Merges concurrent `ReadRow()` calls, if enabled.
+  std::shared_ptr<internal::ReadRowCoalescer> read_row_coalescer_;
+  /// Caches the results of `ReadRow()`, if enabled.
+  std::shared_ptr<internal::RowCache> row_cache_;
+  /// Sends the hedged `ReadRow()` requests, if enabled.
+  std::shared_ptr<internal::HedgedReader> hedged_reader_;
 };
 
 }  // namespace BIGTABLE_CLIENT_NS
@@ -96,3 +96,60 @@ TEST_F(TableApplyTest, RetryIdempotent) {
       "exceptions are disabled");
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
+
+/// @test Verify that Table::Apply() with a status works in the simple case.
+TEST_F(TableApplyTest, NoThrowSimple) {
+  using namespace ::testing;
+
+  EXPECT_CALL(*bigtable_stub_, MutateRow(_, _, _))
+      .WillOnce(Return(grpc::Status::OK));
+
+  grpc::Status status;
+  auto failures = table_.Apply(
+      bigtable::SingleRowMutation("bar",
+                                  {bigtable::SetCell("fam", "col", 0, "val")}),
+      status);
+  EXPECT_TRUE(status.ok());
+  EXPECT_TRUE(failures.empty());
+}
+
+/// @test Verify that Table::Apply() with a status returns permanent failures.
+TEST_F(TableApplyTest, NoThrowFailure) {
+  using namespace ::testing;
+
+  EXPECT_CALL(*bigtable_stub_, MutateRow(_, _, _))
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION, "uh-oh")));
+
+  grpc::Status status;
+  auto failures = table_.Apply(
+      bigtable::SingleRowMutation("bar",
+                                  {bigtable::SetCell("fam", "col", 0, "val")}),
+      status);
+  EXPECT_EQ(grpc::StatusCode::FAILED_PRECONDITION, status.error_code());
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(0, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::StatusCode::FAILED_PRECONDITION,
+            failures[0].status().error_code());
+  EXPECT_EQ("uh-oh", failures[0].rpc_status().message());
+}
+
+/// @test Verify that Table::Apply() with a status does not retry mutations
+/// that are not idempotent.
+TEST_F(TableApplyTest, NoThrowRetryIdempotent) {
+  using namespace ::testing;
+
+  EXPECT_CALL(*bigtable_stub_, MutateRow(_, _, _))
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again")));
+
+  grpc::Status status;
+  auto failures = table_.Apply(
+      bigtable::SingleRowMutation("not-idempotent",
+                                  {bigtable::SetCell("fam", "col", "val")}),
+      status);
+  EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, status.error_code());
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ("not-idempotent", failures[0].mutation().row_key());
+}
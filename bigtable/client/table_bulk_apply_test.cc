@@ -14,6 +14,10 @@
 
 #include "bigtable/client/table.h"
 
+#include <algorithm>
+#include <mutex>
+
+#include "bigtable/client/internal/bulk_mutator.h"
 #include "bigtable/client/internal/make_unique.h"
 #include "bigtable/client/testing/chrono_literals.h"
 #include "bigtable/client/testing/table_test_fixture.h"
@@ -31,6 +35,38 @@ class MockReader : public grpc::ClientReaderInterface<
 };
 
 class TableBulkApplyTest : public bigtable::testing::TableTestFixture {};
+
+/// Create a BulkMutation that must be split in two requests.
+bigtable::BulkMutation MakeLargeBulkMutation() {
+  bigtable::BulkMutation mut;
+  for (std::size_t i = 0; i != bigtable::internal::kBulkApplyMaxMutations + 1;
+       ++i) {
+    mut.emplace_back(bigtable::SingleRowMutation(
+        "row-" + std::to_string(i), {bigtable::SetCell("fam", "col", 0, "v")}));
+  }
+  return mut;
+}
+
+/// Create a reader that reports success for all but @p failed_key.
+MockReader *MakeReader(
+    ::google::bigtable::v2::MutateRowsRequest const &request,
+    std::string const &failed_key) {
+  using namespace ::testing;
+  ::google::bigtable::v2::MutateRowsResponse response;
+  int index = 0;
+  for (auto const &entry : request.entries()) {
+    auto &e = *response.add_entries();
+    e.set_index(index++);
+    e.mutable_status()->set_code(
+        entry.row_key() == failed_key ? grpc::PERMISSION_DENIED : grpc::OK);
+  }
+  auto reader = new MockReader;
+  EXPECT_CALL(*reader, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*reader, Finish()).WillOnce(Return(grpc::Status::OK));
+  return reader;
+}
 }  // anonymous namespace
 
 /// @test Verify that Table::BulkApply() works in the easy case.
@@ -160,6 +196,51 @@ TEST_F(TableBulkApplyTest, PermanentFailure) {
 }
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
+/// @test Verify that Table::BulkApply() with a status returns the failures.
+TEST_F(TableBulkApplyTest, NoThrowPermanentFailure) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+  namespace bt = ::bigtable;
+
+  auto r1 = bigtable::internal::make_unique<MockReader>();
+  EXPECT_CALL(*r1, Read(_))
+      .WillOnce(Invoke([](btproto::MutateRowsResponse *r) {
+        {
+          auto &e = *r->add_entries();
+          e.set_index(0);
+          e.mutable_status()->set_code(grpc::OK);
+        }
+        {
+          auto &e = *r->add_entries();
+          e.set_index(1);
+          e.mutable_status()->set_code(grpc::OUT_OF_RANGE);
+          e.mutable_status()->set_message("out-of-range");
+        }
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*r1, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*bigtable_stub_, MutateRowsRaw(_, _))
+      .WillOnce(Invoke(
+          [&r1](grpc::ClientContext *, btproto::MutateRowsRequest const &) {
+            return r1.release();
+          }));
+
+  grpc::Status status;
+  auto failures = table_.BulkApply(
+      bt::BulkMutation(
+          bt::SingleRowMutation("foo", {bt::SetCell("fam", "col", 0, "baz")}),
+          bt::SingleRowMutation("bar", {bt::SetCell("fam", "col", 0, "qux")})),
+      status);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(1UL, failures.size());
+  EXPECT_EQ(1, failures[0].original_index());
+  EXPECT_EQ("bar", failures[0].mutation().row_key());
+  EXPECT_EQ(grpc::OUT_OF_RANGE, failures[0].rpc_status().code());
+  EXPECT_EQ("out-of-range", failures[0].rpc_status().message());
+}
+
 /// @test Verify that Table::BulkApply() handles a terminated stream.
 TEST_F(TableBulkApplyTest, CanceledStream) {
   using namespace ::testing;
@@ -358,4 +439,58 @@ TEST_F(TableBulkApplyTest, FailedRPC) {
     FAIL() << "unexpected exception of unknown type raised";
   }
 }
+
+/// @test Verify that Table::BulkApply() reports failures in large requests.
+TEST_F(TableBulkApplyTest, SplitLargeRequestFailure) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto const last = bigtable::internal::kBulkApplyMaxMutations;
+  auto const failed_key = "row-" + std::to_string(last);
+  EXPECT_CALL(*bigtable_stub_, MutateRowsRaw(_, _))
+      .Times(2)
+      .WillRepeatedly(
+          Invoke([&failed_key](grpc::ClientContext *,
+                               btproto::MutateRowsRequest const &request) {
+            return MakeReader(request, failed_key);
+          }));
+
+  try {
+    table_.BulkApply(MakeLargeBulkMutation());
+    FAIL() << "expected a PermanentMutationFailure exception";
+  } catch (bigtable::PermanentMutationFailure const &ex) {
+    ASSERT_EQ(1UL, ex.failures().size());
+    EXPECT_EQ(static_cast<int>(last), ex.failures()[0].original_index());
+    EXPECT_EQ(failed_key, ex.failures()[0].mutation().row_key());
+    EXPECT_EQ(grpc::StatusCode::PERMISSION_DENIED,
+              ex.failures()[0].status().error_code());
+  }
+}
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+/// @test Verify that Table::BulkApply() splits large requests.
+TEST_F(TableBulkApplyTest, SplitLargeRequest) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  std::mutex mu;
+  std::vector<int> sizes;
+  EXPECT_CALL(*bigtable_stub_, MutateRowsRaw(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([&mu, &sizes](
+                                 grpc::ClientContext *,
+                                 btproto::MutateRowsRequest const &request) {
+        {
+          std::lock_guard<std::mutex> lk(mu);
+          sizes.push_back(request.entries_size());
+        }
+        return MakeReader(request, "");
+      }));
+
+  table_.BulkApply(MakeLargeBulkMutation());
+  std::sort(sizes.begin(), sizes.end());
+  EXPECT_EQ(
+      (std::vector<int>{
+          1, static_cast<int>(bigtable::internal::kBulkApplyMaxMutations)}),
+      sizes);
+}
@@ -14,7 +14,9 @@
 
 #include "bigtable/client/internal/make_unique.h"
 #include "bigtable/client/table.h"
+#include "bigtable/client/testing/fake_async_read_rows_stream.h"
 #include "bigtable/client/testing/table_test_fixture.h"
+#include <thread>
 
 /// Define helper types and functions for this test.
 namespace {
@@ -84,3 +86,201 @@ TEST_F(TableReadRowTest, ReadRowMissing) {
   auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
   EXPECT_FALSE(std::get<0>(result));
 }
+
+TEST_F(TableReadRowTest, ReadRowCoalesced) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+
+  auto stream =
+      bigtable::internal::make_unique<bigtable::testing::MockResponseStream>();
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(Invoke([&response](btproto::ReadRowsResponse *r) {
+        *r = response;
+        return true;
+      }))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+      .WillOnce(Invoke([&stream](grpc::ClientContext *,
+                                 btproto::ReadRowsRequest const &req) {
+        EXPECT_EQ(2, req.rows().row_keys_size());
+        EXPECT_EQ("r1", req.rows().row_keys(0));
+        EXPECT_EQ("r2", req.rows().row_keys(1));
+        EXPECT_EQ(0, req.rows_limit());
+        return stream.release();
+      }));
+
+  // Use a long window, the batch is closed when it has both keys.
+  table_.EnableReadRowCoalescing(bigtable::ReadRowCoalescingOptions()
+                                     .set_window(std::chrono::seconds(60))
+                                     .set_max_keys(2));
+  std::pair<bool, bigtable::Row> r1(false, bigtable::Row("", {}));
+  std::pair<bool, bigtable::Row> r2(false, bigtable::Row("", {}));
+  std::thread t1([&] {
+    r1 = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
+  });
+  std::thread t2([&] {
+    r2 = table_.ReadRow("r2", bigtable::Filter::PassAllFilter());
+  });
+  t1.join();
+  t2.join();
+
+  EXPECT_TRUE(r1.first);
+  EXPECT_EQ("r1", r1.second.row_key());
+  EXPECT_FALSE(r2.first);
+}
+
+TEST_F(TableReadRowTest, ReadRowCached) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+
+  auto make_stream = [&response] {
+    auto stream = new bigtable::testing::MockResponseStream;
+    EXPECT_CALL(*stream, Read(_))
+        .WillOnce(Invoke([&response](btproto::ReadRowsResponse *r) {
+          *r = response;
+          return true;
+        }))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+    return stream;
+  };
+  // The second read is served from the cache, the mutation invalidates it.
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+      .WillOnce(WithoutArgs(Invoke(make_stream)))
+      .WillOnce(WithoutArgs(Invoke(make_stream)));
+  EXPECT_CALL(*bigtable_stub_, MutateRow(_, _, _))
+      .WillOnce(Return(grpc::Status::OK));
+
+  table_.EnableRowCache();
+  for (int i = 0; i != 2; ++i) {
+    auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
+    EXPECT_TRUE(result.first);
+    EXPECT_EQ("r1", result.second.row_key());
+  }
+  table_.Apply(bigtable::SingleRowMutation(
+      "r1", {bigtable::SetCell("fam", "col", 0, "val")}));
+  auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
+  EXPECT_TRUE(result.first);
+
+  auto stats = table_.row_cache_stats();
+  EXPECT_EQ(1, stats.hits);
+  EXPECT_EQ(2, stats.misses);
+  EXPECT_EQ(1, stats.invalidations);
+  EXPECT_EQ(1U, stats.entries);
+}
+
+TEST_F(TableReadRowTest, ReadRowHedgedRetries) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "col" }
+        timestamp_micros: 42000
+        value: "value"
+        commit_row: true
+      }
+)");
+
+  auto check_request = [this](btproto::ReadRowsRequest const &req) {
+    EXPECT_EQ(1, req.rows().row_keys_size());
+    EXPECT_EQ("r1", req.rows().row_keys(0));
+    EXPECT_EQ(1, req.rows_limit());
+    EXPECT_EQ(table_.table_name(), req.table_name());
+  };
+  // The hedged reads use the asynchronous API, the first attempt fails and
+  // the table retries it.
+  EXPECT_CALL(*bigtable_stub_, PrepareAsyncReadRowsRaw(_, _, _))
+      .WillOnce(Invoke([&](grpc::ClientContext *,
+                           btproto::ReadRowsRequest const &req,
+                           grpc::CompletionQueue *cq) {
+        check_request(req);
+        return new bigtable::testing::FakeAsyncReadRowsStream(
+            cq, {}, grpc::Status(grpc::UNAVAILABLE, "try-again"),
+            std::chrono::milliseconds(0));
+      }))
+      .WillOnce(Invoke([&](grpc::ClientContext *,
+                           btproto::ReadRowsRequest const &req,
+                           grpc::CompletionQueue *cq) {
+        check_request(req);
+        return new bigtable::testing::FakeAsyncReadRowsStream(
+            cq, {response}, grpc::Status::OK, std::chrono::milliseconds(0));
+      }));
+
+  table_.EnableHedging(
+      bigtable::HedgingOptions().set_delay(std::chrono::seconds(60)));
+  auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter());
+  EXPECT_TRUE(std::get<0>(result));
+  EXPECT_EQ("r1", std::get<1>(result).row_key());
+}
+
+TEST_F(TableReadRowTest, ReadRowFailureReportsStatus) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto stream =
+      bigtable::internal::make_unique<bigtable::testing::MockResponseStream>();
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::PERMISSION_DENIED, "uh-oh")));
+
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+      .WillOnce(Invoke([&stream](grpc::ClientContext *,
+                                 btproto::ReadRowsRequest const &) {
+        return stream.release();
+      }));
+
+  grpc::Status status;
+  auto result = table_.ReadRow("r1", bigtable::Filter::PassAllFilter(), status);
+  EXPECT_FALSE(std::get<0>(result));
+  EXPECT_EQ(grpc::PERMISSION_DENIED, status.error_code());
+  EXPECT_EQ("uh-oh", status.error_message());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST_F(TableReadRowTest, ReadRowFailureThrows) {
+  using namespace ::testing;
+  namespace btproto = ::google::bigtable::v2;
+
+  auto stream =
+      bigtable::internal::make_unique<bigtable::testing::MockResponseStream>();
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(grpc::Status(grpc::PERMISSION_DENIED, "uh-oh")));
+
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+      .WillOnce(Invoke([&stream](grpc::ClientContext *,
+                                 btproto::ReadRowsRequest const &) {
+        return stream.release();
+      }));
+
+  EXPECT_THROW(table_.ReadRow("r1", bigtable::Filter::PassAllFilter()),
+               std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
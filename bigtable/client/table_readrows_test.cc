@@ -17,6 +17,7 @@
 
 using testing::DoAll;
 using testing::Return;
+using testing::SaveArg;
 using testing::SetArgPointee;
 using testing::_;
 
@@ -145,3 +146,210 @@ TEST_F(TableReadRowsTest, ReadRowsThrowsWhenTooManyErrors) {
   EXPECT_THROW(reader.begin(), std::exception);
 }
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+namespace {
+/// Record the calls to a CellVisitor as strings.
+class RecordingVisitor : public bigtable::CellVisitor {
+ public:
+  void OnRowStart(std::string const& row_key) override {
+    events.push_back("start " + row_key);
+  }
+  void OnCell(std::string const& family_name,
+              std::string const& column_qualifier, std::int64_t timestamp,
+              std::string const& value,
+              std::vector<std::string> const&) override {
+    events.push_back("cell " + family_name + ":" + column_qualifier + "@" +
+                     std::to_string(timestamp) + "=" + value);
+  }
+  void OnRowCommit() override { events.push_back("commit"); }
+  void OnRowReset() override { events.push_back("reset"); }
+
+  std::vector<std::string> events;
+};
+}  // anonymous namespace
+
+TEST_F(TableReadRowsTest, ReadRowsWithVisitor) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 42000
+        value: "v1"
+      }
+      chunks {
+        qualifier { value: "c2" }
+        timestamp_micros: 42000
+        value: "v2"
+        commit_row: true
+      }
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 42000
+        value: "v3"
+      }
+      )");
+
+  auto response_retry = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r2"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 42000
+        value: "v3"
+        commit_row: true
+      }
+      )");
+
+  // must be a new pointer, it is wrapped in unique_ptr by ReadRows
+  auto stream = new bigtable::testing::MockResponseStream;
+  auto stream_retry = new bigtable::testing::MockResponseStream;
+
+  google::bigtable::v2::ReadRowsRequest retry_request;
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _))
+      .WillOnce(Return(stream))
+      .WillOnce(DoAll(SaveArg<1>(&retry_request), Return(stream_retry)));
+
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again")));
+
+  EXPECT_CALL(*stream_retry, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response_retry), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  RecordingVisitor visitor;
+  table_.ReadRows(bigtable::RowSet(), bigtable::Filter::PassAllFilter(),
+                  visitor);
+
+  std::vector<std::string> expected{
+      "start r1",  "cell fam:c1@42000=v1", "cell fam:c2@42000=v2", "commit",
+      "start r2",  "cell fam:c1@42000=v3", "reset",
+      "start r2",  "cell fam:c1@42000=v3", "commit",
+  };
+  EXPECT_EQ(expected, visitor.events);
+  // The retry starts after the last committed row.
+  ASSERT_EQ(1, retry_request.rows().row_ranges_size());
+  EXPECT_EQ("r1", retry_request.rows().row_ranges(0).start_key_open());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+namespace {
+struct VisitorError {};
+
+/// A CellVisitor that fails on the first cell.
+class ThrowingVisitor : public RecordingVisitor {
+ public:
+  void OnCell(std::string const&, std::string const&, std::int64_t,
+              std::string const&, std::vector<std::string> const&) override {
+    throw VisitorError{};
+  }
+};
+}  // anonymous namespace
+
+TEST_F(TableReadRowsTest, ReadRowsWithVisitorPropagatesVisitorExceptions) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 42000
+        value: "v1"
+        commit_row: true
+      }
+      )");
+
+  // The visitor error is not retried, there is only one request.
+  auto stream = new bigtable::testing::MockResponseStream;
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillRepeatedly(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillRepeatedly(Return(grpc::Status::OK));
+
+  ThrowingVisitor visitor;
+  EXPECT_THROW(table_.ReadRows(bigtable::RowSet(),
+                               bigtable::Filter::PassAllFilter(), visitor),
+               VisitorError);
+  std::vector<std::string> expected{"start r1"};
+  EXPECT_EQ(expected, visitor.events);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+namespace {
+/// Record the calls to a CellVisitor, receiving large values in pieces.
+class StreamingVisitor : public RecordingVisitor {
+ public:
+  bool OnLargeCellStart(std::string const& family_name,
+                        std::string const& column_qualifier,
+                        std::int64_t timestamp, std::size_t value_size,
+                        std::vector<std::string> const&) override {
+    events.push_back("large " + family_name + ":" + column_qualifier + "@" +
+                     std::to_string(timestamp) + " size=" +
+                     std::to_string(value_size));
+    return true;
+  }
+  void OnCellValueChunk(std::string const& data) override {
+    events.push_back("chunk " + data);
+  }
+  void OnLargeCellEnd() override { events.push_back("end"); }
+};
+}  // anonymous namespace
+
+TEST_F(TableReadRowsTest, ReadRowsWithVisitorStreamsLargeValues) {
+  auto response = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        row_key: "r1"
+        family_name { value: "fam" }
+        qualifier { value: "c1" }
+        timestamp_micros: 42000
+        value: "v1"
+      }
+      chunks {
+        qualifier { value: "c2" }
+        timestamp_micros: 42000
+        value: "part1-"
+        value_size: 17
+      }
+      chunks {
+        value: "part2-"
+        value_size: 17
+      }
+      )");
+  auto response_2 = bigtable::testing::ReadRowsResponseFromString(R"(
+      chunks {
+        value: "part3"
+        commit_row: true
+      }
+      )");
+
+  auto stream = new bigtable::testing::MockResponseStream;
+  EXPECT_CALL(*bigtable_stub_, ReadRowsRaw(_, _)).WillOnce(Return(stream));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(response), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(response_2), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  StreamingVisitor visitor;
+  table_.ReadRows(bigtable::RowSet(), bigtable::Filter::PassAllFilter(),
+                  visitor);
+
+  std::vector<std::string> expected{
+      "start r1",
+      "cell fam:c1@42000=v1",
+      "large fam:c2@42000 size=17",
+      "chunk part1-",
+      "chunk part2-",
+      "chunk part3",
+      "end",
+      "commit",
+  };
+  EXPECT_EQ(expected, visitor.events);
+}
@@ -0,0 +1,98 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "bigtable/client/table.h"
+#include "bigtable/client/testing/table_test_fixture.h"
+
+using testing::DoAll;
+using testing::Return;
+using testing::SetArgPointee;
+using testing::_;
+
+using google::bigtable::v2::SampleRowKeysResponse;
+
+/// Define helper types and functions for this test.
+namespace {
+class TableSampleRowKeysTest : public bigtable::testing::TableTestFixture {};
+
+SampleRowKeysResponse MakeSample(std::string row_key,
+                                 std::int64_t offset_bytes) {
+  SampleRowKeysResponse response;
+  response.set_row_key(std::move(row_key));
+  response.set_offset_bytes(offset_bytes);
+  return response;
+}
+}  // anonymous namespace
+
+/// @test Verify that Table::SampleRowKeys() works in the simple case.
+TEST_F(TableSampleRowKeysTest, Simple) {
+  // must be a new pointer, it is wrapped in unique_ptr by SampleRowKeys
+  auto stream = new bigtable::testing::MockSampleRowKeysReader;
+  EXPECT_CALL(*bigtable_stub_, SampleRowKeysRaw(_, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeSample("test1", 11)), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeSample("test2", 22)), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto samples = table_.SampleRowKeys();
+  ASSERT_EQ(2U, samples.size());
+  EXPECT_EQ("test1", samples[0].row_key);
+  EXPECT_EQ(11, samples[0].offset_bytes);
+  EXPECT_EQ("test2", samples[1].row_key);
+  EXPECT_EQ(22, samples[1].offset_bytes);
+}
+
+/// @test Verify that Table::SampleRowKeys() discards partial results on retry.
+TEST_F(TableSampleRowKeysTest, RetryDiscardsPartialResults) {
+  auto stream = new bigtable::testing::MockSampleRowKeysReader;
+  auto stream_retry = new bigtable::testing::MockSampleRowKeysReader;
+  EXPECT_CALL(*bigtable_stub_, SampleRowKeysRaw(_, _))
+      .WillOnce(Return(stream))
+      .WillOnce(Return(stream_retry));
+
+  EXPECT_CALL(*stream, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeSample("test1", 11)), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(
+          Return(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again")));
+
+  EXPECT_CALL(*stream_retry, Read(_))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeSample("test1", 11)), Return(true)))
+      .WillOnce(DoAll(SetArgPointee<0>(MakeSample("test2", 22)), Return(true)))
+      .WillOnce(Return(false));
+  EXPECT_CALL(*stream_retry, Finish()).WillOnce(Return(grpc::Status::OK));
+
+  auto samples = table_.SampleRowKeys();
+  ASSERT_EQ(2U, samples.size());
+  EXPECT_EQ("test1", samples[0].row_key);
+  EXPECT_EQ("test2", samples[1].row_key);
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify that Table::SampleRowKeys() reports permanent failures.
+TEST_F(TableSampleRowKeysTest, PermanentFailure) {
+  auto stream = new bigtable::testing::MockSampleRowKeysReader;
+  EXPECT_CALL(*bigtable_stub_, SampleRowKeysRaw(_, _))
+      .WillOnce(Return(stream));
+  EXPECT_CALL(*stream, Read(_)).WillOnce(Return(false));
+  EXPECT_CALL(*stream, Finish())
+      .WillOnce(Return(
+          grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh")));
+
+  EXPECT_THROW(table_.SampleRowKeys(), std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
@@ -0,0 +1,103 @@
+// Copyright 2018 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_TESTING_FAKE_ASYNC_READ_ROWS_STREAM_H_
+#define GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_TESTING_FAKE_ASYNC_READ_ROWS_STREAM_H_
+
+#include <google/bigtable/v2/bigtable.pb.h>
+#include <grpc++/alarm.h>
+#include <grpc++/grpc++.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace bigtable {
+namespace testing {
+/**
+ * An asynchronous ReadRows stream completing its operations on a real queue.
+ *
+ * Unlike `MockAsyncResponseStream`, the operations complete by themselves,
+ * each through a `grpc::Alarm` posted to @p cq, so the code under test can
+ * run its own completion queue loop.  The first `Read()` of a response
+ * completes after @p delay, the other operations complete immediately.  To
+ * fail after a delay, start @p responses with an empty response.
+ */
+class FakeAsyncReadRowsStream
+    : public grpc::ClientAsyncReaderInterface<
+          ::google::bigtable::v2::ReadRowsResponse> {
+ public:
+  FakeAsyncReadRowsStream(
+      grpc::CompletionQueue* cq,
+      std::vector<::google::bigtable::v2::ReadRowsResponse> responses,
+      grpc::Status status, std::chrono::milliseconds delay,
+      std::atomic<int>* read_count = nullptr)
+      : cq_(cq),
+        responses_(std::move(responses)),
+        next_(0),
+        status_(std::move(status)),
+        delay_(delay),
+        read_count_(read_count) {}
+
+  void StartCall(void* tag) override { Complete(tag, true); }
+  void ReadInitialMetadata(void* tag) override { Complete(tag, true); }
+
+  void Read(::google::bigtable::v2::ReadRowsResponse* response,
+            void* tag) override {
+    if (read_count_ != nullptr) {
+      ++*read_count_;
+    }
+    auto delay = next_ == 0 ? delay_ : std::chrono::milliseconds(0);
+    if (next_ == responses_.size()) {
+      Complete(tag, false);
+      return;
+    }
+    *response = responses_[next_++];
+    Complete(tag, true, delay);
+  }
+
+  void Finish(grpc::Status* status, void* tag) override {
+    *status = status_;
+    Complete(tag, true);
+  }
+
+ private:
+  void Complete(void* tag, bool ok, std::chrono::milliseconds delay =
+                                         std::chrono::milliseconds(0)) {
+    alarms_.emplace_back(new grpc::Alarm);
+    auto& alarm = *alarms_.back();
+    if (ok) {
+      alarm.Set(cq_, std::chrono::system_clock::now() + delay, tag);
+      return;
+    }
+    // A cancelled alarm reports `ok == false`, use a deadline that cannot
+    // expire before the alarm is cancelled.
+    alarm.Set(cq_, std::chrono::system_clock::now() + std::chrono::hours(1),
+              tag);
+    alarm.Cancel();
+  }
+
+  grpc::CompletionQueue* cq_;
+  std::vector<::google::bigtable::v2::ReadRowsResponse> responses_;
+  std::size_t next_;
+  grpc::Status status_;
+  std::chrono::milliseconds delay_;
+  std::atomic<int>* read_count_;
+  std::vector<std::unique_ptr<grpc::Alarm>> alarms_;
+};
+
+}  // namespace testing
+}  // namespace bigtable
+
+#endif  // GOOGLE_CLOUD_CPP_BIGTABLE_CLIENT_TESTING_FAKE_ASYNC_READ_ROWS_STREAM_H_
@@ -29,6 +29,47 @@ class MockResponseStream : public grpc::ClientReaderInterface<
   MOCK_METHOD1(Read, bool(::google::bigtable::v2::ReadRowsResponse *));
 };
 
+class MockSampleRowKeysReader
+    : public grpc::ClientReaderInterface<
+          ::google::bigtable::v2::SampleRowKeysResponse> {
+ public:
+  MOCK_METHOD0(WaitForInitialMetadata, void());
+  MOCK_METHOD0(Finish, grpc::Status());
+  MOCK_METHOD1(NextMessageSize, bool(std::uint32_t *));
+  MOCK_METHOD1(Read, bool(::google::bigtable::v2::SampleRowKeysResponse *));
+};
+
+class MockAsyncResponseStream
+    : public grpc::ClientAsyncReaderInterface<
+          ::google::bigtable::v2::ReadRowsResponse> {
+ public:
+  MOCK_METHOD1(StartCall, void(void *));
+  MOCK_METHOD1(ReadInitialMetadata, void(void *));
+  MOCK_METHOD2(Finish, void(grpc::Status *, void *));
+  MOCK_METHOD2(Read, void(::google::bigtable::v2::ReadRowsResponse *, void *));
+};
+
+class MockAsyncMutateRowReader
+    : public grpc::ClientAsyncResponseReaderInterface<
+          ::google::bigtable::v2::MutateRowResponse> {
+ public:
+  MOCK_METHOD0(StartCall, void());
+  MOCK_METHOD1(ReadInitialMetadata, void(void *));
+  MOCK_METHOD3(Finish, void(::google::bigtable::v2::MutateRowResponse *,
+                            grpc::Status *, void *));
+};
+
+class MockAsyncMutateRowsStream
+    : public grpc::ClientAsyncReaderInterface<
+          ::google::bigtable::v2::MutateRowsResponse> {
+ public:
+  MOCK_METHOD1(StartCall, void(void *));
+  MOCK_METHOD1(ReadInitialMetadata, void(void *));
+  MOCK_METHOD2(Finish, void(grpc::Status *, void *));
+  MOCK_METHOD2(Read,
+               void(::google::bigtable::v2::MutateRowsResponse *, void *));
+};
+
 }  // namespace testing
 }  // namespace bigtable
 